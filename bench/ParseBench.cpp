@@ -0,0 +1,66 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "ImuMessage.h"
+
+namespace {
+
+// Text frame with 'count' samples of each sensor, batched if more than one
+std::string makeTextFrame(std::size_t count) {
+    auto triplets = [count](float base) {
+        std::string out = count > 1 ? "[" : "";
+        char sample[96];
+        for (std::size_t i = 0; i < count; ++i) {
+            std::snprintf(sample, sizeof(sample), "%s[%.6f, %.6f, %.6f]", i ? ", " : "",
+                          base + 0.001f * i, base - 0.002f * i, 0.5f * base + 0.003f * i);
+            out += sample;
+        }
+        return count > 1 ? out + "]" : out;
+    };
+    return "T: 12.345678, Acc: " + triplets(0.98f) + ", Gyro: " + triplets(0.01f) + ", Mag: " + triplets(42.5f);
+}
+
+// The same samples as a binary frame
+std::vector<std::uint8_t> makeBinaryFrame(std::size_t count) {
+    const std::string text = makeTextFrame(count);
+    ImuBatch batch;
+    parseTextFrame(text.data(), text.size(), batch);
+    std::vector<std::uint8_t> frame;
+    encodeBinaryFrame(batch, frame);
+    return frame;
+}
+
+} // namespace
+
+// processMessage's text path: samples parsed per second for 1 to 100 samples per sensor and frame
+static void BM_ParseText(benchmark::State& state) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    const std::string frame = makeTextFrame(count);
+    ImuBatch batch;
+    for (auto _ : state) {
+        bool parsed = parseTextFrame(frame.data(), frame.size(), batch);
+        benchmark::DoNotOptimize(parsed);
+        benchmark::DoNotOptimize(batch.mag.z.data());
+    }
+    state.SetItemsProcessed(state.iterations() * 3 * count);
+    state.SetBytesProcessed(state.iterations() * frame.size());
+}
+BENCHMARK(BM_ParseText)->Arg(1)->Arg(10)->Arg(100);
+
+// Binary path over the same samples, for comparison with BM_ParseText
+static void BM_ParseBinary(benchmark::State& state) {
+    const std::size_t count = static_cast<std::size_t>(state.range(0));
+    const std::vector<std::uint8_t> frame = makeBinaryFrame(count);
+    ImuBatch batch;
+    for (auto _ : state) {
+        bool parsed = parseBinaryFrame(frame.data(), frame.size(), batch);
+        benchmark::DoNotOptimize(parsed);
+        benchmark::DoNotOptimize(batch.mag.z.data());
+    }
+    state.SetItemsProcessed(state.iterations() * 3 * count);
+    state.SetBytesProcessed(state.iterations() * frame.size());
+}
+BENCHMARK(BM_ParseBinary)->Arg(1)->Arg(10)->Arg(100);
@@ -0,0 +1,186 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "RingChannel.h"
+#include "ThreadSafeRingBuffer.h"
+
+namespace {
+
+constexpr std::size_t benchCapacity = 1 << 16;
+constexpr std::size_t batchSize = 10;
+constexpr std::size_t readWindow = 4096;
+
+// One batch of samples, appended over and over with advancing timestamps
+struct Batch {
+    double t[batchSize];
+    float x[batchSize], y[batchSize], z[batchSize];
+
+    Batch() {
+        for (std::size_t i = 0; i < batchSize; ++i) {
+            x[i] = std::sin(0.1f * i);
+            y[i] = std::cos(0.1f * i);
+            z[i] = 0.5f;
+        }
+    }
+
+    void advance(std::uint64_t& n) {
+        for (std::size_t i = 0; i < batchSize; ++i) {
+            t[i] = static_cast<double>(n++) * 1e-3;
+        }
+    }
+};
+
+void fillBuffer(ThreadSafeRingBuffer<>& buffer, std::size_t samples) {
+    Batch batch;
+    std::uint64_t n = 0;
+    while (n < samples) {
+        batch.advance(n);
+        buffer.append(batch.t, batch.x, batch.y, batch.z, batchSize);
+    }
+}
+
+} // namespace
+
+// Producer throughput while a reader keeps copying snapshots of the newest window
+static void BM_AppendContended(benchmark::State& state) {
+    ThreadSafeRingBuffer<> buffer(benchCapacity);
+    fillBuffer(buffer, readWindow);
+
+    std::atomic<bool> running{true};
+    std::thread reader([&]() {
+        std::vector<double> t(readWindow);
+        std::vector<float> x(readWindow), y(readWindow), z(readWindow);
+        while (running.load(std::memory_order_relaxed)) {
+            buffer.readRecent(readWindow, t.data(), x.data(), y.data(), z.data());
+            benchmark::DoNotOptimize(x.data());
+        }
+    });
+
+    Batch batch;
+    std::uint64_t n = readWindow;
+    for (auto _ : state) {
+        batch.advance(n);
+        buffer.append(batch.t, batch.x, batch.y, batch.z, batchSize);
+    }
+    running = false;
+    reader.join();
+    state.SetItemsProcessed(state.iterations() * batchSize);
+}
+BENCHMARK(BM_AppendContended);
+
+// Snapshot reads of the newest window while a producer appends as fast as it can
+static void BM_ReadRecentContended(benchmark::State& state) {
+    ThreadSafeRingBuffer<> buffer(benchCapacity);
+    fillBuffer(buffer, readWindow);
+
+    std::atomic<bool> running{true};
+    std::thread writer([&]() {
+        Batch batch;
+        std::uint64_t n = readWindow;
+        while (running.load(std::memory_order_relaxed)) {
+            batch.advance(n);
+            buffer.append(batch.t, batch.x, batch.y, batch.z, batchSize);
+        }
+    });
+
+    std::vector<double> t(readWindow);
+    std::vector<float> x(readWindow), y(readWindow), z(readWindow);
+    for (auto _ : state) {
+        bool read = buffer.readRecent(readWindow, t.data(), x.data(), y.data(), z.data());
+        benchmark::DoNotOptimize(read);
+    }
+    running = false;
+    writer.join();
+    state.SetItemsProcessed(state.iterations() * readWindow);
+}
+BENCHMARK(BM_ReadRecentContended);
+
+// Min/max decimation of a full buffer into 'buckets' points, the per-plot cost of a frame
+static void BM_ReadDecimated(benchmark::State& state) {
+    const std::size_t buckets = static_cast<std::size_t>(state.range(0));
+    ThreadSafeRingBuffer<> buffer(benchCapacity);
+    fillBuffer(buffer, benchCapacity);
+
+    const std::size_t points = buffer.maxDecimatedPoints(buckets);
+    std::vector<double> t(points);
+    std::vector<float> x(points), y(points), z(points);
+    std::size_t count = 0;
+    for (auto _ : state) {
+        count = buffer.readDecimated(buffer.capacity(), buckets, t.data(), x.data(), y.data(), z.data());
+        benchmark::DoNotOptimize(count);
+    }
+    state.counters["points"] = static_cast<double>(count);
+}
+BENCHMARK(BM_ReadDecimated)->Arg(500)->Arg(2000)->Arg(8000);
+
+// Frame cost of one plot: the full window of a 1 kHz sensor decimated into 1000 buckets,
+// for bufferSeconds from 5 s to 10 minutes. Should stay flat as the buffer grows.
+static void BM_DecimatedFrame(benchmark::State& state) {
+    constexpr double rate = 1000.0;
+    constexpr std::size_t buckets = 1000;
+    const double seconds = static_cast<double>(state.range(0));
+    ThreadSafeRingBuffer<> buffer(static_cast<std::size_t>(seconds * rate));
+    fillBuffer(buffer, buffer.capacity());
+
+    const std::size_t points = buffer.maxDecimatedPoints(buckets);
+    std::vector<double> t(points);
+    std::vector<float> x(points), y(points), z(points);
+    // fillBuffer spaces samples 1 ms apart
+    const double span = static_cast<double>(buffer.capacity()) / rate;
+    std::size_t count = 0;
+    for (auto _ : state) {
+        count = buffer.readDecimatedSpan(span, buckets, t.data(), x.data(), y.data(), z.data());
+        benchmark::DoNotOptimize(count);
+    }
+    state.counters["samples"] = static_cast<double>(buffer.capacity());
+    state.counters["points"] = static_cast<double>(count);
+}
+BENCHMARK(BM_DecimatedFrame)->Arg(5)->Arg(60)->Arg(600);
+
+// Append latency percentiles of the double-mapped channels against the plain fallback,
+// which stores every sample twice. Both use the same capacity; 'mirrored' is the argument.
+static void BM_ChannelAppendLatency(benchmark::State& state) {
+    const bool mirror = state.range(0) != 0;
+    RingChannel<double> tChannel(benchCapacity, mirror);
+    RingChannel<float> xChannel(benchCapacity, mirror), yChannel(benchCapacity, mirror), zChannel(benchCapacity, mirror);
+    if (xChannel.mirrored() != mirror) {
+        state.SkipWithError("Double mapping not available");
+        return;
+    }
+
+    Batch batch;
+    std::uint64_t n = 0;
+    std::vector<std::int64_t> latencies;
+    latencies.reserve(1 << 20);
+    for (auto _ : state) {
+        batch.advance(n);
+        const std::size_t pos = static_cast<std::size_t>((n - batchSize) % benchCapacity);
+        const auto start = std::chrono::steady_clock::now();
+        tChannel.write(pos, batch.t, batchSize);
+        xChannel.write(pos, batch.x, batchSize);
+        yChannel.write(pos, batch.y, batchSize);
+        zChannel.write(pos, batch.z, batchSize);
+        const auto stop = std::chrono::steady_clock::now();
+        if (latencies.size() < latencies.capacity()) {
+            latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+        }
+        benchmark::ClobberMemory();
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) {
+        return latencies.empty() ? 0.0 : static_cast<double>(latencies[static_cast<std::size_t>(p * (latencies.size() - 1))]);
+    };
+    state.counters["p50_ns"] = percentile(0.50);
+    state.counters["p99_ns"] = percentile(0.99);
+    state.counters["p999_ns"] = percentile(0.999);
+    state.counters["bytes"] = static_cast<double>(tChannel.bytes() + xChannel.bytes() + yChannel.bytes() + zChannel.bytes());
+    state.SetItemsProcessed(state.iterations() * batchSize);
+}
+BENCHMARK(BM_ChannelAppendLatency)->ArgName("mirrored")->Arg(1)->Arg(0);
@@ -0,0 +1,69 @@
+#include <benchmark/benchmark.h>
+
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+
+#include "AppConfig.h"
+#include "DeviceRegistry.h"
+#include "ImuMessage.h"
+#include "WebSocketServer.h"
+
+namespace websocket = boost::beast::websocket;
+
+// Socket-to-buffer latency: a local WebSocket client sends a binary frame and waits
+// until its samples are readable from the device's ring buffers. Each iteration is
+// one round of client write, server read, parse, budget check and append.
+static void BM_SocketToBuffer(benchmark::State& state) {
+    const std::size_t batchSize = static_cast<std::size_t>(state.range(0));
+
+    AppConfig config;
+    config.port = 0;
+    config.ioThreads = 1;
+    config.historySeconds = 0;
+    config.maxIngestRate = 1e12; // Measure the path, not the overload handling
+    DeviceRegistry registry(config);
+
+    net::io_context ioc(1);
+    WebSocketServer server(ioc, config.port, registry, nullptr, nullptr);
+    server.run();
+    std::thread ioThread([&ioc]() { ioc.run(); });
+
+    net::io_context clientIoc;
+    websocket::stream<tcp::socket> ws(clientIoc);
+    ws.next_layer().connect(tcp::endpoint(net::ip::address_v4::loopback(), server.port()));
+    ws.handshake("localhost", "/bench");
+    ws.binary(true);
+    // The session registers the device before it completes the handshake
+    DeviceBuffers* device = registry.devices().front();
+
+    ImuBatch batch;
+    for (SensorSamples* samples : {&batch.gyro, &batch.accel, &batch.mag}) {
+        samples->resize(batchSize);
+        for (std::size_t i = 0; i < batchSize; ++i) {
+            samples->x[i] = 0.1f * i;
+            samples->y[i] = 0.2f * i;
+            samples->z[i] = 0.3f * i;
+        }
+    }
+    std::vector<std::uint8_t> frame;
+    std::uint64_t expected = 0;
+
+    for (auto _ : state) {
+        batch.timestampUs += 10000;
+        encodeBinaryFrame(batch, frame);
+        ws.write(net::buffer(frame));
+        expected += batchSize;
+        while (device->gyro.written() < expected || device->mag.written() < expected) {
+            std::this_thread::yield();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 3 * batchSize);
+
+    ws.close(websocket::close_code::normal);
+    ioc.stop();
+    ioThread.join();
+}
+BENCHMARK(BM_SocketToBuffer)->Arg(1)->Arg(100)->UseRealTime();
@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "Fft.h"
+
+// One windowed FFT with the dB conversion, per FFT length
+static void BM_FftAmplitudeDb(benchmark::State& state) {
+    Fft fft(static_cast<std::size_t>(state.range(0)));
+    std::vector<float> frame(fft.size()), db(fft.bins());
+    for (std::size_t i = 0; i < frame.size(); ++i) {
+        frame[i] = std::sin(0.05f * i) + 0.1f * std::sin(1.3f * i);
+    }
+    for (auto _ : state) {
+        fft.amplitudeDb(frame.data(), db.data());
+        benchmark::DoNotOptimize(db.data());
+    }
+}
+BENCHMARK(BM_FftAmplitudeDb)->Arg(256)->Arg(1024)->Arg(4096);
+
+// STFT work per hop for one sensor, as SpectrumWorker does it: a quarter window of
+// new samples goes into the circular window of each axis, which is then unrolled
+// and transformed. Three sensors at 1 kHz with 1024-point windows need about
+// 12 hops per second.
+static void BM_StftHop(benchmark::State& state) {
+    const std::size_t fftSize = static_cast<std::size_t>(state.range(0));
+    const std::size_t hop = fftSize / 4;
+    Fft fft(fftSize);
+    std::vector<float> window[3], frame(fftSize), db(fft.bins());
+    for (auto& axis : window) {
+        axis.assign(fftSize, 0.0f);
+    }
+    std::size_t windowPos = 0;
+    std::uint64_t sample = 0;
+
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < hop; ++i, ++sample) {
+            for (int axis = 0; axis < 3; ++axis) {
+                window[axis][windowPos] = std::sin(0.01f * static_cast<float>(sample % 10000) * (axis + 1));
+            }
+            windowPos = (windowPos + 1) % fftSize;
+        }
+        for (int axis = 0; axis < 3; ++axis) {
+            std::copy(window[axis].begin() + windowPos, window[axis].end(), frame.begin());
+            std::copy(window[axis].begin(), window[axis].begin() + windowPos, frame.begin() + (fftSize - windowPos));
+            fft.amplitudeDb(frame.data(), db.data());
+            benchmark::DoNotOptimize(db.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * hop);
+}
+BENCHMARK(BM_StftHop)->Arg(1024);
@@ -0,0 +1,33 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <vector>
+
+#include "SimdStats.h"
+
+// Min/max/mean/RMS over one axis of a window, per kernel. Three axes of three plots
+// take 9 of these per frame with stats or auto-fit on; compare against the 8.3 ms
+// frame budget at 120 FPS.
+static void BM_AxisStats(benchmark::State& state) {
+    const std::vector<AxisStatsKernel> kernels = axisStatsKernels();
+    const std::size_t index = static_cast<std::size_t>(state.range(0));
+    if (index >= kernels.size()) {
+        state.SkipWithError("Kernel not available on this CPU");
+        return;
+    }
+    const AxisStatsKernel& kernel = kernels[index];
+    const std::size_t n = static_cast<std::size_t>(state.range(1));
+    std::vector<float> data(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        data[i] = std::sin(0.01f * i) + 0.001f * (i % 7);
+    }
+
+    for (auto _ : state) {
+        AxisStats stats = kernel.compute(data.data(), n);
+        benchmark::DoNotOptimize(stats);
+    }
+    state.SetLabel(kernel.name);
+    state.SetItemsProcessed(state.iterations() * n);
+}
+// Kernel index: 0 scalar, 1 sse2, 2 avx2
+BENCHMARK(BM_AxisStats)->ArgNames({"kernel", "n"})->ArgsProduct({{0, 1, 2}, {1000, 100000}});
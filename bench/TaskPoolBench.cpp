@@ -0,0 +1,41 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <vector>
+
+#include "SimdStats.h"
+#include "TaskPool.h"
+
+// parallelFor() over simulated sensor streams with 1..N pool threads, the calling
+// thread working too. Each stream is the stats pass of one plot: three axes of a
+// 20 s window at 1 kHz. Items/s against the 1 thread row is the scaling.
+static void BM_ParallelForThreads(benchmark::State& state) {
+    const std::size_t threads = static_cast<std::size_t>(state.range(0));
+    const std::size_t streams = static_cast<std::size_t>(state.range(1));
+    constexpr std::size_t window = 20000;
+    std::vector<std::vector<float>> axes(streams * 3, std::vector<float>(window));
+    for (std::size_t a = 0; a < axes.size(); ++a) {
+        for (std::size_t i = 0; i < window; ++i) {
+            axes[a][i] = std::sin(0.001f * (i + 37 * a));
+        }
+    }
+    std::vector<double> results(streams);
+
+    TaskPool pool(threads);
+    for (auto _ : state) {
+        pool.parallelFor(streams, [&](std::size_t s) {
+            double sum = 0.0;
+            for (std::size_t axis = 0; axis < 3; ++axis) {
+                sum += computeAxisStats(axes[s * 3 + axis].data(), window).rms;
+            }
+            results[s] = sum;
+        });
+        benchmark::DoNotOptimize(results.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * streams);
+}
+BENCHMARK(BM_ParallelForThreads)
+    ->ArgNames({"threads", "streams"})
+    ->ArgsProduct({{1, 2, 4, 8, 16}, {16, 64}})
+    ->UseRealTime();
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+// Fixed-size, zero-initialized heap array aligned to a cache line.
+// Large arrays are mapped directly and marked for transparent huge pages on Linux,
+// which keeps TLB pressure low for long sample windows.
+template <typename T>
+class AlignedArray {
+    static_assert(std::is_trivially_copyable<T>::value, "AlignedArray holds raw sample data only");
+
+public:
+    static constexpr std::size_t alignment = 64;
+    static constexpr std::size_t hugePageSize = 2 * 1024 * 1024;
+
+    explicit AlignedArray(std::size_t count) : m_size(count) {
+        const std::size_t bytes = count * sizeof(T);
+#if defined(__linux__)
+        if (bytes >= hugePageSize) {
+            m_mapped_bytes = (bytes + hugePageSize - 1) / hugePageSize * hugePageSize;
+            void* p = mmap(nullptr, m_mapped_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            madvise(p, m_mapped_bytes, MADV_HUGEPAGE);
+            m_data = static_cast<T*>(p);
+            return;
+        }
+#endif
+        m_data = static_cast<T*>(::operator new(bytes == 0 ? alignment : bytes, std::align_val_t(alignment)));
+        std::memset(static_cast<void*>(m_data), 0, bytes);
+    }
+
+    ~AlignedArray() {
+#if defined(__linux__)
+        if (m_mapped_bytes != 0) {
+            munmap(m_data, m_mapped_bytes);
+            return;
+        }
+#endif
+        ::operator delete(m_data, std::align_val_t(alignment));
+    }
+
+    AlignedArray(const AlignedArray&) = delete;
+    AlignedArray& operator=(const AlignedArray&) = delete;
+
+    T* data() { return m_data; }
+    const T* data() const { return m_data; }
+    T& operator[](std::size_t i) { return m_data[i]; }
+    const T& operator[](std::size_t i) const { return m_data[i]; }
+    std::size_t size() const { return m_size; }
+    std::size_t bytes() const { return m_mapped_bytes != 0 ? m_mapped_bytes : m_size * sizeof(T); }
+
+private:
+    T* m_data = nullptr;
+    std::size_t m_size;
+    std::size_t m_mapped_bytes = 0;
+};
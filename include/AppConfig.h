@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+#include "Config.h"
+#include "LoadProfile.h"
+#include "OverloadPolicy.h"
+
+// Runtime settings. Read from "key = value" lines of a config file given with
+// --config <file>, then overridden by --key=value (or --key value) arguments.
+//
+// Keys: gyro-hz, accel-hz, mag-hz, buffer-seconds, history-seconds, port, io-threads,
+// worker-threads, record, replay, replay-speed, telemetry-file, fusion-beta, max-sessions,
+// max-devices, overload-policy, max-ingest-rate, trigger-pre, trigger-post, load-devices, load-batch,
+// load-jitter, load-dropout, load-signal, load-target
+struct AppConfig {
+    int gyroFreq = defaultGyroFreq;
+    int accelFreq = defaultAccelFreq;
+    int magFreq = defaultMagFreq;
+    int bufferSeconds = defaultBufferSeconds;
+    int historySeconds = defaultHistorySeconds; // Compressed tier behind the buffers, 0 for none
+    unsigned short port = defaultServerPort;
+    int ioThreads = defaultIoThreads;
+    int workerThreads = defaultWorkerThreads;
+    std::string recordPath; // Record incoming data to this file if set
+    std::string replayPath; // Play this recording back instead of the synthetic load
+    double replaySpeed = 1.0; // Playback speed factor, 0 for as fast as possible
+    std::string telemetryPath; // Write the telemetry counters here on exit if set
+    float fusionBeta = defaultFusionBeta;
+    int maxSessions = defaultMaxSessions;
+    int maxDevices = defaultMaxDevices; // Devices are never removed, so this bounds their buffer memory
+    OverloadPolicy overloadPolicy = OverloadPolicy::DropOldest;
+    double maxIngestRate = 0.0; // Samples/s per session over all sensors, 0 picks one from the sensor rates
+    double triggerPreSeconds = defaultTriggerPreSeconds;   // Captured before and after each trigger
+    double triggerPostSeconds = defaultTriggerPostSeconds;
+
+    // Synthetic load, generated unless a recording is replayed (see LoadGenerator.h)
+    int loadDevices = defaultLoadDevices;
+    int loadBatch = defaultLoadBatch;
+    double loadJitter = 0.0;  // Frames are sent up to this many seconds late, at random
+    double loadDropout = 0.0; // Fraction of frames lost on the way
+    LoadSignal loadSignal = LoadSignal::Sine;
+    LoadTarget loadTarget = LoadTarget::Socket;
+
+    std::size_t gyroBufferSize() const { return std::size_t(gyroFreq) * bufferSeconds; }
+    std::size_t accelBufferSize() const { return std::size_t(accelFreq) * bufferSeconds; }
+    std::size_t magBufferSize() const { return std::size_t(magFreq) * bufferSeconds; }
+
+    // Samples held by the buffers of one device; the two orientation buffers run at the gyro rate
+    std::size_t deviceBufferSamples() const {
+        return 3 * gyroBufferSize() + accelBufferSize() + magBufferSize();
+    }
+
+    double ingestRate() const {
+        return maxIngestRate > 0.0 ? maxIngestRate : defaultIngestHeadroom * (gyroFreq + accelFreq + magFreq);
+    }
+};
+
+// Throws std::invalid_argument on unknown keys, bad values, or buffers larger than
+// maxDeviceBufferSamples per device
+AppConfig loadConfig(int argc, char** argv);
+
+void printUsage(const char* program);
@@ -0,0 +1,92 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+// Long, compressed history of one sensor, kept behind its hot ring buffer.
+//
+// Samples are packed into blocks of blockSamples. Times are stored as microsecond
+// delta-of-deltas and each axis as first or second order deltas of its values
+// quantized to 12 bits of the block's range, both with Gorilla-style variable length
+// codes: evenly spaced times cost one bit, smooth signals a few bits per value. Every block also keeps the exact
+// min/max of each axis, so zoomed-out plots are drawn from the summaries without
+// decoding anything. Blocks older than the retention time are dropped.
+//
+// The quantization is lossy: decoded values are within 1/8190 of their block's range.
+//
+// One writer (see HistoryWorker), any number of readers. The block list is guarded by
+// a mutex; readers hold it while they read summaries or copy the blocks they decode,
+// not while decoding.
+class CompressedHistory {
+public:
+    static constexpr std::size_t blockSamples = 256;
+    static constexpr unsigned quantBits = 12;
+
+    explicit CompressedHistory(double retentionSeconds);
+
+    CompressedHistory(const CompressedHistory&) = delete;
+    CompressedHistory& operator=(const CompressedHistory&) = delete;
+
+    // Writer side. Timestamps in seconds, increasing.
+    void append(const double* t, const float* x, const float* y, const float* z, std::size_t n);
+
+    // Min/max decimated copy of the samples between 'from' and 'to', in the format of
+    // ThreadSafeRingBuffer::readDecimated(): every group contributes its minimum at its
+    // first time and its maximum at its last. Ranges spanning at least buckets / 4
+    // blocks are built from the block summaries alone; shorter ones are decoded into
+    // 'buckets' time slices. Outputs need maxPoints(buckets) entries. Returns the points written.
+    std::size_t readDecimated(double from, double to, std::size_t buckets,
+                              double* t, float* x, float* y, float* z) const;
+
+    static std::size_t maxPoints(std::size_t buckets) { return 2 * buckets + 2; }
+
+    // Time of the newest sample, 0 while empty
+    double newestTime() const;
+    double oldestTime() const;
+
+    // Bumped by every append(), lets plots skip rebuilding
+    std::uint64_t version() const { return appended.load(std::memory_order_acquire); }
+
+    std::uint64_t sampleCount() const;
+    // Compressed blocks and their summaries, plus the open block
+    std::size_t memoryBytes() const;
+
+private:
+    struct Summary {
+        double first = 0.0; // Times of the first and last sample
+        double last = 0.0;
+        float min[3] = {0.0f, 0.0f, 0.0f};
+        float max[3] = {0.0f, 0.0f, 0.0f};
+        std::uint32_t count = 0;
+    };
+
+    struct Block {
+        Summary summary;
+        float step[3];                   // Quantization step per axis, 0 for a constant axis
+        std::vector<std::uint64_t> bits; // Times, then x, y and z
+    };
+
+    void seal();
+    void include(Summary& summary, double t, const float (&v)[3]) const;
+    static std::size_t decode(const Block& block, double* t, float* x, float* y, float* z);
+
+    const double retention;
+    mutable std::mutex mtx;
+    std::deque<Block> blocks;        // Sealed, oldest first
+    std::vector<std::uint64_t> scratch; // seal() encodes into this first
+
+    // Block being filled
+    Summary open;
+    std::array<double, blockSamples> openT;
+    std::array<float, blockSamples> openX;
+    std::array<float, blockSamples> openY;
+    std::array<float, blockSamples> openZ;
+
+    std::size_t payloadBytes = 0;
+    std::uint64_t samples = 0;
+    std::atomic<std::uint64_t> appended{0};
+};
@@ -4,17 +4,44 @@
 
 const int screenWidth = 1280;
 const int screenHeight = 800;
-const int targetFrameRate = 120;
+const int targetFrameRate = 120;     // While data arrives or the user interacts
+const int backgroundFrameRate = 30;  // Window unfocused, data still arriving
+const int idleFrameRate = 10;        // Nothing new to show
+const double activeHoldSeconds = 0.5; // Stay at the full rate this long after the last activity
 
-constexpr int gyroFreq = 100;
-constexpr int accelFreq = 200;
-constexpr int magFreq = 200;
-constexpr int bufferSeconds = 5;
+// Defaults, overridable from a config file or the command line (see AppConfig.h)
+constexpr unsigned short defaultServerPort = 8000;
+constexpr int defaultIoThreads = 4; // Threads running the WebSocket io_context
+constexpr int defaultWorkerThreads = 0; // TaskPool threads, 0 for one per core
 
-constexpr std::size_t gyroBufferSize = gyroFreq * bufferSeconds;
-constexpr std::size_t accelBufferSize = accelFreq * bufferSeconds;
-constexpr std::size_t magBufferSize = magFreq * bufferSeconds;
+constexpr int defaultGyroFreq = 100;
+constexpr int defaultAccelFreq = 200;
+constexpr int defaultMagFreq = 200;
+constexpr int defaultBufferSeconds = 5;
+constexpr std::size_t maxDeviceBufferSamples = 50000000; // Over all buffers of one device, about 1 GiB
+constexpr int defaultHistorySeconds = 600; // Compressed history kept behind the buffers, 0 turns it off
+constexpr int defaultLoadDevices = 1; // Simulated devices when nothing is replayed, 0 for none
+constexpr int defaultLoadBatch = 10;  // Samples of the fastest sensor per generated frame
+constexpr int defaultMaxSessions = 64; // Further connections are closed right away
+constexpr int defaultMaxDevices = 256; // Distinct device IDs given buffers, further IDs are refused
+constexpr double defaultIngestHeadroom = 4.0; // Default ingest budget, as a multiple of the nominal sensor rates
+constexpr double ingestBurstSeconds = 0.5; // Budget a session can save up for bursts
+constexpr double maxReadPauseSeconds = 1.0; // Longest a paused session waits before reading again
+constexpr float defaultFusionBeta = 0.1f; // Madgwick filter gain, higher trusts accel/mag more
 
-using GyroBuffer = ThreadSafeRingBuffer<gyroBufferSize>;
-using AccelBuffer = ThreadSafeRingBuffer<accelBufferSize>;
-using MagBuffer = ThreadSafeRingBuffer<magBufferSize>;
\ No newline at end of file
+// Spectrum view: FFT length and how many frames (one per FFT length / 4 samples) the spectrogram keeps
+constexpr std::size_t spectrumFftSize = 1024;
+constexpr std::size_t spectrumHistory = 128;
+
+// Triggered capture: window kept around each event, slots in the capture pool, conditions
+constexpr double defaultTriggerPreSeconds = 1.0;
+constexpr double defaultTriggerPostSeconds = 1.0;
+constexpr std::size_t triggerCaptureSlots = 32;
+constexpr std::size_t maxTriggerConditions = 8;
+
+// Buffers are sized at runtime from the sensor rates and window length.
+// Use ThreadSafeRingBuffer<N> where a fixed, compile-time capacity is wanted.
+using GyroBuffer = ThreadSafeRingBuffer<>;
+using AccelBuffer = ThreadSafeRingBuffer<>;
+using MagBuffer = ThreadSafeRingBuffer<>;
+using OrientationBuffer = ThreadSafeRingBuffer<>; // Fusion output, sampled at the gyro rate
@@ -0,0 +1,108 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "AppConfig.h"
+#include "CompressedHistory.h"
+#include "Config.h"
+#include "Telemetry.h"
+
+// Ring buffers for one IMU. Each device has a single producer (its session),
+// so the buffers stay single-producer / single-consumer. The orientation buffers
+// are filled from the sensor buffers by the FusionWorker.
+struct DeviceBuffers {
+    DeviceBuffers(std::string deviceId, const AppConfig& appConfig)
+        : id(std::move(deviceId)), config(appConfig),
+          gyro(appConfig.gyroBufferSize()), accel(appConfig.accelBufferSize()), mag(appConfig.magBufferSize()),
+          euler(appConfig.gyroBufferSize()), quaternion(appConfig.gyroBufferSize()),
+          gyroHistory(appConfig.historySeconds), accelHistory(appConfig.historySeconds),
+          magHistory(appConfig.historySeconds), eulerHistory(appConfig.historySeconds)
+    {
+        gyro.setNominalRate(config.gyroFreq);
+        accel.setNominalRate(config.accelFreq);
+        mag.setNominalRate(config.magFreq);
+    }
+
+    std::size_t memoryBytes() const {
+        return gyro.memoryBytes() + accel.memoryBytes() + mag.memoryBytes() +
+               euler.memoryBytes() + quaternion.memoryBytes();
+    }
+
+    // What memoryBytes() comes to for a device under 'config', reported at startup
+    static std::size_t memoryBytesFor(const AppConfig& config) {
+        return GyroBuffer::memoryBytesFor(config.gyroBufferSize()) +
+               AccelBuffer::memoryBytesFor(config.accelBufferSize()) +
+               MagBuffer::memoryBytesFor(config.magBufferSize()) +
+               2 * OrientationBuffer::memoryBytesFor(config.gyroBufferSize());
+    }
+
+    std::size_t historyBytes() const {
+        return gyroHistory.memoryBytes() + accelHistory.memoryBytes() + magHistory.memoryBytes() +
+               eulerHistory.memoryBytes();
+    }
+
+    const std::string id;
+    const AppConfig& config;
+    GyroBuffer gyro;
+    AccelBuffer accel;
+    MagBuffer mag;
+
+    // Written by the FusionWorker: roll/pitch/yaw in degrees, and the orientation
+    // quaternion's x/y/z with w >= 0 implied (w = sqrt(1 - x^2 - y^2 - z^2))
+    OrientationBuffer euler;
+    OrientationBuffer quaternion;
+
+    // Compressed minutes to hours behind the plotted buffers, written by the
+    // HistoryWorker when history-seconds is set
+    CompressedHistory gyroHistory;
+    CompressedHistory accelHistory;
+    CompressedHistory magHistory;
+    CompressedHistory eulerHistory;
+
+    std::atomic<bool> connected{false};
+
+    // Samples lost inside the pipeline, as opposed to gaps in the device timestamps
+    std::atomic<std::uint64_t> parseErrors{0};
+    std::atomic<std::uint64_t> rejectedSamples{0};
+
+    // Overload handling of the session (see OverloadPolicy.h)
+    std::atomic<std::uint64_t> overBudgetSamples{0}; // drop-oldest: trimmed from the start of batches
+    std::atomic<std::uint64_t> droppedSamples{0};    // drop-newest: discarded batches
+    std::atomic<std::uint64_t> decimatedSamples{0};  // decimate: samples left out
+    std::atomic<std::uint64_t> readPauses{0};        // pause: times reading was held back
+
+    // When the newest batch came off the socket, for the receive-to-plot latency
+    IMU_TELEMETRY(std::atomic<std::int64_t> lastReceiveNs{0};)
+};
+
+// Device-ID keyed set of buffers shared by the server and the UI.
+// Devices are never removed, so references stay valid for the registry's lifetime
+// and a reconnecting device continues in its old buffers. AppConfig::maxDevices
+// bounds how many there can be.
+class DeviceRegistry {
+public:
+    explicit DeviceRegistry(const AppConfig& config) : config_(config) {}
+
+    const AppConfig& config() const { return config_; }
+
+    // Marks the device as connected and returns its buffers, creating them on first use.
+    // Returns nullptr if the device already has a live producer, or if it is new and
+    // the registry already holds maxDevices devices.
+    DeviceBuffers* connect(const std::string& id);
+    void disconnect(DeviceBuffers& device);
+
+    std::vector<DeviceBuffers*> devices() const;
+
+    // Incremented whenever a device is added, lets the UI skip refreshing its device list
+    std::uint64_t version() const { return version_.load(std::memory_order_acquire); }
+
+private:
+    const AppConfig& config_;
+    mutable std::mutex mtx_;
+    std::vector<std::unique_ptr<DeviceBuffers>> devices_;
+    std::atomic<std::uint64_t> version_{0};
+};
@@ -0,0 +1,32 @@
+#pragma once
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+// Radix-2 FFT of real, Hann windowed frames of a fixed power of two length.
+// Twiddles, the bit reversal permutation and the window are computed once in the
+// constructor, and the scratch buffer is reused, so transforms never allocate.
+// One instance per thread.
+class Fft {
+public:
+    // Throws std::invalid_argument unless size is a power of two >= 4
+    explicit Fft(std::size_t size);
+
+    std::size_t size() const { return n; }
+    std::size_t bins() const { return n / 2 + 1; }
+
+    // Amplitude spectrum of 'frame' (size() samples) in dB into 'db' (bins() values).
+    // The frame mean is removed first so a static offset like gravity doesn't
+    // swamp the low bins.
+    void amplitudeDb(const float* frame, float* db);
+
+private:
+    void transform();
+
+    std::size_t n;
+    std::vector<float> window;
+    float windowGain;                        // Sum of the window, normalizes amplitudes
+    std::vector<std::complex<float>> twiddles; // e^(-2 pi i k / n), k < n / 2
+    std::vector<std::size_t> bitReversed;
+    std::vector<std::complex<float>> scratch;
+};
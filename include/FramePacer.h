@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "DeviceRegistry.h"
+
+// Adapts the frame rate to what is happening instead of always running at
+// targetFrameRate: full rate while samples arrive or the user interacts, a reduced
+// rate for live data behind an unfocused window, and idleFrameRate when nothing on
+// screen would change. Activity keeps the full rate for activeHoldSeconds so bursts
+// of input or data don't flip the rate every frame.
+class FramePacer {
+private:
+    DeviceRegistry& m_registry;
+    std::uint64_t m_registry_version;             // Registry version m_devices was taken at
+    std::vector<const DeviceBuffers*> m_devices;  // Refreshed only when devices are added
+    std::uint64_t m_generation; // Sum of every buffer's written() count
+    double m_last_input;        // GetTime() of the last input event
+    double m_last_data;         // GetTime() new samples were last seen
+    int m_frame_rate;
+
+    std::uint64_t DataGeneration();
+    static bool HasInput();
+
+public:
+    explicit FramePacer(DeviceRegistry& registry_ref);
+
+    // Picks the rate for the next frame, call after the UI was submitted
+    void Update();
+    int FrameRate() const { return m_frame_rate; }
+};
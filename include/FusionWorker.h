@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "DeviceRegistry.h"
+#include "MadgwickFilter.h"
+#include "TaskPool.h"
+
+// Background AHRS stage. Follows the gyro, accel and mag buffers of every device in
+// the registry and writes the fused orientation into the device's euler and
+// quaternion buffers, one output per gyro sample.
+//
+// Samples are pulled in batches with readSince(), so the worker never blocks the
+// producers and all scratch space is allocated once per device. Accel and mag
+// readings are merged by timestamp: each gyro step uses the newest accel/mag sample
+// that is not newer than it. Devices are processed in parallel on the TaskPool.
+class FusionWorker {
+public:
+    static constexpr std::size_t batchSamples = 256;
+
+    FusionWorker(DeviceRegistry& registry, TaskPool& pool);
+    ~FusionWorker();
+
+    FusionWorker(const FusionWorker&) = delete;
+    FusionWorker& operator=(const FusionWorker&) = delete;
+
+private:
+    // Samples read from one sensor buffer but not consumed yet
+    struct Pending {
+        std::uint64_t cursor = 0;
+        std::size_t pos = 0;
+        std::size_t count = 0;
+        double t[batchSamples];
+        float x[batchSamples];
+        float y[batchSamples];
+        float z[batchSamples];
+    };
+
+    struct DeviceState {
+        DeviceState(DeviceBuffers& device, float beta) : device(device), filter(beta) {}
+
+        DeviceBuffers& device;
+        MadgwickFilter filter;
+        Pending gyro;
+        Pending accel;
+        Pending mag;
+        float a[3] = {0.0f, 0.0f, 0.0f}; // Newest accel/mag reading applied so far
+        float m[3] = {0.0f, 0.0f, 0.0f};
+        double lastTime = 0.0;
+        bool started = false;
+
+        // Output batch
+        double outT[batchSamples];
+        float roll[batchSamples], pitch[batchSamples], yaw[batchSamples];
+        float qx[batchSamples], qy[batchSamples], qz[batchSamples];
+    };
+
+    void workerLoop();
+    void syncDevices();
+    // Processes one batch of gyro samples, returns false if there were none
+    bool process(DeviceState& state);
+
+    DeviceRegistry& registry;
+    TaskPool& pool;
+    std::uint64_t registryVersion = 0;
+    std::vector<std::unique_ptr<DeviceState>> states;
+
+    std::atomic<bool> running{true};
+    std::thread worker;
+};
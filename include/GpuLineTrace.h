@@ -0,0 +1,90 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "imgui.h"
+
+// One sensor's x/y/z traces kept on the GPU, for plots with far more samples than pixels.
+//
+// The samples live in a vertex buffer used as a ring of 'capacity' points, and each
+// frame only the samples that arrived since the last one are uploaded. A line segment
+// is one instance of a 6-vertex quad that the vertex shader builds from two
+// neighbouring points, so nothing is expanded on the CPU. Times are stored as float
+// pairs (hi + lo) relative to the first sample and scrolled with a uniform offset,
+// so uploaded points never have to be rewritten as time moves on.
+//
+// Drawing goes through rlgl from an ImDrawList callback queued inside the current
+// ImPlot item, so the lines are clipped to the plot and sit under its legend.
+class GpuLineTrace {
+public:
+    explicit GpuLineTrace(std::size_t capacity);
+    ~GpuLineTrace();
+
+    GpuLineTrace(const GpuLineTrace&) = delete;
+    GpuLineTrace& operator=(const GpuLineTrace&) = delete;
+
+    // False on GL versions without instancing or if the shader didn't build.
+    // Needs the window to be open.
+    static bool Supported();
+    // False if the buffers couldn't be created, draw the decimated plot instead
+    bool Ready() const;
+
+    // Uploads what 'buffer' (a ThreadSafeRingBuffer) got since the last call
+    template <typename Buffer>
+    void Sync(const Buffer& buffer) {
+        std::uint64_t cursor = m_next;
+        while (std::size_t n = buffer.readSince(cursor, chunk_size, m_t.data(), m_x.data(), m_y.data(), m_z.data())) {
+            Upload(cursor - n, n);
+        }
+    }
+
+    // Samples that can be drawn, and the time of the newest one
+    std::size_t Resident() const;
+    double NewestTime() const { return m_newest; }
+
+    // Queues 'axis' (0-2) of the trace into the current plot item. Times are plotted
+    // relative to 'origin', like the decimated plots. Returns the segments drawn.
+    std::size_t Plot(int axis, ImU32 color, float weight, double origin) const;
+
+private:
+    struct DrawParams {
+        const GpuLineTrace* trace;
+        std::uint64_t first;  // Absolute index of the first segment's start point
+        std::size_t segments;
+        float rect[4];        // Plot area in pixels: x, y, width, height
+        float limits[4];      // Visible x (relative to origin) and y range
+        float origin[2];      // Origin relative to the base time, hi + lo
+        float display[2];     // ImGui display size
+        float color[4];
+        float halfWidth;
+        int axis;
+    };
+
+    static constexpr std::size_t chunk_size = 4096;
+    static constexpr std::size_t point_floats = 5; // Time hi, time lo, x, y, z
+
+    void Upload(std::uint64_t first, std::size_t n);
+    void WritePoints(std::size_t slot, const float* points, std::size_t count);
+    std::uint64_t FirstVisible(double from) const;
+    void Render(const DrawParams& params) const;
+    static void DrawCallback(const ImDrawList* list, const ImDrawCmd* cmd);
+
+    const std::size_t m_capacity;
+    unsigned int m_vao;
+    unsigned int m_vbo; // capacity + 1 points, the last one mirrors slot 0
+
+    std::uint64_t m_next;        // Absolute index of the next sample to upload
+    std::uint64_t m_valid_from;  // Older slots are stale after the reader was lapped
+    bool m_has_base;
+    double m_base;               // Time of the first sample, stored times are relative to it
+    double m_newest;
+    std::vector<double> m_times; // CPU copy of each slot's time, to skip invisible segments
+
+    // Staging for readSince() and the interleaved upload
+    std::vector<double> m_t;
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<float> m_z;
+    std::vector<float> m_points;
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "CompressedHistory.h"
+#include "DeviceRegistry.h"
+#include "TaskPool.h"
+
+// Background stage feeding the compressed history tier. Follows the gyro, accel, mag
+// and euler buffers of every device with readSince() and appends what's new to the
+// device's CompressedHistory, so the long history survives after the ring buffers
+// wrap. Every buffer is a separate task on the TaskPool.
+class HistoryWorker {
+public:
+    HistoryWorker(DeviceRegistry& registry, TaskPool& pool);
+    ~HistoryWorker();
+
+    HistoryWorker(const HistoryWorker&) = delete;
+    HistoryWorker& operator=(const HistoryWorker&) = delete;
+
+private:
+    static constexpr std::size_t readChunk = 256;
+    static constexpr std::size_t streamsPerDevice = 4;
+
+    // One buffer of one device and the history it feeds
+    struct Stream {
+        const ThreadSafeRingBuffer<>* buffer;
+        CompressedHistory* history;
+        std::uint64_t cursor = 0;
+        double t[readChunk]; // Scratch for readSince()
+        float x[readChunk];
+        float y[readChunk];
+        float z[readChunk];
+    };
+
+    void workerLoop();
+    void syncDevices();
+    bool process(Stream& stream);
+
+    DeviceRegistry& registry;
+    TaskPool& pool;
+    std::uint64_t registryVersion = 0;
+    std::vector<std::unique_ptr<Stream>> streams;
+    std::size_t devices = 0;
+
+    std::atomic<bool> running{true};
+    std::thread worker;
+};
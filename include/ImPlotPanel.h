@@ -3,10 +3,28 @@
 #include "imgui.h"
 #include "ThreadSafeRingBuffer.h"
 #include "Config.h"
+#include "DeviceRegistry.h"
+#include "ReplayEngine.h"
 #include "SensorPlot.h"
+#include "TaskPool.h"
+#include <memory>
+#include <vector>
 
 class ImPlotPanel {
 private:
+    // Plots for one device in the registry
+    struct DevicePlots {
+        explicit DevicePlots(DeviceBuffers& device);
+
+        DeviceBuffers& device;
+        bool visible;
+        SensorPlot<> gyroPlot;
+        SensorPlot<> accelPlot;
+        SensorPlot<> magPlot;
+        SensorPlot<> orientationPlot; // Fused roll/pitch/yaw
+        IMU_TELEMETRY(std::int64_t plottedReceiveNs = 0;) // Newest batch already counted as plotted
+    };
+
     int m_posX;
     int m_posY;
     int m_width;
@@ -14,23 +32,31 @@ private:
     
     float m_vertical_zoom;   // Overall panel zoom (affects height)
     float m_horizontal_zoom; // X-axis zoom (shared across plots)
+    float m_buffer_seconds;  // Time range shown at 1x zoom
+    float m_min_time_zoom;   // Lowest X zoom, reaches back over the compressed history
+    bool m_auto_fit_y;       // Fit each plot's Y axis to its visible samples
+    bool m_show_stats;       // Per-axis mean/RMS/range in the plot legends
+    bool m_gpu_lines;        // Every sample through GpuLineTrace instead of decimated plots (opt-in)
     
-    SensorPlot<gyroBufferSize> m_gyroPlot;
-    SensorPlot<accelBufferSize> m_accelPlot;
-    SensorPlot<magBufferSize> m_magPlot;
+    DeviceRegistry& m_registry;
+    std::uint64_t m_registry_version;
+    std::vector<std::unique_ptr<DevicePlots>> m_devices;
+    TaskPool& m_pool;
+    std::vector<const SensorPlot<>*> m_prepare; // Visible plots, prepared on the pool each frame
+    ReplayEngine* m_replay; // Null unless a recording is played back
+    float m_seek_position;  // Seek slider value
+    bool m_seek_dragging;   // Slider held by the user, don't follow playback
 
     static constexpr float min_zoom = 0.1f;
     static constexpr float max_zoom = 10.0f;
 
+    void SyncDevices();
+    static void DrawDeviceStats(const DeviceBuffers& device);
+    void DrawReplayControls();
+
 public:
     ImPlotPanel(int posX, int posY, int width, int height, 
-                GyroBuffer& gyroBuffer_ref,
-                AccelBuffer& accelBuffer_ref, 
-                MagBuffer& magBuffer_ref,
-                std::array<float, gyroBufferSize>& gyroTimeBuffer_ref,
-                std::array<float, accelBufferSize>& accelTimeBuffer_ref,
-                std::array<float, magBufferSize>& magTimeBuffer_ref
-                );
+                DeviceRegistry& registry_ref, TaskPool& pool_ref, ReplayEngine* replay = nullptr);
 
     void Draw();
-};
\ No newline at end of file
+};
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Binary frame layout (all fields little-endian):
+//
+//   ImuFrameHeader                           20 bytes
+//   gyroCount  * { float32 x, y, z }
+//   accelCount * { float32 x, y, z }
+//   magCount   * { float32 x, y, z }
+//
+// Binary frames are sent as WebSocket binary messages; text messages keep
+// using the "Acc: [..], Gyro: [..], Mag: [..]" format, optionally with a
+// leading "T: <seconds>" device timestamp.
+constexpr std::uint8_t imuFrameMagic0 = 'I';
+constexpr std::uint8_t imuFrameMagic1 = 'M';
+constexpr std::uint8_t imuFrameVersion = 1;
+constexpr std::size_t imuFrameHeaderSize = 20;
+
+struct ImuFrameHeader {
+    std::uint8_t version;
+    std::uint8_t flags;         // Reserved, must be 0
+    std::uint16_t gyroCount;
+    std::uint16_t accelCount;
+    std::uint16_t magCount;
+                                // 2 reserved bytes, must be 0
+    std::uint64_t timestampUs;  // Device timestamp of the frame
+};
+
+// Samples of one sensor in structure-of-arrays form, ready for ThreadSafeRingBuffer::append.
+// The vectors only ever grow, so parsing into a reused batch does not allocate.
+struct SensorSamples {
+    std::vector<double> t; // Seconds, filled by stamp()
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::size_t count = 0;
+
+    void resize(std::size_t n);
+
+    // Gives the newest sample time 'newest' and spaces the older ones 'period' apart
+    void stamp(double newest, double period);
+
+    // Keeps the newest 'n' samples
+    void keepNewest(std::size_t n);
+
+    // Keeps every 'factor'-th sample, counting back from the newest. Returns the new count.
+    std::size_t decimate(std::size_t factor);
+};
+
+struct ImuBatch {
+    std::uint64_t timestampUs = 0; // Device time of the newest sample of each sensor
+    bool hasTimestamp = false;
+    SensorSamples gyro;
+    SensorSamples accel;
+    SensorSamples mag;
+};
+
+// Decodes a binary frame. Returns false on a malformed or truncated frame, and on
+// frames with an unknown version or non-zero flags or reserved bytes.
+bool parseBinaryFrame(const void* data, std::size_t size, ImuBatch& batch);
+
+// Parses a text frame. Returns false if the message does not match the text format.
+bool parseTextFrame(const char* data, std::size_t size, ImuBatch& batch);
+
+// Encodes a batch as a binary frame, replacing the contents of 'out'.
+void encodeBinaryFrame(const ImuBatch& batch, std::vector<std::uint8_t>& out);
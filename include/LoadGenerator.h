@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DeviceRegistry.h"
+#include "TriggerEngine.h"
+
+// Synthetic IMU devices standing in for real ones, for the demo data and for
+// reproducing production load on a dev box (see LoadProfile.h for the settings).
+//
+// Every device runs on its own thread and sends frames of load-batch samples of its
+// fastest sensor, the other sensors in proportion to their rates. Frame deadlines are
+// absolute, counted from the start, and the samples of each sensor are derived from
+// the frame number, so pacing doesn't drift or lose samples to rounding and rates of
+// tens of kHz work. A thread that falls behind catches up without sleeping.
+//
+// In direct mode the frames go through 'triggers' after being appended, like the
+// sessions do in socket mode.
+//
+// Jitter delays single frames without moving the later deadlines. Dropped frames are
+// lost with their samples, which the buffers then count as timestamp gaps.
+//
+// Devices are named load-1 .. load-N. The destructor stops and joins every thread.
+class LoadGenerator {
+public:
+    // Starts generating right away. In socket mode the server must be listening on
+    // config.port; devices keep retrying until it accepts them. 'triggers' may be null.
+    LoadGenerator(DeviceRegistry& registry, const AppConfig& config, TriggerEngine* triggers);
+    ~LoadGenerator();
+
+    LoadGenerator(const LoadGenerator&) = delete;
+    LoadGenerator& operator=(const LoadGenerator&) = delete;
+
+    std::uint64_t samplesSent() const { return generated.load(std::memory_order_relaxed); }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    void deviceLoop(int index);
+    // False once stop was requested
+    bool sleepUntil(clock::time_point until);
+
+    DeviceRegistry& registry;
+    const AppConfig& config;
+    TriggerEngine* triggers;
+    const int rates[3];     // Gyro, accel and mag
+    const int fastestRate;
+    const double framePeriod; // Seconds
+
+    std::mutex mtx;
+    std::condition_variable wakeup;
+    bool stopping = false;
+
+    const clock::time_point start;
+    std::atomic<std::uint64_t> generated{0};
+    std::atomic<std::uint64_t> droppedFrames{0};
+    std::atomic<std::uint64_t> lateFrames{0}; // Sent more than a frame period after their deadline
+
+    std::vector<std::thread> threads;
+};
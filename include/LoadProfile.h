@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+// Settings of the synthetic load generator (see LoadGenerator.h)
+
+// Waveform of the generated samples, each sensor with its own base frequency
+//
+//   Sine    x/y/z at 1, 1/2 and 1/3 of the base frequency
+//   Square  the same, clipped to +-1
+//   Chirp   sweeps from the base frequency up 50x over 10 s, then starts over
+//   Noise   Gaussian, standard deviation 0.5
+enum class LoadSignal {
+    Sine,
+    Square,
+    Chirp,
+    Noise
+};
+
+// Where generated frames go
+//
+//   Socket  encoded as binary frames and sent to our own WebSocket server, so the
+//           whole socket-to-plot path (parsing, budgets, triggers, recording) runs.
+//           The default.
+//   Direct  appended straight to the device buffers and checked by the triggers, no
+//           sockets, budgets or recording involved. For profiling the rendering side.
+enum class LoadTarget {
+    Direct,
+    Socket
+};
+
+inline const char* loadSignalName(LoadSignal signal) {
+    switch (signal) {
+        case LoadSignal::Sine: return "sine";
+        case LoadSignal::Square: return "square";
+        case LoadSignal::Chirp: return "chirp";
+        case LoadSignal::Noise: return "noise";
+    }
+    return "unknown";
+}
+
+inline const char* loadTargetName(LoadTarget target) {
+    switch (target) {
+        case LoadTarget::Direct: return "direct";
+        case LoadTarget::Socket: return "socket";
+    }
+    return "unknown";
+}
+
+// Both throw std::invalid_argument for anything but the names above
+inline LoadSignal parseLoadSignal(const std::string& name) {
+    for (LoadSignal signal : {LoadSignal::Sine, LoadSignal::Square, LoadSignal::Chirp, LoadSignal::Noise}) {
+        if (name == loadSignalName(signal)) {
+            return signal;
+        }
+    }
+    throw std::invalid_argument("Unknown load signal '" + name + "'");
+}
+
+inline LoadTarget parseLoadTarget(const std::string& name) {
+    for (LoadTarget target : {LoadTarget::Direct, LoadTarget::Socket}) {
+        if (name == loadTargetName(target)) {
+            return target;
+        }
+    }
+    throw std::invalid_argument("Unknown load target '" + name + "'");
+}
+
+// Samples due from a sensor at 'rate' Hz by the end of generator frame 'frame', when
+// every frame carries 'batch' samples of the fastest sensor: exactly
+// floor(frame * batch * rate / fastest). Split so the product can't overflow however
+// long the generator runs.
+inline std::uint64_t loadSamplesDue(std::uint64_t frame, std::uint64_t batch, std::uint64_t rate,
+                                    std::uint64_t fastest) {
+    return frame / fastest * batch * rate + frame % fastest * batch * rate / fastest;
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+
+// Unit quaternion, w + xi + yj + zk
+struct UnitQuaternion {
+    float w = 1.0f;
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+};
+
+// Madgwick's gradient descent AHRS filter (MARG variant, falling back to
+// gyro + accel when there is no magnetometer reading). Gyro in rad/s; accel and
+// mag only need consistent units since they are normalized. All state is inline,
+// so an update never allocates.
+class MadgwickFilter {
+public:
+    explicit MadgwickFilter(float beta) : beta(beta) {}
+
+    const UnitQuaternion& orientation() const { return q; }
+
+    void update(float gx, float gy, float gz, float ax, float ay, float az,
+                float mx, float my, float mz, float dt) {
+        if (mx == 0.0f && my == 0.0f && mz == 0.0f) {
+            updateImu(gx, gy, gz, ax, ay, az, dt);
+            return;
+        }
+
+        float q0 = q.w, q1 = q.x, q2 = q.y, q3 = q.z;
+
+        // Rate of change from the gyroscope
+        float qDot1 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+        float qDot2 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
+        float qDot3 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
+        float qDot4 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+
+        if (normalize(ax, ay, az)) {
+            normalize(mx, my, mz);
+
+            // Reference direction of Earth's magnetic field
+            float _2q0mx = 2.0f * q0 * mx, _2q0my = 2.0f * q0 * my, _2q0mz = 2.0f * q0 * mz;
+            float _2q1mx = 2.0f * q1 * mx;
+            float _2q0 = 2.0f * q0, _2q1 = 2.0f * q1, _2q2 = 2.0f * q2, _2q3 = 2.0f * q3;
+            float _2q0q2 = 2.0f * q0 * q2, _2q2q3 = 2.0f * q2 * q3;
+            float q0q0 = q0 * q0, q0q1 = q0 * q1, q0q2 = q0 * q2, q0q3 = q0 * q3;
+            float q1q1 = q1 * q1, q1q2 = q1 * q2, q1q3 = q1 * q3;
+            float q2q2 = q2 * q2, q2q3 = q2 * q3, q3q3 = q3 * q3;
+
+            float hx = mx * q0q0 - _2q0my * q3 + _2q0mz * q2 + mx * q1q1 + _2q1 * my * q2 + _2q1 * mz * q3
+                       - mx * q2q2 - mx * q3q3;
+            float hy = _2q0mx * q3 + my * q0q0 - _2q0mz * q1 + _2q1mx * q2 - my * q1q1 + my * q2q2
+                       + _2q2 * mz * q3 - my * q3q3;
+            float _2bx = std::sqrt(hx * hx + hy * hy);
+            float _2bz = -_2q0mx * q2 + _2q0my * q1 + mz * q0q0 + _2q1mx * q3 - mz * q1q1 + _2q2 * my * q3
+                         - mz * q2q2 + mz * q3q3;
+            float _4bx = 2.0f * _2bx, _4bz = 2.0f * _2bz;
+
+            // Gradient of the objective function
+            float s0 = -_2q2 * (2.0f * q1q3 - _2q0q2 - ax) + _2q1 * (2.0f * q0q1 + _2q2q3 - ay)
+                       - _2bz * q2 * (_2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx)
+                       + (-_2bx * q3 + _2bz * q1) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my)
+                       + _2bx * q2 * (_2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz);
+            float s1 = _2q3 * (2.0f * q1q3 - _2q0q2 - ax) + _2q0 * (2.0f * q0q1 + _2q2q3 - ay)
+                       - 4.0f * q1 * (1 - 2.0f * q1q1 - 2.0f * q2q2 - az)
+                       + _2bz * q3 * (_2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx)
+                       + (_2bx * q2 + _2bz * q0) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my)
+                       + (_2bx * q3 - _4bz * q1) * (_2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz);
+            float s2 = -_2q0 * (2.0f * q1q3 - _2q0q2 - ax) + _2q3 * (2.0f * q0q1 + _2q2q3 - ay)
+                       - 4.0f * q2 * (1 - 2.0f * q1q1 - 2.0f * q2q2 - az)
+                       + (-_4bx * q2 - _2bz * q0) * (_2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx)
+                       + (_2bx * q1 + _2bz * q3) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my)
+                       + (_2bx * q0 - _4bz * q2) * (_2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz);
+            float s3 = _2q1 * (2.0f * q1q3 - _2q0q2 - ax) + _2q2 * (2.0f * q0q1 + _2q2q3 - ay)
+                       + (-_4bx * q3 + _2bz * q1) * (_2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx)
+                       + (-_2bx * q0 + _2bz * q2) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my)
+                       + _2bx * q1 * (_2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz);
+            applyFeedback(qDot1, qDot2, qDot3, qDot4, s0, s1, s2, s3);
+        }
+        integrate(qDot1, qDot2, qDot3, qDot4, dt);
+    }
+
+    void updateImu(float gx, float gy, float gz, float ax, float ay, float az, float dt) {
+        float q0 = q.w, q1 = q.x, q2 = q.y, q3 = q.z;
+
+        float qDot1 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+        float qDot2 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
+        float qDot3 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
+        float qDot4 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+
+        if (normalize(ax, ay, az)) {
+            float _2q0 = 2.0f * q0, _2q1 = 2.0f * q1, _2q2 = 2.0f * q2, _2q3 = 2.0f * q3;
+            float _4q0 = 4.0f * q0, _4q1 = 4.0f * q1, _4q2 = 4.0f * q2;
+            float _8q1 = 8.0f * q1, _8q2 = 8.0f * q2;
+            float q0q0 = q0 * q0, q1q1 = q1 * q1, q2q2 = q2 * q2, q3q3 = q3 * q3;
+
+            float s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+            float s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+            float s2 = 4.0f * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+            float s3 = 4.0f * q1q1 * q3 - _2q1 * ax + 4.0f * q2q2 * q3 - _2q2 * ay;
+            applyFeedback(qDot1, qDot2, qDot3, qDot4, s0, s1, s2, s3);
+        }
+        integrate(qDot1, qDot2, qDot3, qDot4, dt);
+    }
+
+private:
+    static bool normalize(float& x, float& y, float& z) {
+        float norm = std::sqrt(x * x + y * y + z * z);
+        if (norm == 0.0f || !std::isfinite(norm)) {
+            return false;
+        }
+        x /= norm; y /= norm; z /= norm;
+        return true;
+    }
+
+    void applyFeedback(float& qDot1, float& qDot2, float& qDot3, float& qDot4,
+                       float s0, float s1, float s2, float s3) const {
+        float norm = std::sqrt(s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3);
+        if (norm == 0.0f) {
+            return;
+        }
+        qDot1 -= beta * s0 / norm;
+        qDot2 -= beta * s1 / norm;
+        qDot3 -= beta * s2 / norm;
+        qDot4 -= beta * s3 / norm;
+    }
+
+    void integrate(float qDot1, float qDot2, float qDot3, float qDot4, float dt) {
+        UnitQuaternion next{q.w + qDot1 * dt, q.x + qDot2 * dt, q.y + qDot3 * dt, q.z + qDot4 * dt};
+        float norm = std::sqrt(next.w * next.w + next.x * next.x + next.y * next.y + next.z * next.z);
+        if (norm == 0.0f || !std::isfinite(norm)) {
+            q = UnitQuaternion{}; // Garbage input, start over rather than propagating NaNs
+            return;
+        }
+        q = UnitQuaternion{next.w / norm, next.x / norm, next.y / norm, next.z / norm};
+    }
+
+    float beta;
+    UnitQuaternion q;
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define IMU_HAS_MMAP 1
+#endif
+
+// Read-only view of a whole file. Memory-mapped where available, so only the
+// pages that are actually touched get read; otherwise the file is loaded into memory.
+class MappedFile {
+public:
+    // Throws std::runtime_error if the file cannot be opened
+    explicit MappedFile(const std::string& path) {
+#if defined(IMU_HAS_MMAP)
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open '" + path + "'");
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            throw std::runtime_error("Cannot stat '" + path + "'");
+        }
+        m_size = static_cast<std::size_t>(st.st_size);
+        if (m_size > 0) {
+            void* p = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error("Cannot map '" + path + "'");
+            }
+            m_data = static_cast<const std::uint8_t*>(p);
+        }
+        close(fd);
+#else
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("Cannot open '" + path + "'");
+        }
+        m_copy.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        m_data = m_copy.data();
+        m_size = m_copy.size();
+#endif
+    }
+
+    ~MappedFile() {
+#if defined(IMU_HAS_MMAP)
+        if (m_data) {
+            munmap(const_cast<std::uint8_t*>(m_data), m_size);
+        }
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const std::uint8_t* data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+
+private:
+    const std::uint8_t* m_data = nullptr;
+    std::size_t m_size = 0;
+    std::vector<std::uint8_t> m_copy;
+};
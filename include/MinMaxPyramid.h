@@ -0,0 +1,105 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Per-axis min/max of a block of consecutive samples
+struct BlockSummary {
+    float min[3];
+    float max[3];
+};
+
+// Multi-resolution min/max summary of a sample stream, maintained incrementally.
+//
+// Level L (L >= 1) summarizes aligned blocks of 4^L samples: block j covers samples
+// [j * 4^L, (j + 1) * 4^L). A block is folded into its parent level as soon as it is
+// complete, so each appended sample costs O(1) amortized. Every level keeps enough
+// blocks to cover 'coverage' samples plus one block, which lets readers that validate
+// against the raw sample window also trust the summaries inside it.
+class MinMaxPyramid {
+public:
+    static constexpr unsigned fanoutBits = 2; // 4 children per block
+
+    explicit MinMaxPyramid(std::size_t coverage) {
+        storage.reserve(memoryBytesFor(coverage) / sizeof(BlockSummary));
+        for (std::size_t blockSize = 1u << fanoutBits; blockSize <= coverage; blockSize <<= fanoutBits) {
+            Level level;
+            level.offset = storage.size();
+            level.slots = levelSlots(coverage, blockSize);
+            storage.resize(storage.size() + level.slots);
+            levels.push_back(level);
+        }
+    }
+
+    // Number of summary levels, not counting the raw samples (level 0)
+    unsigned levelCount() const {
+        return static_cast<unsigned>(levels.size());
+    }
+
+    std::size_t memoryBytes() const {
+        return storage.capacity() * sizeof(BlockSummary);
+    }
+
+    // What memoryBytes() will be for a pyramid over 'coverage' samples
+    static std::size_t memoryBytesFor(std::size_t coverage) {
+        std::size_t slots = 0;
+        for (std::size_t blockSize = 1u << fanoutBits; blockSize <= coverage; blockSize <<= fanoutBits) {
+            slots += levelSlots(coverage, blockSize);
+        }
+        return slots * sizeof(BlockSummary);
+    }
+
+    static std::uint64_t blockSize(unsigned level) {
+        return std::uint64_t(1) << (fanoutBits * level);
+    }
+
+    // Producer side: feeds the sample with absolute index 'index'
+    void push(std::uint64_t index, float x, float y, float z) {
+        if (levels.empty()) {
+            return;
+        }
+        BlockSummary sample{{x, y, z}, {x, y, z}};
+        fold(1, index, sample);
+    }
+
+    // Summary of complete block 'block' on 'level' (level >= 1)
+    const BlockSummary& block(unsigned level, std::uint64_t block) const {
+        const Level& l = levels[level - 1];
+        return storage[l.offset + static_cast<std::size_t>(block % l.slots)];
+    }
+
+private:
+    static std::size_t levelSlots(std::size_t coverage, std::size_t blockSize) {
+        return (coverage + blockSize - 1) / blockSize + 1;
+    }
+
+    struct Level {
+        std::size_t offset;
+        std::size_t slots;
+    };
+
+    // Merges 'child' (index 'childIndex' on the level below) into its block on 'level'
+    void fold(unsigned level, std::uint64_t childIndex, const BlockSummary& child) {
+        constexpr std::uint64_t childMask = (1u << fanoutBits) - 1;
+        const Level& l = levels[level - 1];
+        const std::uint64_t blockIndex = childIndex >> fanoutBits;
+        BlockSummary& summary = storage[l.offset + static_cast<std::size_t>(blockIndex % l.slots)];
+
+        if ((childIndex & childMask) == 0) {
+            summary = child;
+        } else {
+            for (int axis = 0; axis < 3; ++axis) {
+                summary.min[axis] = std::min(summary.min[axis], child.min[axis]);
+                summary.max[axis] = std::max(summary.max[axis], child.max[axis]);
+            }
+        }
+
+        if ((childIndex & childMask) == childMask && level < levels.size()) {
+            fold(level + 1, blockIndex, summary);
+        }
+    }
+
+    std::vector<Level> levels;
+    std::vector<BlockSummary> storage;
+};
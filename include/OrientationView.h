@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "raylib.h"
+#include "DeviceRegistry.h"
+
+// 3D view of one device's fused orientation. The board is drawn into an off-screen
+// render texture which is then shown inside an ImGui window next to the plots.
+class OrientationView {
+private:
+    int m_posX;
+    int m_posY;
+    int m_width;
+    int m_height;
+    bool m_open;
+
+    DeviceRegistry& m_registry;
+    std::uint64_t m_registry_version;       // Registry version m_devices was taken at
+    std::vector<DeviceBuffers*> m_devices;  // Refreshed only when devices are added
+    int m_selected; // Index into m_devices
+
+    RenderTexture2D m_target;
+    Camera3D m_camera;
+    const DeviceBuffers* m_rendered_device;  // What the texture currently shows
+    std::uint64_t m_rendered_generation;
+
+    void SyncDevices();
+    DeviceBuffers* SelectedDevice() const;
+
+public:
+    OrientationView(int posX, int posY, int width, int height, DeviceRegistry& registry_ref);
+    ~OrientationView();
+
+    OrientationView(const OrientationView&) = delete;
+    OrientationView& operator=(const OrientationView&) = delete;
+
+    void Toggle() { m_open = !m_open; }
+
+    // Renders the scene into the texture if the orientation changed, call before BeginDrawing()
+    void Render();
+    // ImGui window showing the texture, call between rlImGuiBegin() and rlImGuiEnd()
+    void Draw();
+};
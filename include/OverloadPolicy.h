@@ -0,0 +1,68 @@
+#pragma once
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+// What a session does with samples arriving faster than its ingest budget
+// (AppConfig::ingestRate()). The budget is a token bucket refilled at the budget
+// rate, holding at most ingestBurstSeconds worth of samples.
+//
+//   DropOldest  drop the oldest samples of a batch, keeping its newest ones within the budget
+//   DropNewest  discard whole batches until the budget has room again
+//   Decimate    keep every k-th sample of a batch so it fits the budget
+//   Pause       admit everything, then stop reading the socket until the budget
+//               has recovered, so TCP flow control slows the device down
+enum class OverloadPolicy {
+    DropOldest,
+    DropNewest,
+    Decimate,
+    Pause
+};
+
+inline const char* overloadPolicyName(OverloadPolicy policy) {
+    switch (policy) {
+        case OverloadPolicy::DropOldest: return "drop-oldest";
+        case OverloadPolicy::DropNewest: return "drop-newest";
+        case OverloadPolicy::Decimate: return "decimate";
+        case OverloadPolicy::Pause: return "pause";
+    }
+    return "unknown";
+}
+
+// Throws std::invalid_argument for anything but the names above
+inline OverloadPolicy parseOverloadPolicy(const std::string& name) {
+    for (OverloadPolicy policy : {OverloadPolicy::DropOldest, OverloadPolicy::DropNewest,
+                                  OverloadPolicy::Decimate, OverloadPolicy::Pause}) {
+        if (name == overloadPolicyName(policy)) {
+            return policy;
+        }
+    }
+    throw std::invalid_argument("Unknown overload policy '" + name + "'");
+}
+
+// Sample budget of one session. Times are in seconds on any steady clock.
+// consume() may take more than is available; the debt is paid off by later refills.
+class TokenBucket {
+public:
+    TokenBucket(double rate, double burst) : rate(rate), burst(burst), tokens(burst) {}
+
+    void refill(double now) {
+        if (last >= 0.0) {
+            tokens = std::min(burst, tokens + (now - last) * rate);
+        }
+        last = now;
+    }
+
+    double available() const { return tokens; }
+
+    void consume(double n) { tokens -= n; }
+
+    // Time until the debt, if any, is paid off
+    double secondsInDebt() const { return tokens < 0.0 ? -tokens / rate : 0.0; }
+
+private:
+    double rate;
+    double burst;
+    double tokens;
+    double last = -1.0;
+};
@@ -0,0 +1,102 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ImuMessage.h"
+#include "RecordingFormat.h"
+#include "SpscQueue.h"
+
+// Streams everything received by the WebSocket sessions to a recording file
+// (see RecordingFormat.h) without blocking ingest.
+//
+// Each session writes through its own Stream, a lock-free SPSC queue of fixed-size
+// chunks. A background thread drains the queues into per-sensor column blocks and
+// writes finished blocks in large batches. If a queue is full the samples are
+// dropped and counted rather than stalling the network thread.
+class Recorder {
+public:
+    static constexpr std::size_t chunkSamples = 64;
+    static constexpr std::size_t streamQueueChunks = 1024; // ~1.3 MiB per stream
+
+    struct Chunk {
+        RecordSensor sensor;
+        std::uint16_t count;
+        std::int64_t t[chunkSamples]; // Microseconds
+        float x[chunkSamples];
+        float y[chunkSamples];
+        float z[chunkSamples];
+    };
+
+    // Producer handle for one device connection. Not thread safe; one per session.
+    class Stream {
+    public:
+        Stream(std::uint32_t deviceIndex, std::string deviceId, std::atomic<std::uint64_t>& droppedTotal);
+
+        // Queues the samples, returns false if some had to be dropped
+        bool write(RecordSensor sensor, const SensorSamples& samples);
+        void close() { closed.store(true, std::memory_order_release); }
+
+        std::uint64_t droppedSamples() const { return dropped.load(std::memory_order_relaxed); }
+
+    private:
+        friend class Recorder;
+        const std::uint32_t deviceIndex;
+        const std::string deviceId;
+        SpscQueue<Chunk> queue;
+        std::atomic<bool> closed{false};
+        std::atomic<std::uint64_t> dropped{0};
+        std::atomic<std::uint64_t>& droppedTotal;
+    };
+
+    // Opens the file and starts the writer thread. Throws std::runtime_error on failure.
+    explicit Recorder(const std::string& path);
+    ~Recorder();
+
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+
+    std::shared_ptr<Stream> openStream(const std::string& deviceId);
+
+    std::uint64_t bytesWritten() const { return bytes.load(std::memory_order_relaxed); }
+    std::uint64_t droppedSamples() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    // Samples of one sensor of one device waiting to become a block
+    struct Column {
+        std::vector<std::int64_t> t;
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> z;
+    };
+
+    void writerLoop();
+    bool drain(Stream& stream);
+    void encodeBlock(std::uint32_t deviceIndex, RecordSensor sensor, Column& column);
+    void encodeDevice(std::uint32_t deviceIndex, const std::string& deviceId);
+    void flushColumns();
+    void closeColumns(std::uint32_t deviceIndex);
+    void flushStaging();
+
+    std::FILE* file;
+    std::thread writer;
+    std::atomic<bool> running{true};
+
+    std::mutex streamsMtx;
+    std::vector<std::shared_ptr<Stream>> streams;
+    std::map<std::string, std::uint32_t> deviceIndices;
+
+    // Writer thread state
+    std::vector<bool> announced;
+    std::map<std::pair<std::uint32_t, RecordSensor>, Column> columns;
+    std::vector<std::uint8_t> staging;
+
+    std::atomic<std::uint64_t> bytes{0};
+    std::atomic<std::uint64_t> dropped{0};
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// On-disk layout of IMU recordings (all fields little-endian).
+//
+// File header (8 bytes): "IMUREC" followed by a uint16 format version.
+// Then a sequence of records, each starting with an 8 byte record header:
+//   uint8 type, 3 reserved bytes, uint32 payload size
+//
+// Device record: uint32 device index, device ID bytes (rest of the payload).
+// Announces a device before its first block.
+//
+// Block record: up to recordBlockSamples samples of one sensor of one device,
+// stored column by column:
+//   uint32 device index
+//   uint8 sensor (RecordSensor), 3 reserved bytes
+//   uint32 sample count
+//   int64 first timestamp (us), int64 last timestamp (us)
+//   uint32 size of the timestamp delta section
+//   count - 1 zigzag varint deltas between consecutive timestamps (us)
+//   float32 x[count], float32 y[count], float32 z[count]
+//
+// The first and last timestamps in each block header let readers build a time
+// index by hopping from header to header without decoding any samples.
+constexpr char recordingMagic[6] = {'I', 'M', 'U', 'R', 'E', 'C'};
+constexpr std::uint16_t recordingVersion = 1;
+constexpr std::size_t recordingFileHeaderSize = 8;
+constexpr std::size_t recordHeaderSize = 8;
+constexpr std::size_t blockHeaderSize = 32;
+constexpr std::size_t recordBlockSamples = 4096;
+
+enum class RecordType : std::uint8_t {
+    Device = 1,
+    Block = 2,
+};
+
+enum class RecordSensor : std::uint8_t {
+    Gyro = 0,
+    Accel = 1,
+    Mag = 2,
+};
+constexpr std::size_t recordSensorCount = 3;
+
+inline std::uint64_t zigzagEncode(std::int64_t v) {
+    return (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63);
+}
+
+inline std::int64_t zigzagDecode(std::uint64_t v) {
+    return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1);
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ImuMessage.h"
+#include "MappedFile.h"
+#include "RecordingFormat.h"
+
+// Random access reader for recordings written by Recorder.
+//
+// Opening a file only walks the record headers to build a sparse time index: one
+// entry per block, grouped by device and sensor and ordered by time. Samples are
+// decoded on demand, one block at a time, straight from the mapped file.
+class RecordingReader {
+public:
+    struct Block {
+        std::size_t offset;     // Start of the block payload in the file
+        std::uint32_t count;
+        std::uint32_t deltaBytes; // Size of the timestamp delta section
+        std::int64_t firstUs;
+        std::int64_t lastUs;
+    };
+
+    // All blocks of one sensor of one device, in time order
+    struct Track {
+        std::uint32_t deviceIndex;
+        RecordSensor sensor;
+        std::vector<Block> blocks;
+    };
+
+    // Throws std::runtime_error if the file is not a valid recording. Blocks whose
+    // sections don't fit their record are left out of the index.
+    explicit RecordingReader(const std::string& path);
+
+    const std::vector<std::string>& devices() const { return m_devices; }
+    const std::vector<Track>& tracks() const { return m_tracks; }
+
+    std::int64_t startUs() const { return m_startUs; }
+    std::int64_t endUs() const { return m_endUs; }
+
+    // Index of the first block of 'track' that ends at or after 'timeUs' (blocks.size() if none)
+    std::size_t findBlock(const Track& track, std::int64_t timeUs) const;
+
+    // Decodes a block into 'samples', with timestamps converted to seconds plus 'offsetSeconds'.
+    // Returns false, leaving 'samples' empty, if the timestamp deltas overrun their section.
+    bool decodeBlock(const Block& block, double offsetSeconds, SensorSamples& samples) const;
+
+private:
+    MappedFile m_file;
+    std::vector<std::string> m_devices;
+    std::vector<Track> m_tracks;
+    std::int64_t m_startUs = 0;
+    std::int64_t m_endUs = 0;
+};
@@ -0,0 +1,82 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DeviceRegistry.h"
+#include "ImuMessage.h"
+#include "RecordingReader.h"
+#include "TriggerEngine.h"
+
+// Plays a recording back into the device registry, standing in for live devices.
+//
+// Every recorded device shows up as "replay:<id>" and is fed through the normal
+// ring buffers from a background thread, so the UI cannot tell replayed data from
+// live data, and triggers fire on it the same way. Playback runs at any speed factor or as fast as possible (speed 0),
+// which also makes it an end-to-end throughput benchmark for the ingest path.
+// Seeking goes through the reader's time index and only decodes one block per track.
+//
+// Replayed timestamps always increase: after a seek the recording is shifted in time
+// so it continues right after the last sample already in the buffers.
+class ReplayEngine {
+public:
+    // Opens the recording and starts playing. Throws std::runtime_error if the file
+    // cannot be read or a replay device is already in use. 'triggers' may be null.
+    ReplayEngine(const std::string& path, DeviceRegistry& registry, double speed, TriggerEngine* triggers);
+    ~ReplayEngine();
+
+    ReplayEngine(const ReplayEngine&) = delete;
+    ReplayEngine& operator=(const ReplayEngine&) = delete;
+
+    // Controls, safe to call from any thread
+    void play();
+    void pause() { paused.store(true, std::memory_order_relaxed); }
+    void setSpeed(double factor); // 0 replays as fast as possible
+    void seek(double seconds);    // Relative to the start of the recording
+
+    bool isPaused() const { return paused.load(std::memory_order_relaxed); }
+    bool isFinished() const { return finished.load(std::memory_order_relaxed); }
+    double speed() const { return speedFactor.load(std::memory_order_relaxed); }
+    double position() const { return positionUs.load(std::memory_order_relaxed) * 1e-6; }
+    double duration() const { return (reader.endUs() - reader.startUs()) * 1e-6; }
+    std::uint64_t samplesReplayed() const { return samples.load(std::memory_order_relaxed); }
+
+private:
+    // Playback state of one recorded sensor stream
+    struct Track {
+        const RecordingReader::Track* source;
+        ThreadSafeRingBuffer<>* buffer;
+        TriggerEngine::Stream* trigger; // Of the track's device, null without triggers
+        std::size_t nextBlock = 0;
+        SensorSamples decoded; // Current block, timestamps already shifted
+        std::size_t next = 0;  // Next sample of 'decoded' to replay
+    };
+
+    void playbackLoop();
+    void applySeek(std::int64_t timeUs);
+    // Appends the samples of 'track' up to 'timeUs', returns false once the track is exhausted
+    bool feed(Track& track, std::int64_t timeUs);
+
+    RecordingReader reader;
+    DeviceRegistry& registry;
+    std::vector<DeviceBuffers*> devices;
+    std::vector<std::shared_ptr<TriggerEngine::Stream>> triggerStreams; // One per device, used by the playback thread
+    std::vector<Track> tracks;
+
+    // Playback thread state
+    double offsetSeconds = 0.0; // Added to recorded timestamps
+    double lastSeconds;         // Newest timestamp appended so far
+    double minPeriod;
+
+    std::atomic<bool> running{true};
+    std::atomic<bool> paused{false};
+    std::atomic<bool> finished{false};
+    std::atomic<double> speedFactor;
+    std::atomic<std::int64_t> seekRequest; // Recording time in µs, noSeek if none
+    std::atomic<std::int64_t> positionUs{0};
+    std::atomic<std::uint64_t> samples{0};
+    std::thread worker;
+};
@@ -0,0 +1,119 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+
+#include "AlignedArray.h"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Storage for one channel of a ring buffer, addressable as 2 * capacity elements
+// where element i + capacity aliases element i.
+//
+// On Linux the same physical pages are mapped twice back to back (memfd_create plus
+// two mmaps), so a write is visible in both halves and wrap-around is free. That
+// needs capacity * sizeof(T) to be a multiple of the page size; otherwise, or if
+// the mapping fails, the channel falls back to a plain 2 * capacity array and the
+// writer has to store each element twice (see mirrored()).
+template <typename T>
+class RingChannel {
+public:
+    RingChannel(std::size_t capacity, bool tryMirror) : m_capacity(capacity) {
+        if (!tryMirror || !mapMirrored()) {
+            m_fallback = std::make_unique<AlignedArray<T>>(2 * capacity);
+            m_data = m_fallback->data();
+        }
+    }
+
+    ~RingChannel() {
+#if defined(__linux__)
+        if (!m_fallback && m_data) {
+            munmap(m_data, 2 * m_capacity * sizeof(T));
+        }
+#endif
+    }
+
+    RingChannel(const RingChannel&) = delete;
+    RingChannel& operator=(const RingChannel&) = delete;
+
+    // True if both halves share memory, so one write updates both
+    bool mirrored() const { return !m_fallback; }
+
+    T* data() { return m_data; }
+    const T* data() const { return m_data; }
+    T& operator[](std::size_t i) { return m_data[i]; }
+    const T& operator[](std::size_t i) const { return m_data[i]; }
+
+    std::size_t bytes() const {
+        return m_fallback ? m_fallback->bytes() : m_capacity * sizeof(T);
+    }
+
+    // Stores 'len' elements at 'pos' (pos + len <= 2 * capacity) so both halves see them
+    void write(std::size_t pos, const T* src, std::size_t len) {
+        if (mirrored()) {
+            std::copy(src, src + len, m_data + pos);
+            return;
+        }
+        // Plain storage: split at the wrap point and write each part to both halves
+        std::size_t start = pos % m_capacity;
+        std::size_t first = std::min(len, m_capacity - start);
+        std::copy(src, src + first, m_data + start);
+        std::copy(src, src + first, m_data + start + m_capacity);
+        std::copy(src + first, src + len, m_data);
+        std::copy(src + first, src + len, m_data + m_capacity);
+    }
+
+    static std::size_t pageSize() {
+#if defined(__linux__)
+        static const std::size_t size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        return size;
+#else
+        return 4096;
+#endif
+    }
+
+private:
+    bool mapMirrored() {
+#if defined(__linux__)
+        const std::size_t bytes = m_capacity * sizeof(T);
+        if (bytes == 0 || bytes % pageSize() != 0) {
+            return false;
+        }
+
+        int fd = memfd_create("imu-ring", MFD_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            close(fd);
+            return false;
+        }
+
+        // Reserve the address range, then map the file into both halves of it
+        void* base = mmap(nullptr, 2 * bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        char* p = static_cast<char*>(base);
+        bool mapped = mmap(p, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED &&
+                      mmap(p + bytes, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED;
+        close(fd); // The mappings keep the memory alive
+        if (!mapped) {
+            munmap(base, 2 * bytes);
+            return false;
+        }
+        m_data = static_cast<T*>(base);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    std::size_t m_capacity;
+    T* m_data = nullptr;
+    std::unique_ptr<AlignedArray<T>> m_fallback;
+};
@@ -1,9 +1,11 @@
 #pragma once
 #include "Config.h"
-#include "ThreadSafeRingBuffer.h"
+#include "DeviceRegistry.h"
+#include "ReplayEngine.h"
+#include "SpectrumWorker.h"
+#include "TaskPool.h"
+#include "TriggerEngine.h"
 
-void runApp(GyroBuffer &gyroBuffer, AccelBuffer &accelBuffer, MagBuffer &magBuffer, 
-            std::array<float, gyroBufferSize>& gyroTimeBuffer, 
-            std::array<float, accelBufferSize>& accelTimeBuffer, 
-            std::array<float, magBufferSize>& magTimeBuffer
-            );
\ No newline at end of file
+// 'replay' is optional, its controls are shown if set
+void runApp(DeviceRegistry &registry, TaskPool &pool, SpectrumWorker &spectrum, TriggerEngine &triggers,
+            ReplayEngine *replay);
\ No newline at end of file
@@ -1,46 +1,96 @@
 #pragma once
 #include "ThreadSafeRingBuffer.h"
 #include "Config.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
 #include <vector>
 #include <string>
 #include <cmath>
 #include <iostream>
 #include <functional>
+#include <memory>
 #include "implot.h"
+#include "implot_internal.h"
+#include "GpuLineTrace.h"
+#include "CompressedHistory.h"
+#include "SimdStats.h"
 
-template <size_t Capacity>
+template <size_t Capacity = DynamicCapacity>
 class SensorPlot {
 private:
     std::string m_name;
     ThreadSafeRingBuffer<Capacity>& m_data_buffer_ref;
-    std::array<float, Capacity>& m_time_buffer_ref;
+    const CompressedHistory* m_history; // Longer windows than the buffer holds come from here, may be null
+    float m_hot_seconds;                // Buffer length, ranges beyond it use m_history
+    std::array<const char*, 3> m_axis_names;
     mutable float m_y_min; // Track Y-axis limits
     mutable float m_y_max;
-    static constexpr size_t MAX_PLOT_POINTS = 1000; // Downsampling threshold 
+    static constexpr size_t MAX_PLOT_POINTS = 1000; // Downsampling threshold (min/max buckets per plot)
 
-public:
-    SensorPlot(const std::string name, ThreadSafeRingBuffer<Capacity>& buffer, std::array<float, Capacity>& timeBuffer)
-        : m_name(name), m_data_buffer_ref(buffer), m_time_buffer_ref(timeBuffer),
-          m_y_min(-1.1f), m_y_max(1.1f) {}
+    // Decimated copy of the buffer window for this frame, sized once so drawing never allocates
+    mutable std::vector<double> m_t_snapshot;
+    mutable std::vector<float> m_time_axis; // Snapshot times relative to the newest sample
+    mutable std::vector<float> m_x_snapshot;
+    mutable std::vector<float> m_y_snapshot;
+    mutable std::vector<float> m_z_snapshot;
+    mutable AxisStats m_stats[3]; // Visible window, when auto-fit or the stats readout is on
 
-    void Draw(float height, float horizontal_zoom) const {
-        if (ImPlot::BeginPlot(m_name.c_str(), ImVec2(-1, height))) {
-            const float* xDataPtr = nullptr;
-            const float* yDataPtr = nullptr;
-            const float* zDataPtr = nullptr;
-            m_data_buffer_ref.getRecentPointers(Capacity, &xDataPtr, &yDataPtr, &zDataPtr);
+    // What the snapshot was built from, so frames without new samples reuse it
+    mutable std::uint64_t m_generation; // Buffer's written() count, or the history's version()
+    mutable float m_range;              // Displayed range in seconds
+    mutable size_t m_buckets;           // Decimation buckets, 0 forces a rebuild
+    mutable size_t m_count;             // Points in the snapshot
+    mutable size_t m_last_buckets;      // Buckets the last Draw() asked for, used by Prepare()
+    mutable bool m_prepared;            // Prepare() ran since the last Draw()
+    mutable bool m_has_stats;
+    mutable bool m_stats_current;       // m_stats match m_generation and m_range
+
+    mutable std::unique_ptr<GpuLineTrace> m_gpu; // Created on first use of the GPU path
 
-            
-            if (xDataPtr && yDataPtr && zDataPtr) {
-                float displayed_range = bufferSeconds / horizontal_zoom;
+public:
+    SensorPlot(const std::string name, ThreadSafeRingBuffer<Capacity>& buffer,
+               std::array<const char*, 3> axis_names = {"X", "Y", "Z"}, float y_limit = 1.1f,
+               const CompressedHistory* history = nullptr, float hot_seconds = 0.0f)
+        : m_name(name), m_data_buffer_ref(buffer), m_history(history), m_hot_seconds(hot_seconds),
+          m_axis_names(axis_names),
+          m_y_min(-y_limit), m_y_max(y_limit),
+          m_t_snapshot(std::max(buffer.maxDecimatedPoints(MAX_PLOT_POINTS),
+                                history ? CompressedHistory::maxPoints(MAX_PLOT_POINTS) : 0)),
+          m_time_axis(m_t_snapshot.size()),
+          m_x_snapshot(m_t_snapshot.size()),
+          m_y_snapshot(m_t_snapshot.size()),
+          m_z_snapshot(m_t_snapshot.size()),
+          m_generation(0), m_range(0.0f), m_buckets(0), m_count(0), m_last_buckets(0), m_prepared(false),
+          m_has_stats(false), m_stats_current(false) {}
 
+    // Draws the last 'displayed_range' seconds of data. 'auto_fit_y' fits the Y axis to
+    // the visible samples, 'show_stats' adds mean/RMS/range of each axis to the legend.
+    // 'gpu_lines' draws every sample through GpuLineTrace instead of a decimated copy.
+    // Ranges longer than the buffer are drawn from the compressed history, if there is one.
+    void Draw(float height, float displayed_range, bool auto_fit_y = false, bool show_stats = false,
+              bool gpu_lines = false) const {
+        if (ImPlot::BeginPlot(m_name.c_str(), ImVec2(-1, height))) {
+            const size_t available = m_data_buffer_ref.size();
+            // A prepared snapshot is kept for this frame even if samples arrived since
+            if (!m_prepared) {
+                Refresh(displayed_range, auto_fit_y || show_stats);
+            }
+            const bool has_stats = (auto_fit_y || show_stats) && m_has_stats;
+            if (available > 0) {
                 // Configure X axis label formatter
                 ImPlot::SetupAxisFormat(ImAxis_X1, TimeFormatter);
 
                 // Configure axes
                 ImPlot::SetupAxes("Time (s)", "Value");
                 ImPlot::SetupAxisLimits(ImAxis_X1, -displayed_range, 0, ImGuiCond_Always);
-                ImPlot::SetupAxisLimits(ImAxis_Y1, m_y_min, m_y_max, ImGuiCond_Once);
+                if (auto_fit_y && has_stats) {
+                    FitY();
+                    ImPlot::SetupAxisLimits(ImAxis_Y1, m_y_min, m_y_max, ImGuiCond_Always);
+                } else {
+                    ImPlot::SetupAxisLimits(ImAxis_Y1, m_y_min, m_y_max, ImGuiCond_Once);
+                }
 
                 // Handle Y-axis zoom 
                 if (ImPlot::IsPlotHovered() && !ImGui::GetIO().KeyCtrl && !ImGui::GetIO().KeyShift) {
@@ -56,37 +106,152 @@ public:
                     }
                 }
 
-                // Plot data 
-                if (Capacity <= MAX_PLOT_POINTS) {
-                    ImPlot::PlotLine("X", m_time_buffer_ref.data(), xDataPtr, Capacity);
-                    ImPlot::PlotLine("Y", m_time_buffer_ref.data(), yDataPtr, Capacity);
-                    ImPlot::PlotLine("Z", m_time_buffer_ref.data(), zDataPtr, Capacity);
-                } else {
-                    // Downsample by taking every nth point
-                    size_t step = Capacity / MAX_PLOT_POINTS;
-                    std::vector<float> sampledTime, sampledX, sampledY, sampledZ;
-                    sampledTime.reserve(MAX_PLOT_POINTS);
-                    sampledX.reserve(MAX_PLOT_POINTS);
-                    sampledY.reserve(MAX_PLOT_POINTS);
-                    sampledZ.reserve(MAX_PLOT_POINTS);
-                    
-                    for (size_t i = 0; i < Capacity; i += step) {
-                        sampledTime.push_back(m_time_buffer_ref[i]);
-                        sampledX.push_back(xDataPtr[i]);
-                        sampledY.push_back(yDataPtr[i]);
-                        sampledZ.push_back(zDataPtr[i]);
+                // Legend labels, with the stats readout if enabled
+                char labels[3][112];
+                for (int axis = 0; axis < 3; ++axis) {
+                    const char* name = m_axis_names[axis];
+                    if (show_stats && has_stats) {
+                        // "###" keeps the item ID stable while the text changes
+                        snprintf(labels[axis], sizeof(labels[axis]), "%s  mean %.3f  rms %.3f  [%.3f, %.3f]###%s",
+                                 name, m_stats[axis].mean, m_stats[axis].rms,
+                                 m_stats[axis].min, m_stats[axis].max, name);
+                    } else {
+                        snprintf(labels[axis], sizeof(labels[axis]), "%s", name);
                     }
-                    
-                    ImPlot::PlotLine("X", sampledTime.data(), sampledX.data(), sampledTime.size());
-                    ImPlot::PlotLine("Y", sampledTime.data(), sampledY.data(), sampledTime.size());
-                    ImPlot::PlotLine("Z", sampledTime.data(), sampledZ.data(), sampledTime.size());                    
+                }
+
+                if (!gpu_lines || FromHistory(displayed_range) || !DrawGpuLines(labels)) {
+                    DrawDecimated(labels, displayed_range);
                 }
             }
             ImPlot::EndPlot();
         }
+        m_prepared = false;
+    }
+
+    // Reads what the next Draw() with the same settings will need: the window stats
+    // if 'want_stats', and the decimated snapshot unless 'gpu_lines'. Touches no ImGui
+    // state, so the panel prepares its plots in parallel before drawing them. The
+    // snapshot is sized for the plot width of the previous Draw().
+    void Prepare(float displayed_range, bool want_stats, bool gpu_lines) const {
+        Refresh(displayed_range, want_stats);
+        if ((!gpu_lines || FromHistory(displayed_range)) && m_last_buckets > 0) {
+            if (m_last_buckets != m_buckets) {
+                Decimate(displayed_range, m_last_buckets);
+            } else {
+                IMU_TELEMETRY(telemetry().plotsReused.add());
+            }
+        }
+        m_prepared = true;
     }
 
 private:
+    bool FromHistory(float displayed_range) const {
+        return m_history && displayed_range > m_hot_seconds;
+    }
+
+    // Drops the cached snapshot and stats once new samples arrived or the window changed
+    void Refresh(float displayed_range, bool want_stats) const {
+        const bool from_history = FromHistory(displayed_range);
+        const std::uint64_t generation = from_history ? m_history->version() : m_data_buffer_ref.written();
+        if (generation != m_generation || displayed_range != m_range) {
+            m_generation = generation;
+            m_range = displayed_range;
+            m_buckets = 0;
+            m_stats_current = false;
+        }
+        if (want_stats && !m_stats_current) {
+            if (from_history) {
+                // Taken over the min/max envelope: exact range, approximate mean and RMS
+                if (m_buckets == 0) {
+                    Decimate(displayed_range, m_last_buckets > 0 ? m_last_buckets : MAX_PLOT_POINTS);
+                }
+                m_stats[0] = computeAxisStats(m_x_snapshot.data(), m_count);
+                m_stats[1] = computeAxisStats(m_y_snapshot.data(), m_count);
+                m_stats[2] = computeAxisStats(m_z_snapshot.data(), m_count);
+                m_has_stats = m_count > 0;
+            } else {
+                m_has_stats = m_data_buffer_ref.readStatsSpan(displayed_range, m_stats[0], m_stats[1], m_stats[2]);
+            }
+            m_stats_current = true;
+        }
+    }
+
+    void Decimate(float displayed_range, size_t buckets) const {
+        if (FromHistory(displayed_range)) {
+            // Whole blocks past the buffer come from their summaries, nothing is decoded
+            const double newest = m_history->newestTime();
+            m_count = m_history->readDecimated(newest - displayed_range, newest, buckets, m_t_snapshot.data(),
+                                               m_x_snapshot.data(), m_y_snapshot.data(), m_z_snapshot.data());
+        } else {
+            m_count = m_data_buffer_ref.readDecimatedSpan(displayed_range, buckets, m_t_snapshot.data(),
+                                                          m_x_snapshot.data(), m_y_snapshot.data(), m_z_snapshot.data());
+        }
+        m_buckets = buckets;
+        // The time axis ends at the newest sample
+        const double newest = m_count > 0 ? m_t_snapshot[m_count - 1] : 0.0;
+        for (size_t i = 0; i < m_count; ++i) {
+            m_time_axis[i] = static_cast<float>(m_t_snapshot[i] - newest);
+        }
+    }
+
+    // Only the visible time window is decimated; one min/max bucket per pixel
+    // column is enough to keep every peak visible
+    void DrawDecimated(const char (&labels)[3][112], float displayed_range) const {
+        const size_t buckets = std::clamp<size_t>(static_cast<size_t>(ImPlot::GetPlotSize().x), 1, MAX_PLOT_POINTS);
+        m_last_buckets = buckets;
+        if (buckets != m_buckets) {
+            Decimate(displayed_range, buckets);
+        } else if (!m_prepared) {
+            IMU_TELEMETRY(telemetry().plotsReused.add());
+        }
+
+        const size_t count = m_count;
+        if (count > 0) {
+            ImPlot::PlotLine(labels[0], m_time_axis.data(), m_x_snapshot.data(), count);
+            ImPlot::PlotLine(labels[1], m_time_axis.data(), m_y_snapshot.data(), count);
+            ImPlot::PlotLine(labels[2], m_time_axis.data(), m_z_snapshot.data(), count);
+            IMU_TELEMETRY(telemetry().pointsPlotted.add(3 * count));
+        }
+    }
+
+    // Every sample, drawn on the GPU from a persistent vertex buffer. Returns false
+    // if that isn't available, so the caller falls back to the decimated plot.
+    bool DrawGpuLines(const char (&labels)[3][112]) const {
+        if (!GpuLineTrace::Supported()) {
+            return false;
+        }
+        if (!m_gpu) {
+            m_gpu = std::make_unique<GpuLineTrace>(m_data_buffer_ref.capacity());
+        }
+        if (!m_gpu->Ready()) {
+            return false;
+        }
+
+        m_gpu->Sync(m_data_buffer_ref);
+        for (int axis = 0; axis < 3; ++axis) {
+            // A custom ImPlot item: legend entry, color, hiding and hover highlight as usual
+            if (ImPlot::BeginItem(labels[axis], 0, ImPlotCol_Line)) {
+                const ImPlotNextItemData& item = ImPlot::GetItemData();
+                const size_t segments = m_gpu->Plot(axis, ImGui::GetColorU32(item.Colors[ImPlotCol_Line]),
+                                                    item.LineWeight, m_gpu->NewestTime());
+                IMU_TELEMETRY(telemetry().pointsPlotted.add(segments));
+                ImPlot::EndItem();
+            }
+        }
+        return true;
+    }
+
+    // Y range covering all three axes of the visible window with a little headroom.
+    // Stored in m_y_min/m_y_max so turning auto-fit off keeps the current view.
+    void FitY() const {
+        float lo = std::min({m_stats[0].min, m_stats[1].min, m_stats[2].min});
+        float hi = std::max({m_stats[0].max, m_stats[1].max, m_stats[2].max});
+        float pad = std::max((hi - lo) * 0.05f, 1e-3f);
+        m_y_min = lo - pad;
+        m_y_max = hi + pad;
+    }
+
     // Custom formatter function for time axis
     static int TimeFormatter(double value, char* buff, int size, void* data) {
         // Only show labels for whole seconds
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Summary of one axis over a window of samples
+struct AxisStats {
+    float min = 0.0f;
+    float max = 0.0f;
+    double mean = 0.0;
+    double rms = 0.0;
+};
+
+// Min, max, mean and RMS of 'data[0..n)' in a single pass. Uses AVX2 or SSE2 when
+// the CPU has them (picked once at runtime) and plain C++ otherwise. Sums are carried
+// in double across blocks so long windows don't lose precision. Zeros for n == 0.
+AxisStats computeAxisStats(const float* data, std::size_t n);
+
+// Name of the kernel computeAxisStats() uses on this machine, for logs
+const char* axisStatsKernel();
+
+// One implementation of computeAxisStats(); 'compute' needs n > 0
+struct AxisStatsKernel {
+    const char* name;
+    AxisStats (*compute)(const float* data, std::size_t n);
+};
+
+// Every kernel this machine can run, scalar first, for tests and benchmarks
+std::vector<AxisStatsKernel> axisStatsKernels();
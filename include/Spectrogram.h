@@ -0,0 +1,56 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Ring of spectrum frames (one row of dB values per STFT step) with one writer and
+// lock-free readers, validated the same way as ThreadSafeRingBuffer: the writer
+// announces the row it is about to overwrite, and readers check it afterwards.
+class Spectrogram {
+public:
+    Spectrogram(std::size_t bins, std::size_t history, float sampleRate, std::size_t hop)
+        : bins_(bins), history_(history), sampleRate_(sampleRate), hop_(hop), rows(bins * history) {}
+
+    std::size_t bins() const { return bins_; }
+    std::size_t history() const { return history_; }
+    float sampleRate() const { return sampleRate_; }
+    std::size_t hop() const { return hop_; } // Samples between frames
+
+    // Frames published so far, doubles as a change counter for the UI
+    std::uint64_t frames() const { return published.load(std::memory_order_acquire); }
+
+    // Writer: row to fill for the next frame, then publish()
+    float* beginFrame() {
+        const std::uint64_t next = published.load(std::memory_order_relaxed);
+        pending.store(next + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        return rows.data() + static_cast<std::size_t>(next % history_) * bins_;
+    }
+
+    void publish() {
+        published.store(pending.load(std::memory_order_relaxed), std::memory_order_release);
+    }
+
+    // Copies frame 'frame' into 'out' (bins() values). False if it isn't published
+    // yet or has already been overwritten.
+    bool readFrame(std::uint64_t frame, float* out) const {
+        if (frame >= frames()) {
+            return false;
+        }
+        const float* row = rows.data() + static_cast<std::size_t>(frame % history_) * bins_;
+        std::copy(row, row + bins_, out);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return pending.load(std::memory_order_relaxed) <= frame + history_;
+    }
+
+private:
+    const std::size_t bins_;
+    const std::size_t history_;
+    const float sampleRate_;
+    const std::size_t hop_;
+    std::vector<float> rows;
+    std::atomic<std::uint64_t> published{0};
+    std::atomic<std::uint64_t> pending{0};
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "raylib.h"
+#include "DeviceRegistry.h"
+#include "SpectrumWorker.h"
+
+// Spectrum and scrolling spectrogram of one sensor axis, toggled with F5.
+//
+// The spectrogram lives in a texture with one column per STFT frame. Each new frame
+// updates a single column, and the view scrolls by shifting the texture coordinates
+// (the texture repeats), so nothing is redrawn per cell.
+class SpectrumPanel {
+private:
+    int m_posX;
+    int m_posY;
+    int m_width;
+    int m_height;
+    bool m_open;
+
+    DeviceRegistry& m_registry;
+    SpectrumWorker& m_worker;
+    std::uint64_t m_registry_version;       // Registry version m_devices was taken at
+    std::vector<DeviceBuffers*> m_devices;  // Refreshed only when devices are added
+    int m_device;
+    int m_sensor;
+    int m_axis;
+    float m_db_min; // Colormap range
+    float m_db_max;
+
+    const Spectrogram* m_source; // Spectrogram in the texture
+    std::uint64_t m_uploaded;    // Frames of m_source already in the texture
+    Texture2D m_texture;
+    std::vector<Color> m_column;
+    std::vector<float> m_row;
+    std::vector<float> m_spectrum; // Newest frame
+    std::vector<float> m_freqs;
+    Color m_colormap[256];
+
+    void SyncDevices();
+    void Select(const Spectrogram* source);
+    void Upload();
+    void RecolorColumn(const std::vector<float>& row);
+
+public:
+    SpectrumPanel(int posX, int posY, int width, int height,
+                  DeviceRegistry& registry_ref, SpectrumWorker& worker_ref);
+    ~SpectrumPanel();
+
+    SpectrumPanel(const SpectrumPanel&) = delete;
+    SpectrumPanel& operator=(const SpectrumPanel&) = delete;
+
+    void Toggle() { m_open = !m_open; }
+    void Draw();
+};
@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "DeviceRegistry.h"
+#include "Fft.h"
+#include "RecordingFormat.h"
+#include "Spectrogram.h"
+#include "TaskPool.h"
+
+// Background short-time Fourier transform of every axis of every sensor.
+//
+// New samples are pulled with readSince() into a sliding window per axis; every
+// 'hop' samples the newest window is transformed and appended to that axis's
+// Spectrogram. Only new data is processed, nothing is recomputed per frame.
+// Every sensor of every device is a separate task on the TaskPool.
+class SpectrumWorker {
+public:
+    SpectrumWorker(DeviceRegistry& registry, TaskPool& pool, std::size_t fftSize, std::size_t history);
+    ~SpectrumWorker();
+
+    SpectrumWorker(const SpectrumWorker&) = delete;
+    SpectrumWorker& operator=(const SpectrumWorker&) = delete;
+
+    // Spectrogram of one axis (0..2) of a device's sensor, nullptr until the worker
+    // has picked the device up. Stays valid for the worker's lifetime.
+    const Spectrogram* spectrogram(const DeviceBuffers& device, RecordSensor sensor, int axis) const;
+
+private:
+    static constexpr std::size_t readChunk = 256;
+
+    // One sensor of one device, with its own scratch so streams run in parallel
+    struct Stream {
+        ThreadSafeRingBuffer<>* buffer;
+        std::uint64_t cursor = 0;
+        std::vector<float> window[3];   // Last fftSize samples per axis, circular
+        std::size_t windowPos = 0;
+        std::size_t filled = 0;         // Samples in the window, up to fftSize
+        std::size_t sinceFrame = 0;     // Samples since the last transform
+        std::unique_ptr<Spectrogram> spectrograms[3];
+        std::unique_ptr<Fft> fft;
+        std::vector<float> frame; // Unrolled window handed to the FFT
+        double t[readChunk];      // Scratch for readSince()
+        float axes[3][readChunk];
+    };
+
+    struct DeviceState {
+        const DeviceBuffers* device;
+        Stream streams[recordSensorCount];
+    };
+
+    void workerLoop();
+    void syncDevices();
+    bool process(Stream& stream);
+
+    DeviceRegistry& registry;
+    TaskPool& pool;
+    const std::size_t fftSize;
+    const std::size_t hop;
+    const std::size_t history;
+
+    std::uint64_t registryVersion = 0;
+    mutable std::mutex statesMtx; // Guards the list, not the spectrograms
+    std::vector<std::unique_ptr<DeviceState>> states;
+    std::vector<Stream*> streams; // Every stream of every device, worker thread only
+
+    std::atomic<bool> running{true};
+    std::thread worker;
+};
@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+// Bounded lock-free single-producer / single-consumer queue.
+//
+// Slots are preallocated. The producer fills a slot in place between claim() and
+// publish(), the consumer reads it in place between front() and pop(), so large
+// elements are never copied through the queue.
+template <typename T>
+class SpscQueue {
+public:
+    // Capacity is rounded up to a power of two
+    explicit SpscQueue(std::size_t capacity) : slots(roundUp(capacity)), mask(slots.size() - 1) {}
+
+    // Producer: next free slot, or nullptr if the queue is full
+    T* claim() {
+        const std::uint64_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead >= slots.size()) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead >= slots.size()) {
+                return nullptr;
+            }
+        }
+        return &slots[static_cast<std::size_t>(t & mask)];
+    }
+
+    // Producer: makes the slot returned by claim() visible to the consumer
+    void publish() {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Consumer: oldest element, or nullptr if the queue is empty
+    T* front() {
+        const std::uint64_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) {
+                return nullptr;
+            }
+        }
+        return &slots[static_cast<std::size_t>(h & mask)];
+    }
+
+    // Consumer: releases the slot returned by front()
+    void pop() {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    std::size_t size() const {
+        return static_cast<std::size_t>(tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire));
+    }
+
+    std::size_t capacity() const {
+        return slots.size();
+    }
+
+private:
+    static std::size_t roundUp(std::size_t n) {
+        if (n == 0) {
+            throw std::invalid_argument("Queue capacity must be positive");
+        }
+        std::size_t size = 1;
+        while (size < n) size <<= 1;
+        return size;
+    }
+
+    std::vector<T> slots;
+    const std::size_t mask;
+
+    // Producer and consumer indices on separate cache lines
+    alignas(64) std::atomic<std::uint64_t> tail{0};
+    std::uint64_t cachedHead = 0; // Producer's last view of head
+    alignas(64) std::atomic<std::uint64_t> head{0};
+    std::uint64_t cachedTail = 0; // Consumer's last view of tail
+};
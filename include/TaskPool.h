@@ -0,0 +1,110 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool shared by the processing stages (fusion, spectra and
+// plot preparation).
+//
+// Every worker owns a deque. Tasks submitted by a worker go to the back of its own
+// deque and it takes them from there, newest first while their data is still in
+// cache. Idle workers steal the oldest task from the front of another deque. Tasks
+// submitted from other threads are dealt out round-robin.
+//
+// Stages fan out with parallelFor(), one index per device or sensor stream. Results
+// reach the render thread through the lock-free buffers the stages already write
+// (ring buffers, spectrograms), so nothing here blocks the UI.
+class TaskPool {
+public:
+    using Task = std::function<void()>;
+
+    // 0 threads starts one per core, leaving a core for the thread calling parallelFor()
+    explicit TaskPool(std::size_t threads = 0);
+    // Runs the tasks still queued, then joins the workers
+    ~TaskPool();
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    void submit(Task task);
+
+    // Calls fn(i) for every i in [0, count) on the pool and the calling thread, and
+    // returns once all calls are done. Safe to call from several threads at once and
+    // from inside a task; a waiting caller runs queued tasks instead of blocking.
+    // If a call throws, the indices not yet started are skipped and the first
+    // exception is rethrown here once every helper has finished.
+    template <typename Fn>
+    void parallelFor(std::size_t count, Fn&& fn) {
+        if (count < 2 || workers.empty()) {
+            for (std::size_t i = 0; i < count; ++i) fn(i);
+            return;
+        }
+
+        std::atomic<std::size_t> next{0};
+        std::mutex errorMtx;
+        std::exception_ptr error;
+        auto work = [&]() {
+            try {
+                for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < count;) {
+                    fn(i);
+                }
+            } catch (...) {
+                next.store(count, std::memory_order_relaxed);
+                std::lock_guard<std::mutex> lock(errorMtx);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        };
+
+        // The helpers point into this frame, so wait for every one of them to finish,
+        // not just for the indices to run out, even when a call threw
+        const std::size_t helpers = std::min(count - 1, workers.size());
+        std::atomic<std::size_t> running{helpers};
+        for (std::size_t h = 0; h < helpers; ++h) {
+            submit([&work, &running]() {
+                work();
+                running.fetch_sub(1, std::memory_order_release);
+            });
+        }
+        work();
+        while (running.load(std::memory_order_acquire) != 0) {
+            if (!runOne()) {
+                std::this_thread::yield();
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    std::size_t threadCount() const { return workers.size(); }
+
+private:
+    struct alignas(64) Queue {
+        std::mutex mtx;
+        std::deque<Task> tasks;
+    };
+
+    // Runs one queued task, own deque first, else stolen. False if there was none.
+    bool runOne();
+    bool take(Queue& queue, bool newest, Task& task);
+    void workerLoop(std::size_t index);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<std::size_t> queued{0};
+    std::atomic<std::size_t> nextQueue{0};
+    std::atomic<std::size_t> sleeping{0};
+    std::atomic<bool> stopping{false};
+    std::mutex sleepMtx;
+    std::condition_variable wakeup;
+};
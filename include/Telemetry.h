@@ -0,0 +1,190 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Pipeline instrumentation. Built when IMU_ENABLE_TELEMETRY is defined (CMake option
+// of the same name); otherwise every IMU_TELEMETRY(...) statement disappears and
+// nothing here is compiled into the hot paths.
+//
+//   IMU_TELEMETRY(telemetry().samplesIngested.add(n));
+//   IMU_TELEMETRY(ScopedTimer timer(telemetry().parseTime));
+#if defined(IMU_ENABLE_TELEMETRY)
+#define IMU_TELEMETRY(...) __VA_ARGS__
+#else
+#define IMU_TELEMETRY(...)
+#endif
+
+#if defined(IMU_ENABLE_TELEMETRY)
+
+inline std::int64_t telemetryNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Event counter split over a few cache lines so threads bumping it at the same
+// time don't fight over one line. Each thread sticks to one shard.
+class Counter {
+public:
+    void add(std::uint64_t n = 1) {
+        shards[shardIndex()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    std::uint64_t total() const {
+        std::uint64_t sum = 0;
+        for (const auto& shard : shards) sum += shard.value.load(std::memory_order_relaxed);
+        return sum;
+    }
+
+private:
+    static constexpr std::size_t shardCount = 8;
+
+    struct alignas(64) Shard {
+        std::atomic<std::uint64_t> value{0};
+    };
+
+    static std::size_t shardIndex() {
+        static std::atomic<std::size_t> nextThread{0};
+        thread_local const std::size_t index = nextThread.fetch_add(1, std::memory_order_relaxed) % shardCount;
+        return index;
+    }
+
+    std::array<Shard, shardCount> shards;
+};
+
+// Log-linear histogram of nanosecond durations (HDR style): each power of two is
+// split into 8 linear sub-buckets, so any recorded value is known to within 12.5%
+// with a fixed 4 KiB footprint and a lock-free record().
+class LatencyHistogram {
+public:
+    static constexpr unsigned subBucketBits = 3;
+    static constexpr std::size_t subBuckets = 1u << subBucketBits;
+    static constexpr std::size_t bucketCount = (64 - subBucketBits + 1) * subBuckets;
+
+    void record(std::int64_t ns) {
+        const std::uint64_t v = ns > 0 ? static_cast<std::uint64_t>(ns) : 0;
+        buckets[bucketOf(v)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(v, std::memory_order_relaxed);
+        std::uint64_t seen = max_.load(std::memory_order_relaxed);
+        while (v > seen && !max_.compare_exchange_weak(seen, v, std::memory_order_relaxed)) {}
+    }
+
+    std::uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    std::uint64_t maxNs() const { return max_.load(std::memory_order_relaxed); }
+    double meanNs() const {
+        std::uint64_t n = count();
+        return n ? static_cast<double>(sum_.load(std::memory_order_relaxed)) / n : 0.0;
+    }
+
+    // Upper edge of the bucket holding the p-th percentile (p in [0, 100])
+    std::uint64_t percentileNs(double p) const {
+        const std::uint64_t n = count();
+        if (n == 0) return 0;
+        const std::uint64_t rank = static_cast<std::uint64_t>(p / 100.0 * (n - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < bucketCount; ++i) {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                return std::min(bucketUpperEdge(i), maxNs());
+            }
+        }
+        return maxNs();
+    }
+
+private:
+    static std::size_t bucketOf(std::uint64_t v) {
+        if (v < subBuckets) {
+            return static_cast<std::size_t>(v);
+        }
+        const unsigned exponent = highestBit(v);
+        const std::size_t sub = static_cast<std::size_t>(v >> (exponent - subBucketBits)) & (subBuckets - 1);
+        return (exponent - subBucketBits + 1) * subBuckets + sub;
+    }
+
+    static unsigned highestBit(std::uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63 - static_cast<unsigned>(__builtin_clzll(v));
+#else
+        unsigned bit = 0;
+        while (v >>= 1) ++bit;
+        return bit;
+#endif
+    }
+
+    static std::uint64_t bucketUpperEdge(std::size_t bucket) {
+        if (bucket < subBuckets) {
+            return bucket;
+        }
+        const unsigned exponent = static_cast<unsigned>(bucket / subBuckets) + subBucketBits - 1;
+        const std::uint64_t sub = bucket % subBuckets;
+        const std::uint64_t width = std::uint64_t(1) << (exponent - subBucketBits);
+        return (subBuckets + sub + 1) * width - 1;
+    }
+
+    std::array<std::atomic<std::uint64_t>, bucketCount> buckets{};
+    std::atomic<std::uint64_t> count_{0};
+    std::atomic<std::uint64_t> sum_{0};
+    std::atomic<std::uint64_t> max_{0};
+};
+
+// Records the lifetime of the enclosing scope into a histogram
+class ScopedTimer {
+public:
+    explicit ScopedTimer(LatencyHistogram& histogram) : histogram(histogram), start(telemetryNowNs()) {}
+    ~ScopedTimer() { histogram.record(telemetryNowNs() - start); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    LatencyHistogram& histogram;
+    std::int64_t start;
+};
+
+// Process-wide metrics, see telemetry()
+struct Telemetry {
+    // Ingest
+    Counter framesReceived;
+    Counter bytesReceived;
+    Counter parseErrors;
+    Counter samplesIngested;  // Samples appended to ring buffers, live or replayed
+    Counter samplesOverBudget; // Overload handling, summed over all sessions
+    Counter samplesDropped;
+    Counter samplesDecimated;
+    Counter readPauses;
+    Counter sessionsRefused;   // Connections over the session cap
+    LatencyHistogram parseTime;
+    LatencyHistogram appendTime; // Writer's critical section in the ring buffer
+
+    // Triggers
+    Counter triggersFired;
+    Counter capturesMissed;   // Fired while every capture slot was being filled
+    LatencyHistogram triggerTime; // Checking one batch against the conditions
+
+    // Readers
+    Counter readRetries;      // Seqlock reads that had to be repeated
+
+    // Rendering
+    Counter pointsPlotted;
+    Counter plotsReused;      // Plots drawn from their previous snapshot, nothing new to read
+    Counter idleFrames;       // Frames paced below the full rate
+    Counter vertexBytesUploaded; // Sample data sent to the GPU line traces
+    LatencyHistogram receiveToPlot; // Socket receive until the sample is first drawn
+    LatencyHistogram frameCpu;      // BeginDrawing until the UI is submitted
+    LatencyHistogram frameSwap;     // EndDrawing: buffer swap and frame pacing wait
+    LatencyHistogram frameInterval;
+
+    // Writes every metric as a JSON object
+    void dump(std::ostream& out) const;
+    bool dumpToFile(const std::string& path) const;
+};
+
+Telemetry& telemetry();
+
+#endif
@@ -0,0 +1,36 @@
+#pragma once
+#include "Telemetry.h"
+
+#if defined(IMU_ENABLE_TELEMETRY)
+#include <cstdint>
+
+// Live view of the pipeline counters and latency histograms, toggled with F3
+class TelemetryPanel {
+private:
+    int m_posX;
+    int m_posY;
+    int m_width;
+    int m_height;
+    bool m_open;
+
+    // Rates, recomputed about once per second from counter deltas
+    double m_rate_time;
+    std::uint64_t m_last_samples;
+    std::uint64_t m_last_frames;
+    std::uint64_t m_last_bytes;
+    std::uint64_t m_last_points;
+    float m_samples_rate;
+    float m_frames_rate;
+    float m_bytes_rate;
+    float m_points_rate;
+
+    void UpdateRates();
+    static void HistogramRow(const char* name, const LatencyHistogram& histogram);
+
+public:
+    TelemetryPanel(int posX, int posY, int width, int height);
+
+    void Toggle() { m_open = !m_open; }
+    void Draw();
+};
+#endif
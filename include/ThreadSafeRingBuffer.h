@@ -1,84 +1,375 @@
 #pragma once
-#include <array>
+#include <atomic>
 #include <cstddef>
-#include <mutex>
+#include <cstdint>
+#include <cmath>
 #include <algorithm>
 #include <stdexcept>
 
-template <std::size_t Capacity>
+#include "RingChannel.h"
+#include "MinMaxPyramid.h"
+#include "SimdStats.h"
+#include "Telemetry.h"
+
+// Capacity template argument for buffers sized at runtime
+inline constexpr std::size_t DynamicCapacity = 0;
+
+// Single-producer / single-consumer ring buffer for timestamped x/y/z sample triplets.
+//
+// Every sample is visible at both (i % capacity) and (i % capacity + capacity),
+// so the most recent N samples are always one contiguous span. On Linux the two
+// halves are the same physical pages mapped twice, so an append is a single tail
+// write; elsewhere each sample is stored twice (see RingChannel). The writer never
+// moves data that is already published, it only overwrites the oldest slots.
+//
+// Readers never block the writer. They copy the window they want and then
+// validate it against the writer's claim counter (seqlock style); if the writer
+// lapped the copied slots in the meantime, the copy is retried.
+//
+// A min/max pyramid is updated alongside, so readDecimated() can produce a
+// peak-preserving view of any window in O(buckets) regardless of its length.
+//
+// ThreadSafeRingBuffer<> takes its capacity at construction. If rounding it up to a
+// whole number of pages adds little (see roundedCapacity()), it is rounded so the
+// double mapping can be used; otherwise the exact capacity is kept with plain storage.
+// ThreadSafeRingBuffer<N> fixes it at compile time, which lets the compiler fold the
+// index arithmetic; it only gets the double mapping if N floats fill whole pages.
+template <std::size_t Capacity = DynamicCapacity>
 class ThreadSafeRingBuffer {
 public:
-    ThreadSafeRingBuffer() : head(0), count(0) {}
+    ThreadSafeRingBuffer() : ThreadSafeRingBuffer(Capacity) {
+        static_assert(Capacity != DynamicCapacity, "Runtime sized buffers need a capacity");
+    }
 
-    void append(const float* xData, const float* yData, const float* zData, std::size_t len) {
-        if (len > Capacity) {
+    explicit ThreadSafeRingBuffer(std::size_t capacity)
+        : capacity_(validCapacity(capacity)),
+          tBuffer(capacity_, canMirror(capacity_)), xBuffer(capacity_, canMirror(capacity_)),
+          yBuffer(capacity_, canMirror(capacity_)), zBuffer(capacity_, canMirror(capacity_)),
+          pyramid(capacity_), head(0), pending(0), gapCount(0), missingCount(0)
+    {}
+
+    // Expected sample interval, used for gap detection. 0 disables it.
+    void setNominalRate(double hz) {
+        nominalPeriod = hz > 0.0 ? 1.0 / hz : 0.0;
+    }
+
+    // Producer side. Must only be called from one thread at a time.
+    // Timestamps are in seconds and should be increasing.
+    void append(const double* tData, const float* xData, const float* yData, const float* zData, std::size_t len) {
+        if (len > capacity()) {
             throw std::length_error("Buffer cannot fit data");
         }
-        std::lock_guard<std::mutex> lock(mtx);
+        IMU_TELEMETRY(ScopedTimer timer(telemetry().appendTime));
+        detectGaps(tData, len);
+        const std::uint64_t start = head.load(std::memory_order_relaxed);
+
+        // Announce the slots about to be overwritten before touching them
+        pending.store(start + len, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        const std::size_t pos = static_cast<std::size_t>(start % capacity());
+        tBuffer.write(pos, tData, len);
+        xBuffer.write(pos, xData, len);
+        yBuffer.write(pos, yData, len);
+        zBuffer.write(pos, zData, len);
+        for (std::size_t i = 0; i < len; ++i) {
+            pyramid.push(start + i, xData[i], yData[i], zData[i]);
+        }
 
-        if (head + len <= 2 * Capacity) {
-            std::copy(xData, xData + len, xBuffer.begin() + head);
-            std::copy(yData, yData + len, yBuffer.begin() + head);
-            std::copy(zData, zData + len, zBuffer.begin() + head);
+        head.store(start + len, std::memory_order_release);
+    }
 
-            head += len;
-            count = std::min(count + len, Capacity);
-        } else {
-            std::size_t overflowing_count = head + len - 2 * Capacity;
-            std::size_t elements_to_keep = Capacity - len;
-            std::copy(xBuffer.begin() + (head - elements_to_keep), 
-                      xBuffer.begin() + head, 
-                      xBuffer.begin());
-            std::copy(xData, xData + len, xBuffer.begin() + elements_to_keep);
+    float at(std::size_t index) const {
+        return xBuffer[index % capacity()]; // Change later if needed to include y and z
+    }
 
-            std::copy(yBuffer.begin() + (head - elements_to_keep), 
-                      yBuffer.begin() + head, 
-                      yBuffer.begin());
-            std::copy(yData, yData + len, yBuffer.begin() + elements_to_keep);
+    std::size_t capacity() const {
+        return Capacity != DynamicCapacity ? Capacity : capacity_;
+    }
+
+    // True if appends are a single write thanks to the double mapping
+    bool isDoubleMapped() const {
+        return xBuffer.mirrored();
+    }
 
-            std::copy(zBuffer.begin() + (head - elements_to_keep), 
-                      zBuffer.begin() + head, 
-                      zBuffer.begin());
-            std::copy(zData, zData + len, zBuffer.begin() + elements_to_keep);
-            head = Capacity;
-            count = Capacity;
+    // Memory held by the buffer, including the decimation pyramid
+    std::size_t memoryBytes() const {
+        return tBuffer.bytes() + xBuffer.bytes() + yBuffer.bytes() + zBuffer.bytes() + pyramid.memoryBytes();
+    }
+
+    // Capacity a buffer constructed for 'requested' samples ends up with
+    static std::size_t roundedCapacity(std::size_t requested) {
+        if (Capacity != DynamicCapacity) {
+            return Capacity;
         }
+        const std::size_t granularity = mirrorGranularity();
+        const std::size_t rounded = (requested + granularity - 1) / granularity * granularity;
+        return rounded - requested <= requested / maxPaddingFraction ? rounded : requested;
     }
 
-    const float& at(std::size_t index) const {
-        std::lock_guard<std::mutex> lock(mtx);
-        return xBuffer[index % Capacity]; // Change later if needed to include y and z
+    // Memory a buffer for 'requested' samples holds, assuming the double mapping succeeds
+    static std::size_t memoryBytesFor(std::size_t requested) {
+        const std::size_t capacity = roundedCapacity(requested);
+        const std::size_t copies = canMirror(capacity) ? 1 : 2;
+        return copies * capacity * (sizeof(double) + 3 * sizeof(float)) + MinMaxPyramid::memoryBytesFor(capacity);
     }
 
     std::size_t size() const {
-        std::lock_guard<std::mutex> lock(mtx);
-        return count;
+        return static_cast<std::size_t>(std::min<std::uint64_t>(head.load(std::memory_order_acquire), capacity()));
     }
 
-    void getRecentPointers(std::size_t N, const float** x, const float** y, const float** z) const 
-    {
-        if (N > Capacity) {
+    // Total number of samples ever appended. Doubles as a generation counter: readers
+    // that see the same value again would read exactly the same data.
+    std::uint64_t written() const {
+        return head.load(std::memory_order_acquire);
+    }
+
+    // Number of intervals longer than 1.5 nominal periods, and the samples estimated missing in them
+    std::uint64_t gaps() const { return gapCount.load(std::memory_order_relaxed); }
+    std::uint64_t missingSamples() const { return missingCount.load(std::memory_order_relaxed); }
+
+    // Copies the N most recent samples into t/x/y/z (oldest first). Returns false
+    // if fewer than N samples have been written so far.
+    bool readRecent(std::size_t N, double* t, float* x, float* y, float* z) const {
+        if (N > capacity()) {
             throw std::out_of_range("Requested more than buffer capacity");
         }
 
-        std::lock_guard<std::mutex> lock(mtx);
-        if (count < N) {
-            *x = nullptr;
-            *y = nullptr;
-            *z = nullptr;
-            return; 
+        while (true) {
+            const std::uint64_t end = head.load(std::memory_order_acquire);
+            if (end < N) {
+                return false;
+            }
+            const std::uint64_t begin = end - N;
+            const std::size_t offset = static_cast<std::size_t>(end % capacity()) + capacity() - N;
+
+            std::copy(tBuffer.data() + offset, tBuffer.data() + offset + N, t);
+            std::copy(xBuffer.data() + offset, xBuffer.data() + offset + N, x);
+            std::copy(yBuffer.data() + offset, yBuffer.data() + offset + N, y);
+            std::copy(zBuffer.data() + offset, zBuffer.data() + offset + N, z);
+
+            if (isIntact(begin)) {
+                return true;
+            }
+            IMU_TELEMETRY(telemetry().readRetries.add());
         }
+    }
 
-        *x = xBuffer.data() + (head - N);
-        *y = yBuffer.data() + (head - N);
-        *z = zBuffer.data() + (head - N);
+    // Copies up to 'maxCount' samples starting at absolute index 'cursor' (oldest first)
+    // and moves the cursor past them, for consumers that process every sample once.
+    // A cursor the writer has already lapped skips ahead to the oldest retained sample.
+    // Returns the number of samples copied, 0 if nothing new has arrived.
+    std::size_t readSince(std::uint64_t& cursor, std::size_t maxCount,
+                          double* t, float* x, float* y, float* z) const {
+        while (true) {
+            const std::uint64_t end = head.load(std::memory_order_acquire);
+            const std::uint64_t begin = std::max<std::uint64_t>(cursor, end > capacity() ? end - capacity() : 0);
+            const std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(end - begin, maxCount));
+            const std::size_t offset = static_cast<std::size_t>(begin % capacity());
+
+            std::copy(tBuffer.data() + offset, tBuffer.data() + offset + n, t);
+            std::copy(xBuffer.data() + offset, xBuffer.data() + offset + n, x);
+            std::copy(yBuffer.data() + offset, yBuffer.data() + offset + n, y);
+            std::copy(zBuffer.data() + offset, zBuffer.data() + offset + n, z);
+
+            if (isIntact(begin)) {
+                cursor = begin + n;
+                return n;
+            }
+            IMU_TELEMETRY(telemetry().readRetries.add());
+        }
+    }
+
+    // Upper bound of the points readDecimated() returns for 'buckets'
+    std::size_t maxDecimatedPoints(std::size_t buckets) const {
+        // Two points per bucket plus up to 3 partial blocks per level at either end
+        return 2 * (buckets + 6 * pyramid.levelCount()) + 2;
+    }
+
+    // Min/max decimated copy of the N most recent samples into t/x/y/z.
+    // Windows of at most 'buckets' samples are copied as is. Longer windows are
+    // covered by aligned pyramid blocks of about N / buckets samples; every block
+    // contributes its minimum at the block's first timestamp and its maximum at its
+    // last, so spikes survive. Output arrays need maxDecimatedPoints(buckets) entries.
+    // Returns the number of points written, 0 if fewer than N samples exist.
+    std::size_t readDecimated(std::size_t N, std::size_t buckets, double* t, float* x, float* y, float* z) const {
+        if (N > capacity()) {
+            throw std::out_of_range("Requested more than buffer capacity");
+        }
+
+        while (true) {
+            const std::uint64_t end = head.load(std::memory_order_acquire);
+            if (end < N) {
+                return 0;
+            }
+            const std::uint64_t begin = end - N;
+            std::size_t count = decimate(begin, end, buckets, t, x, y, z);
+            if (isIntact(begin)) {
+                return count;
+            }
+            IMU_TELEMETRY(telemetry().readRetries.add());
+        }
+    }
+
+    // Same as readDecimated(), for the samples no older than 'span' seconds before the
+    // newest one, plus one older sample so the line reaches the edge of the window.
+    // The window start is found by binary search on the time channel.
+    std::size_t readDecimatedSpan(double span, std::size_t buckets, double* t, float* x, float* y, float* z) const {
+        while (true) {
+            const std::uint64_t end = head.load(std::memory_order_acquire);
+            const std::size_t available = static_cast<std::size_t>(std::min<std::uint64_t>(end, capacity()));
+            if (available == 0) {
+                return 0;
+            }
+
+            // The available samples are contiguous in the mirrored time channel
+            const double* oldest = tBuffer.data() + static_cast<std::size_t>(end % capacity()) + capacity() - available;
+            const double* newest = oldest + available - 1;
+            const double* first = std::lower_bound(oldest, newest, *newest - span);
+            if (first > oldest) {
+                --first;
+            }
+
+            // Only the slots actually read need to be intact. The writer overwrites the oldest
+            // slots first, so a search misled by them lands near the oldest edge and is caught here.
+            const std::uint64_t begin = end - static_cast<std::uint64_t>(newest + 1 - first);
+            std::size_t count = decimate(begin, end, buckets, t, x, y, z);
+            if (isIntact(begin)) {
+                return count;
+            }
+            IMU_TELEMETRY(telemetry().readRetries.add());
+        }
+    }
+
+    // Per-axis min/max/mean/RMS of the samples no older than 'span' seconds before the
+    // newest one. The window is contiguous in the mirrored channels, so the SIMD kernels
+    // run straight over buffer memory without a copy. Returns false if the buffer is empty.
+    bool readStatsSpan(double span, AxisStats& x, AxisStats& y, AxisStats& z) const {
+        while (true) {
+            const std::uint64_t end = head.load(std::memory_order_acquire);
+            const std::size_t available = static_cast<std::size_t>(std::min<std::uint64_t>(end, capacity()));
+            if (available == 0) {
+                return false;
+            }
+
+            const std::size_t oldest = static_cast<std::size_t>(end % capacity()) + capacity() - available;
+            const double* times = tBuffer.data() + oldest;
+            const std::size_t first = static_cast<std::size_t>(
+                std::lower_bound(times, times + available - 1, times[available - 1] - span) - times);
+            const std::size_t n = available - first;
+
+            x = computeAxisStats(xBuffer.data() + oldest + first, n);
+            y = computeAxisStats(yBuffer.data() + oldest + first, n);
+            z = computeAxisStats(zBuffer.data() + oldest + first, n);
+            if (isIntact(end - n)) {
+                return true;
+            }
+            IMU_TELEMETRY(telemetry().readRetries.add());
+        }
     }
 
 private:
-    mutable std::mutex mtx;
-    std::array<float, 2 * Capacity> xBuffer{};
-    std::array<float, 2 * Capacity> yBuffer{};
-    std::array<float, 2 * Capacity> zBuffer{};
-    std::size_t head;
-    std::size_t count;
-};
\ No newline at end of file
+    // Capacities are padded to whole pages by at most 1/maxPaddingFraction of the request
+    static constexpr std::size_t maxPaddingFraction = 8;
+
+    // Samples per page worth of floats; capacities that are a multiple of this can be double mapped
+    static std::size_t mirrorGranularity() {
+        return RingChannel<float>::pageSize() / sizeof(float);
+    }
+
+    static bool canMirror(std::size_t capacity) {
+        return capacity % mirrorGranularity() == 0;
+    }
+
+    static std::size_t validCapacity(std::size_t capacity) {
+        if (capacity == 0 || (Capacity != DynamicCapacity && capacity != Capacity)) {
+            throw std::invalid_argument("Invalid buffer capacity");
+        }
+        return roundedCapacity(capacity);
+    }
+
+    // Writes the decimated samples [begin, end) to t/x/y/z, returns the number of points.
+    // The caller validates the result with isIntact(begin).
+    std::size_t decimate(std::uint64_t begin, std::uint64_t end, std::size_t buckets,
+                         double* t, float* x, float* y, float* z) const {
+        if (buckets == 0) {
+            return 0;
+        }
+
+        // Finest level that needs no more than 'buckets' blocks for the window
+        const std::uint64_t length = end - begin;
+        unsigned level = 0;
+        while (level < pyramid.levelCount() && (length >> (MinMaxPyramid::fanoutBits * level)) > buckets) {
+            ++level;
+        }
+
+        std::size_t count = 0;
+        std::uint64_t k = begin;
+        while (k < end) {
+            unsigned l = level;
+            while (l > 0 && ((k & (MinMaxPyramid::blockSize(l) - 1)) != 0 || k + MinMaxPyramid::blockSize(l) > end)) {
+                --l;
+            }
+
+            if (l == 0) {
+                const std::size_t pos = static_cast<std::size_t>(k % capacity());
+                t[count] = tBuffer[pos];
+                x[count] = xBuffer[pos];
+                y[count] = yBuffer[pos];
+                z[count] = zBuffer[pos];
+                ++count;
+                ++k;
+                continue;
+            }
+
+            const std::uint64_t size = MinMaxPyramid::blockSize(l);
+            const BlockSummary& summary = pyramid.block(l, k >> (MinMaxPyramid::fanoutBits * l));
+            t[count] = tBuffer[static_cast<std::size_t>(k % capacity())];
+            t[count + 1] = tBuffer[static_cast<std::size_t>((k + size - 1) % capacity())];
+            x[count] = summary.min[0]; x[count + 1] = summary.max[0];
+            y[count] = summary.min[1]; y[count + 1] = summary.max[1];
+            z[count] = summary.min[2]; z[count + 1] = summary.max[2];
+            count += 2;
+            k += size;
+        }
+        return count;
+    }
+
+    void detectGaps(const double* tData, std::size_t len) {
+        if (nominalPeriod <= 0.0 || len == 0) {
+            return;
+        }
+        double previous = head.load(std::memory_order_relaxed) > 0 ? lastTime : tData[0];
+        for (std::size_t i = 0; i < len; ++i) {
+            double interval = tData[i] - previous;
+            if (interval > 1.5 * nominalPeriod) {
+                gapCount.fetch_add(1, std::memory_order_relaxed);
+                missingCount.fetch_add(static_cast<std::uint64_t>(std::llround(interval / nominalPeriod)) - 1,
+                                       std::memory_order_relaxed);
+            }
+            previous = tData[i];
+        }
+        lastTime = previous;
+    }
+
+    // True if no sample at or after index 'begin' was overwritten while it was being read.
+    bool isIntact(std::uint64_t begin) const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return pending.load(std::memory_order_relaxed) <= begin + capacity();
+    }
+
+    std::size_t capacity_;
+    RingChannel<double> tBuffer;
+    RingChannel<float> xBuffer;
+    RingChannel<float> yBuffer;
+    RingChannel<float> zBuffer;
+    MinMaxPyramid pyramid;
+    std::atomic<std::uint64_t> head;    // Samples published to readers
+    std::atomic<std::uint64_t> pending; // Samples claimed by the writer
+
+    // Gap detection, written by the producer only
+    double nominalPeriod = 0.0;
+    double lastTime = 0.0;
+    std::atomic<std::uint64_t> gapCount;
+    std::atomic<std::uint64_t> missingCount;
+};
@@ -0,0 +1,164 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "AppConfig.h"
+#include "Config.h"
+#include "DeviceRegistry.h"
+#include "ImuMessage.h"
+#include "RecordingFormat.h"
+#include "TriggerKernels.h"
+
+// One condition watched on every device
+struct TriggerCondition {
+    RecordSensor sensor = RecordSensor::Accel;
+    TriggerKind kind = TriggerKind::Magnitude;
+    int axis = 0;            // 0-2, not used by Magnitude
+    float threshold = 20.0f;
+    bool enabled = true;
+};
+
+// Triggered capture over the live stream.
+//
+// Every ingest path passes its samples through a Stream right after appending them:
+// the WebSocket sessions, the load generator's direct mode and replays. The
+// conditions are checked with the vectorized kernels of TriggerKernels.h and a firing
+// condition claims a slot from a fixed pool. Once the post-trigger time has passed,
+// the slot is filled with the pre- and post-trigger window of all three sensors,
+// copied out of the device's ring buffers. All storage is allocated up front, so the
+// ingest path never allocates; when the pool is full the oldest capture is reused.
+//
+// A condition doesn't fire again until its previous capture is complete. The UI reads
+// the slots with a seqlock like the ring buffers, see events() and readCapture().
+class TriggerEngine {
+public:
+    // Samples of one sensor in a capture
+    struct Window {
+        std::vector<double> t;
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> z;
+        std::size_t count = 0;
+    };
+
+    // A finished capture, without its samples
+    struct Event {
+        std::size_t slot = 0;
+        std::uint64_t sequence = 0; // Events are numbered from 1 in firing order
+        const DeviceBuffers* device = nullptr;
+        TriggerCondition condition;
+        double time = 0.0;  // Sample time that fired
+        float value = 0.0f; // Axis value or magnitude at that time
+    };
+
+    struct Capture {
+        Event event;
+        Window sensors[recordSensorCount];
+    };
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> version{0}; // Odd while claimed and being filled
+        std::atomic<bool> busy{false};         // Claimed by a stream
+        Event event;
+        Window sensors[recordSensorCount];
+    };
+
+public:
+    // Trigger state of one device connection. Not thread safe; one per session.
+    class Stream {
+    public:
+        Stream(TriggerEngine& engine, DeviceBuffers& device);
+        // Fills whatever captures are still waiting with the samples received so far
+        ~Stream();
+
+        Stream(const Stream&) = delete;
+        Stream& operator=(const Stream&) = delete;
+
+        // Checks a batch that was just appended to the device's buffers
+        void process(const ImuBatch& batch);
+        // Same for samples of one sensor, for sources that append the sensors separately.
+        // Call completeCaptures() once all sensors are appended up to the same time.
+        void process(RecordSensor sensor, const double* t, const float* x, const float* y, const float* z,
+                     std::size_t n);
+        // Fills the captures whose post-trigger time has passed, process(batch) does it itself
+        void completeCaptures();
+
+    private:
+        struct ConditionState {
+            bool holds = false; // Condition held on the newest sample checked
+            double holdUntil = -std::numeric_limits<double>::infinity(); // No new trigger before this
+        };
+
+        struct Pending {
+            Slot* slot;
+            RecordSensor sensor;
+            double until; // Time of 'sensor' that completes the capture
+        };
+
+        void syncConditions();
+        void scan(RecordSensor sensor, const double* t, const float* x, const float* y, const float* z,
+                  std::size_t n);
+        void check(std::size_t index, const double* t, const float* x, const float* y, const float* z,
+                   std::size_t n);
+        void fire(std::size_t index, double time, float value);
+
+        TriggerEngine& engine;
+        DeviceBuffers& device;
+        std::uint64_t conditionsVersion = 0;
+        std::array<TriggerCondition, maxTriggerConditions> conditions;
+        std::array<ConditionState, maxTriggerConditions> states;
+        std::size_t conditionCount = 0;
+        std::array<Pending, maxTriggerConditions> pending;
+        std::size_t pendingCount = 0;
+        double newest[recordSensorCount] = {0.0, 0.0, 0.0};
+    };
+
+    TriggerEngine(const AppConfig& config, std::size_t slots);
+
+    TriggerEngine(const TriggerEngine&) = delete;
+    TriggerEngine& operator=(const TriggerEngine&) = delete;
+
+    std::shared_ptr<Stream> openStream(DeviceBuffers& device);
+
+    // Replaces the conditions, at most maxTriggerConditions are used. Streams pick
+    // the change up with their next batch.
+    void setConditions(const std::vector<TriggerCondition>& conditions);
+    std::vector<TriggerCondition> conditions() const;
+
+    // Finished captures, newest first
+    void events(std::vector<Event>& out) const;
+    // Sizes 'out' for the largest capture, so readCapture() into it never allocates
+    void prepareCapture(Capture& out) const;
+    // Copies a capture listed by events() into the buffers of 'out', which only grow.
+    // Returns false if its slot has been reused since.
+    bool readCapture(const Event& event, Capture& out) const;
+
+    double preSeconds() const { return pre; }
+    double postSeconds() const { return post; }
+    std::uint64_t fired() const { return sequence.load(std::memory_order_relaxed); }
+    // Triggers lost because every slot was still being filled
+    std::uint64_t missed() const { return missedCount.load(std::memory_order_relaxed); }
+
+private:
+    Slot* claim();
+    void fill(Slot& slot, const DeviceBuffers& device);
+    bool readEvent(const Slot& slot, Event& out) const;
+
+    double pre;
+    double post;
+    std::vector<std::unique_ptr<Slot>> pool;
+    std::atomic<std::uint64_t> nextSlot{0};
+    std::atomic<std::uint64_t> sequence{0};
+    std::atomic<std::uint64_t> missedCount{0};
+
+    mutable std::mutex conditionsMtx;
+    std::vector<TriggerCondition> conditionList;
+    std::atomic<std::uint64_t> conditionsVersion{1};
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Conditions a trigger watches for. Each fires where it starts to hold, i.e. on a
+// sample where it holds while it didn't hold on the sample before.
+//
+//   Threshold  |v| >= threshold on one axis, shocks in either direction
+//   Rising     v >= threshold, so v crossing the threshold upwards
+//   Falling    v <= threshold, so v crossing the threshold downwards
+//   Magnitude  |(x, y, z)| >= threshold
+enum class TriggerKind {
+    Threshold,
+    Rising,
+    Falling,
+    Magnitude
+};
+
+const char* triggerKindName(TriggerKind kind);
+
+// True if the condition holds for one sample. Single-axis kinds only look at 'x'.
+bool triggerHolds(TriggerKind kind, float x, float y, float z, float threshold);
+
+// Index of the first sample in [0, n) where the condition starts to hold, n if there
+// is none. 'previous' says whether it held for the sample before x[0]. Single-axis
+// kinds only read 'x'; y and z may be null for them. Vectorized like SimdStats.
+std::size_t findTriggerEdge(TriggerKind kind, const float* x, const float* y, const float* z,
+                            std::size_t n, float threshold, bool previous);
+
+// Name of the kernel findTriggerEdge() uses on this machine, for logs
+const char* triggerKernel();
+
+// One implementation of findTriggerEdge(), a function per TriggerKind
+struct TriggerEdgeKernel {
+    const char* name;
+    std::size_t (*find[4])(const float* x, const float* y, const float* z, std::size_t n, float threshold,
+                           bool previous); // Indexed by TriggerKind
+};
+
+// Every kernel this machine can run, scalar first, for tests and benchmarks
+std::vector<TriggerEdgeKernel> triggerEdgeKernels();
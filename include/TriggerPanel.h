@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "TriggerEngine.h"
+
+// Trigger conditions and the list of captured events, toggled with F6.
+//
+// Picking an event copies its capture out of the engine's pool once and plots the
+// frozen window around the trigger, so it stays viewable after it left the ring buffers.
+class TriggerPanel {
+private:
+    int m_posX;
+    int m_posY;
+    int m_width;
+    int m_height;
+    bool m_open;
+
+    TriggerEngine& m_engine;
+    std::vector<TriggerCondition> m_conditions; // Edited here, pushed to the engine on change
+    std::vector<TriggerEngine::Event> m_events;
+
+    std::uint64_t m_selected;     // Sequence of the plotted event, 0 for none
+    bool m_has_capture;
+    TriggerEngine::Capture m_capture;
+    int m_plot_sensor;
+    std::vector<float> m_times;   // Capture times relative to the trigger
+
+    bool DrawConditions();
+    void DrawEvents();
+    void DrawCapture();
+    void Select(const TriggerEngine::Event& event);
+
+public:
+    TriggerPanel(int posX, int posY, int width, int height, TriggerEngine& engine_ref);
+
+    void Toggle() { m_open = !m_open; }
+    void Draw();
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include <boost/beast.hpp>
+#include <boost/asio.hpp>
+#include <atomic>
+#include <memory>
+
+#include "DeviceRegistry.h"
+#include "Recorder.h"
+#include "TriggerEngine.h"
+
+namespace beast = boost::beast;
+namespace net = boost::asio;
+using tcp = boost::asio::ip::tcp;
+
+// Accepts WebSocket connections and spawns an independent WebSocketSession for each.
+// Every session runs on its own strand, so the io_context can be run by a thread pool.
+// Connections beyond AppConfig::maxSessions are closed right after accepting them.
+class WebSocketServer {
+public:
+    // 'recorder' may be null when recording is disabled, 'triggers' when triggering is
+    WebSocketServer(net::io_context& ioc, unsigned short port, DeviceRegistry& registry, Recorder* recorder,
+                    TriggerEngine* triggers);
+
+    void run();
+
+    // Port actually listened on, useful when constructed with port 0
+    unsigned short port() const { return acceptor_.local_endpoint().port(); }
+
+private:
+    net::io_context& ioc_;
+    tcp::acceptor acceptor_;
+    DeviceRegistry& registry_;
+    Recorder* recorder_;
+    TriggerEngine* triggers_;
+    // Shared with the sessions, which may outlive the server while the io_context winds down
+    std::shared_ptr<std::atomic<int>> sessionCount_;
+    net::steady_timer retryTimer_; // Backs off after a failed accept
+};
@@ -1,30 +1,61 @@
 #pragma once
 #include <boost/beast.hpp>
 #include <boost/asio.hpp>
+#include <atomic>
+#include <memory>
+#include <string>
 
 #include "Config.h"
+#include "DeviceRegistry.h"
+#include "ImuMessage.h"
+#include "OverloadPolicy.h"
+#include "Recorder.h"
+#include "TriggerEngine.h"
 
 namespace beast = boost::beast;
 namespace net = boost::asio;
+namespace http = beast::http;
 using tcp = boost::asio::ip::tcp;
 
-class WebSocketSession {
+// One connected device. The device ID is taken from the request path
+// (ws://host:port/<device-id>); connections without a path get a generated ID.
+// Samples beyond the session's ingest budget are handled by the configured
+// OverloadPolicy. Appended batches are checked by the TriggerEngine if there is one.
+class WebSocketSession : public std::enable_shared_from_this<WebSocketSession> {
 public:
-    WebSocketSession(net::io_context& ioc, unsigned short port, GyroBuffer& gyrobuffer, 
-                     AccelBuffer& accelBuffer, MagBuffer& magBuffer);
-    
+    // 'sessionCount' tracks the open sessions for the server's cap
+    WebSocketSession(tcp::socket&& socket, DeviceRegistry& registry, Recorder* recorder,
+                     TriggerEngine* triggers, std::shared_ptr<std::atomic<int>> sessionCount);
+    ~WebSocketSession();
+
     void run();
     
 private:
-    void handleConnection(tcp::socket socket);
+    void onRequest(beast::error_code ec);
+    void onAccept(beast::error_code ec);
     void readLoop();
+    void scheduleRead();
     void processMessage(size_t bytes);
+    bool applyOverloadPolicy();
 
-    tcp::acceptor acceptor_;
-    std::optional<beast::websocket::stream<tcp::socket>> ws_;
+    template <typename Buffer>
+    bool appendSamples(Buffer& buffer, RecordSensor sensor, SensorSamples& samples);
+
+    beast::websocket::stream<beast::tcp_stream> ws_;
     beast::flat_buffer buffer_;
+    http::request<http::string_body> request_;
+    ImuBatch batch_; // Reused parse target, avoids per-message allocations
+
+    DeviceRegistry& registry_;
+    DeviceBuffers* device_ = nullptr;
+    Recorder* recorder_;
+    std::shared_ptr<Recorder::Stream> recording_;
+    TriggerEngine* triggers_;
+    std::shared_ptr<TriggerEngine::Stream> triggerStream_;
 
-    GyroBuffer& gyroBuffer_;
-    AccelBuffer& accelBuffer_;
-    MagBuffer& magBuffer_;
-};
\ No newline at end of file
+    std::shared_ptr<std::atomic<int>> sessionCount_;
+    const OverloadPolicy policy_;
+    TokenBucket budget_;
+    net::steady_timer pauseTimer_; // Holds back the next read under the pause policy
+    bool oversizeLogged_ = false;
+};
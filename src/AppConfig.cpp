@@ -0,0 +1,154 @@
+#include "AppConfig.h"
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace {
+
+std::string trim(const std::string& s) {
+    const char* space = " \t\r\n";
+    std::size_t begin = s.find_first_not_of(space);
+    if (begin == std::string::npos) return "";
+    return s.substr(begin, s.find_last_not_of(space) - begin + 1);
+}
+
+int parseInt(const std::string& key, const std::string& value, int min, int max) {
+    std::size_t used = 0;
+    int result = 0;
+    try {
+        result = std::stoi(value, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (used != value.size() || result < min || result > max) {
+        throw std::invalid_argument("Invalid value for " + key + ": '" + value + "'");
+    }
+    return result;
+}
+
+double parseDouble(const std::string& key, const std::string& value, double min, double max) {
+    std::size_t used = 0;
+    double result = 0.0;
+    try {
+        result = std::stod(value, &used);
+    } catch (const std::exception&) {
+        used = 0;
+    }
+    if (used != value.size() || !(result >= min && result <= max)) {
+        throw std::invalid_argument("Invalid value for " + key + ": '" + value + "'");
+    }
+    return result;
+}
+
+void applySetting(AppConfig& config, const std::string& key, const std::string& value) {
+    if (key == "gyro-hz") config.gyroFreq = parseInt(key, value, 1, 1000000);
+    else if (key == "accel-hz") config.accelFreq = parseInt(key, value, 1, 1000000);
+    else if (key == "mag-hz") config.magFreq = parseInt(key, value, 1, 1000000);
+    else if (key == "buffer-seconds") config.bufferSeconds = parseInt(key, value, 1, 24 * 3600);
+    else if (key == "history-seconds") config.historySeconds = parseInt(key, value, 0, 7 * 24 * 3600);
+    else if (key == "port") config.port = static_cast<unsigned short>(parseInt(key, value, 1, 65535));
+    else if (key == "io-threads") config.ioThreads = parseInt(key, value, 1, 256);
+    else if (key == "worker-threads") config.workerThreads = parseInt(key, value, 0, 256);
+    else if (key == "record") config.recordPath = value;
+    else if (key == "replay") config.replayPath = value;
+    else if (key == "fusion-beta") config.fusionBeta = static_cast<float>(parseDouble(key, value, 0.0, 10.0));
+    else if (key == "telemetry-file") config.telemetryPath = value;
+    else if (key == "replay-speed") config.replaySpeed = parseDouble(key, value, 0.0, 1000.0);
+    else if (key == "max-sessions") config.maxSessions = parseInt(key, value, 1, 65535);
+    else if (key == "max-devices") config.maxDevices = parseInt(key, value, 1, 65535);
+    else if (key == "overload-policy") config.overloadPolicy = parseOverloadPolicy(value);
+    else if (key == "max-ingest-rate") config.maxIngestRate = parseDouble(key, value, 0.0, 1e9);
+    else if (key == "trigger-pre") config.triggerPreSeconds = parseDouble(key, value, 0.0, 3600.0);
+    else if (key == "trigger-post") config.triggerPostSeconds = parseDouble(key, value, 0.0, 3600.0);
+    else if (key == "load-devices") config.loadDevices = parseInt(key, value, 0, 1024);
+    else if (key == "load-batch") config.loadBatch = parseInt(key, value, 1, 10000);
+    else if (key == "load-jitter") config.loadJitter = parseDouble(key, value, 0.0, 10.0);
+    else if (key == "load-dropout") config.loadDropout = parseDouble(key, value, 0.0, 1.0);
+    else if (key == "load-signal") config.loadSignal = parseLoadSignal(value);
+    else if (key == "load-target") config.loadTarget = parseLoadTarget(value);
+    else throw std::invalid_argument("Unknown setting '" + key + "'");
+}
+
+void loadConfigFile(AppConfig& config, const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::invalid_argument("Cannot open config file '" + path + "'");
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+        std::size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            throw std::invalid_argument("Expected 'key = value' in config file: '" + line + "'");
+        }
+        applySetting(config, trim(line.substr(0, eq)), trim(line.substr(eq + 1)));
+    }
+}
+
+} // namespace
+
+AppConfig loadConfig(int argc, char** argv) {
+    AppConfig config;
+
+    // Split "--key=value" and "--key value" arguments
+    std::string configPath;
+    std::vector<std::pair<std::string, std::string>> overrides;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--", 0) != 0) {
+            throw std::invalid_argument("Unexpected argument '" + arg + "'");
+        }
+        arg = arg.substr(2);
+        std::string key = arg, value;
+        std::size_t eq = arg.find('=');
+        if (eq != std::string::npos) {
+            key = arg.substr(0, eq);
+            value = arg.substr(eq + 1);
+        } else if (i + 1 < argc) {
+            value = argv[++i];
+        } else {
+            throw std::invalid_argument("Missing value for --" + key);
+        }
+
+        if (key == "config") {
+            configPath = value;
+        } else {
+            overrides.emplace_back(key, value);
+        }
+    }
+
+    // The config file is the base, command line arguments override it
+    if (!configPath.empty()) {
+        loadConfigFile(config, configPath);
+    }
+    for (auto& [key, value] : overrides) {
+        applySetting(config, key, value);
+    }
+
+    // Each setting is bounded on its own, their product has to be as well
+    if (config.deviceBufferSamples() > maxDeviceBufferSamples) {
+        throw std::invalid_argument("Buffers would hold " + std::to_string(config.deviceBufferSamples()) +
+                                    " samples per device, more than " + std::to_string(maxDeviceBufferSamples) +
+                                    "; lower the sensor rates or buffer-seconds");
+    }
+    if (config.replayPath.empty() && config.loadDevices > config.maxDevices) {
+        throw std::invalid_argument("load-devices is " + std::to_string(config.loadDevices) + ", more than max-devices (" +
+                                    std::to_string(config.maxDevices) + ")");
+    }
+    return config;
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--config <file>] [--gyro-hz N] [--accel-hz N] [--mag-hz N]"
+              << " [--buffer-seconds N] [--history-seconds N] [--port N] [--io-threads N] [--worker-threads N]"
+              << " [--record <file>] [--replay <file>] [--replay-speed X]"
+              << " [--telemetry-file <file>] [--fusion-beta X] [--max-sessions N] [--max-devices N]"
+              << " [--overload-policy drop-oldest|drop-newest|decimate|pause] [--max-ingest-rate X]"
+              << " [--trigger-pre X] [--trigger-post X] [--load-devices N] [--load-batch N] [--load-jitter X]"
+              << " [--load-dropout X] [--load-signal sine|square|chirp|noise] [--load-target direct|socket]"
+              << std::endl;
+}
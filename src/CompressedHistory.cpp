@@ -0,0 +1,445 @@
+#include "CompressedHistory.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+#include "RecordingFormat.h"
+
+namespace {
+
+constexpr std::uint32_t quantMax = (1u << CompressedHistory::quantBits) - 1;
+
+inline std::uint64_t lowBits(unsigned n) {
+    return n >= 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << n) - 1;
+}
+
+// Most significant bit first, into whole 64-bit words
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<std::uint64_t>& words) : words(words) { words.clear(); }
+
+    void put(std::uint64_t value, unsigned bits) {
+        while (bits > 0) {
+            if (used == 64) {
+                words.push_back(0);
+                used = 0;
+            }
+            const unsigned take = std::min(bits, 64 - used);
+            const std::uint64_t chunk = (value >> (bits - take)) & lowBits(take);
+            words.back() |= chunk << (64 - used - take);
+            used += take;
+            bits -= take;
+        }
+    }
+
+private:
+    std::vector<std::uint64_t>& words;
+    unsigned used = 64; // Bits taken in the last word
+};
+
+class BitReader {
+public:
+    explicit BitReader(const std::vector<std::uint64_t>& words) : words(words) {}
+
+    // Next 64 bits without consuming them, zero past the end
+    std::uint64_t peek() const {
+        const std::size_t index = pos / 64;
+        const unsigned offset = static_cast<unsigned>(pos % 64);
+        const std::uint64_t high = index < words.size() ? words[index] << offset : 0;
+        const std::uint64_t low = offset > 0 && index + 1 < words.size() ? words[index + 1] >> (64 - offset) : 0;
+        return high | low;
+    }
+
+    void skip(unsigned bits) { pos += bits; }
+
+    std::uint64_t get(unsigned bits) {
+        std::uint64_t value = 0;
+        while (bits > 0) {
+            const unsigned offset = static_cast<unsigned>(pos % 64);
+            const unsigned take = std::min(bits, 64 - offset);
+            const std::uint64_t chunk = (words[pos / 64] >> (64 - offset - take)) & lowBits(take);
+            value = take == 64 ? chunk : (value << take) | chunk;
+            pos += take;
+            bits -= take;
+        }
+        return value;
+    }
+
+private:
+    const std::vector<std::uint64_t>& words;
+    std::size_t pos = 0;
+};
+
+// Time delta-of-deltas in microseconds: '0' for none, else a prefix picking the width
+void putTime(BitWriter& out, std::int64_t dd) {
+    const std::uint64_t u = zigzagEncode(dd);
+    if (u == 0) {
+        out.put(0, 1);
+    } else if (u < (1u << 7)) {
+        out.put(0b10, 2);
+        out.put(u, 7);
+    } else if (u < (1u << 12)) {
+        out.put(0b110, 3);
+        out.put(u, 12);
+    } else if (u < (1u << 20)) {
+        out.put(0b1110, 4);
+        out.put(u, 20);
+    } else {
+        out.put(0b1111, 4);
+        out.put(u, 64);
+    }
+}
+
+std::int64_t getTime(BitReader& in) {
+    if (!in.get(1)) return 0;
+    if (!in.get(1)) return zigzagDecode(in.get(7));
+    if (!in.get(1)) return zigzagDecode(in.get(12));
+    if (!in.get(1)) return zigzagDecode(in.get(20));
+    return zigzagDecode(in.get(64));
+}
+
+// Deltas (or delta-of-deltas) of quantized values, at most quantBits + 2 bits after zigzag
+constexpr unsigned wideValueBits = CompressedHistory::quantBits + 2;
+
+unsigned valueBits(std::int64_t delta) {
+    const std::uint64_t u = zigzagEncode(delta);
+    if (u == 0) return 1;
+    if (u < (1u << 4)) return 2 + 4;
+    if (u < (1u << 8)) return 3 + 8;
+    return 3 + wideValueBits;
+}
+
+void putValue(BitWriter& out, std::int64_t delta) {
+    const std::uint64_t u = zigzagEncode(delta);
+    if (u == 0) {
+        out.put(0, 1);
+    } else if (u < (1u << 4)) {
+        out.put(0b10, 2);
+        out.put(u, 4);
+    } else if (u < (1u << 8)) {
+        out.put(0b110, 3);
+        out.put(u, 8);
+    } else {
+        out.put(0b111, 3);
+        out.put(u, wideValueBits);
+    }
+}
+
+// Every value code fits in one peek(): the prefix is a run of ones
+std::int64_t getValue(BitReader& in) {
+    const std::uint64_t bits = in.peek();
+    if (!(bits >> 63)) {
+        in.skip(1);
+        return 0;
+    }
+    if (!(bits >> 62 & 1)) {
+        in.skip(2 + 4);
+        return zigzagDecode((bits >> (64 - 2 - 4)) & lowBits(4));
+    }
+    if (!(bits >> 61 & 1)) {
+        in.skip(3 + 8);
+        return zigzagDecode((bits >> (64 - 3 - 8)) & lowBits(8));
+    }
+    in.skip(3 + wideValueBits);
+    return zigzagDecode((bits >> (64 - 3 - wideValueBits)) & lowBits(wideValueBits));
+}
+
+std::int64_t quantize(float v, float min, float step) {
+    if (step <= 0.0f || !std::isfinite(v)) {
+        return 0;
+    }
+    const long q = std::lround((v - min) / step);
+    return std::clamp<long>(q, 0, quantMax);
+}
+
+} // namespace
+
+CompressedHistory::CompressedHistory(double retentionSeconds) : retention(retentionSeconds) {}
+
+void CompressedHistory::include(Summary& summary, double t, const float (&v)[3]) const {
+    if (summary.count == 0) {
+        summary.first = t;
+        for (int axis = 0; axis < 3; ++axis) {
+            summary.min[axis] = std::numeric_limits<float>::infinity();
+            summary.max[axis] = -std::numeric_limits<float>::infinity();
+        }
+    }
+    summary.last = t;
+    for (int axis = 0; axis < 3; ++axis) {
+        // Comparisons skip NaN
+        if (v[axis] < summary.min[axis]) summary.min[axis] = v[axis];
+        if (v[axis] > summary.max[axis]) summary.max[axis] = v[axis];
+    }
+    ++summary.count;
+}
+
+void CompressedHistory::append(const double* t, const float* x, const float* y, const float* z, std::size_t n) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::size_t slot = open.count;
+            openT[slot] = t[i];
+            openX[slot] = x[i];
+            openY[slot] = y[i];
+            openZ[slot] = z[i];
+            const float v[3] = {x[i], y[i], z[i]};
+            include(open, t[i], v);
+            if (open.count == blockSamples) {
+                seal();
+            }
+        }
+        samples += n;
+    }
+    appended.fetch_add(1, std::memory_order_release);
+}
+
+// Encodes the open block and drops the blocks past the retention time
+void CompressedHistory::seal() {
+    Block block;
+    block.summary = open;
+    BitWriter out(scratch);
+    const std::size_t n = open.count;
+
+    std::int64_t previousUs = 0;
+    std::int64_t previousDelta = 0;
+    for (std::size_t i = 1; i < n; ++i) {
+        const std::int64_t us = std::llround((openT[i] - open.first) * 1e6);
+        const std::int64_t delta = us - previousUs;
+        putTime(out, delta - previousDelta);
+        previousUs = us;
+        previousDelta = delta;
+    }
+
+    const float* axes[3] = {openX.data(), openY.data(), openZ.data()};
+    for (int axis = 0; axis < 3; ++axis) {
+        float& min = block.summary.min[axis];
+        float& max = block.summary.max[axis];
+        if (!(min <= max)) {
+            min = max = 0.0f; // No finite values
+        }
+        const float range = max - min;
+        const float step = std::isfinite(range) && range > 0.0f ? range / quantMax : 0.0f;
+        block.step[axis] = step;
+        if (step == 0.0f) {
+            continue;
+        }
+        // Smooth motion has far smaller second differences than first ones, noise the
+        // other way round: take whichever order codes shorter, flagged with one bit
+        std::int64_t q[blockSamples];
+        std::size_t firstOrder = 0;
+        std::size_t secondOrder = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            q[i] = quantize(axes[axis][i], min, step);
+            const std::int64_t delta = q[i] - (i > 0 ? q[i - 1] : 0);
+            const std::int64_t previousDelta = i > 1 ? q[i - 1] - q[i - 2] : 0;
+            firstOrder += valueBits(delta);
+            secondOrder += valueBits(delta - previousDelta);
+        }
+        const bool second = secondOrder < firstOrder;
+        out.put(second ? 1 : 0, 1);
+        std::int64_t previousDelta = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::int64_t delta = q[i] - (i > 0 ? q[i - 1] : 0);
+            putValue(out, second && i > 1 ? delta - previousDelta : delta);
+            previousDelta = delta;
+        }
+    }
+
+    // Copied out at its exact size, the scratch vector keeps its capacity for the next block
+    block.bits.assign(scratch.begin(), scratch.end());
+    payloadBytes += block.bits.size() * sizeof(std::uint64_t);
+    blocks.push_back(std::move(block));
+    open = Summary{};
+
+    const double cutoff = blocks.back().summary.last - retention;
+    while (!blocks.empty() && blocks.front().summary.last < cutoff) {
+        payloadBytes -= blocks.front().bits.size() * sizeof(std::uint64_t);
+        samples -= blocks.front().summary.count;
+        blocks.pop_front();
+    }
+}
+
+std::size_t CompressedHistory::decode(const Block& block, double* t, float* x, float* y, float* z) {
+    BitReader in(block.bits);
+    const std::size_t n = block.summary.count;
+
+    t[0] = block.summary.first;
+    std::int64_t us = 0;
+    std::int64_t delta = 0;
+    for (std::size_t i = 1; i < n; ++i) {
+        delta += getTime(in);
+        us += delta;
+        t[i] = block.summary.first + us * 1e-6;
+    }
+
+    float* axes[3] = {x, y, z};
+    for (int axis = 0; axis < 3; ++axis) {
+        const float min = block.summary.min[axis];
+        const float step = block.step[axis];
+        if (step == 0.0f) {
+            std::fill(axes[axis], axes[axis] + n, min);
+            continue;
+        }
+        const bool second = in.get(1) != 0;
+        std::int64_t q = 0;
+        std::int64_t delta = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::int64_t code = getValue(in);
+            delta = second && i > 1 ? delta + code : code;
+            q += delta;
+            axes[axis][i] = min + static_cast<float>(q) * step;
+        }
+    }
+    return n;
+}
+
+std::size_t CompressedHistory::readDecimated(double from, double to, std::size_t buckets,
+                                             double* t, float* x, float* y, float* z) const {
+    if (buckets == 0 || !(to > from)) {
+        return 0;
+    }
+
+    std::size_t count = 0;
+    auto emit = [&](const Summary& s) {
+        t[count] = s.first;
+        x[count] = s.min[0];
+        y[count] = s.min[1];
+        z[count] = s.min[2];
+        ++count;
+        t[count] = s.last;
+        x[count] = s.max[0];
+        y[count] = s.max[1];
+        z[count] = s.max[2];
+        ++count;
+    };
+    auto merge = [](Summary& into, const Summary& s) {
+        if (into.count == 0) {
+            into = s;
+            return;
+        }
+        into.last = s.last;
+        for (int axis = 0; axis < 3; ++axis) {
+            into.min[axis] = std::min(into.min[axis], s.min[axis]);
+            into.max[axis] = std::max(into.max[axis], s.max[axis]);
+        }
+        into.count += s.count;
+    };
+
+    std::unique_lock<std::mutex> lock(mtx);
+    const auto first = std::lower_bound(blocks.begin(), blocks.end(), from,
+                                        [](const Block& b, double v) { return b.summary.last < v; });
+    const auto last = std::upper_bound(first, blocks.end(), to,
+                                       [](double v, const Block& b) { return v < b.summary.first; });
+    const bool withOpen = open.count > 0 && open.last >= from && open.first <= to;
+    const std::size_t inRange = static_cast<std::size_t>(last - first) + (withOpen ? 1 : 0);
+    if (inRange == 0) {
+        return 0;
+    }
+
+    // Zoomed out: each block covers a few pixel columns at most, its summary is enough.
+    // Also bounds the decoding below to buckets / 4 blocks.
+    if (4 * inRange >= buckets) {
+        const std::size_t group = (inRange + buckets - 1) / buckets;
+        Summary merged;
+        std::size_t grouped = 0;
+        auto add = [&](const Summary& s) {
+            merge(merged, s);
+            if (++grouped == group) {
+                emit(merged);
+                merged = Summary{};
+                grouped = 0;
+            }
+        };
+        for (auto it = first; it != last; ++it) {
+            add(it->summary);
+        }
+        if (withOpen) {
+            add(open);
+        }
+        if (grouped > 0) {
+            emit(merged);
+        }
+        return count;
+    }
+
+    // Otherwise decode the blocks and take min/max over equal time slices. The blocks
+    // are copied first and decoded after unlocking, so the writer isn't held up; the
+    // copies are kept per thread and reuse their storage.
+    thread_local std::vector<Block> copies;
+    std::size_t copied = 0;
+    for (auto it = first; it != last; ++it, ++copied) {
+        if (copied == copies.size()) {
+            copies.emplace_back();
+        }
+        Block& copy = copies[copied];
+        copy.summary = it->summary;
+        std::copy(std::begin(it->step), std::end(it->step), std::begin(copy.step));
+        copy.bits.assign(it->bits.begin(), it->bits.end());
+    }
+    const std::size_t openCount = withOpen ? open.count : 0;
+    double ot[blockSamples];
+    float ox[blockSamples], oy[blockSamples], oz[blockSamples];
+    std::copy(openT.begin(), openT.begin() + openCount, ot);
+    std::copy(openX.begin(), openX.begin() + openCount, ox);
+    std::copy(openY.begin(), openY.begin() + openCount, oy);
+    std::copy(openZ.begin(), openZ.begin() + openCount, oz);
+    lock.unlock();
+
+    // Slices only move forward, so out-of-order timestamps can't emit more than
+    // 'buckets' of them
+    const double width = (to - from) / static_cast<double>(buckets);
+    Summary slice;
+    std::size_t sliceIndex = 0;
+    auto addSamples = [&](const double* ts, const float* xs, const float* ys, const float* zs, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            if (ts[i] < from || ts[i] > to) {
+                continue;
+            }
+            std::size_t index = std::min(static_cast<std::size_t>((ts[i] - from) / width), buckets - 1);
+            index = std::max(index, sliceIndex);
+            if (index != sliceIndex && slice.count > 0) {
+                emit(slice);
+                slice = Summary{};
+            }
+            sliceIndex = index;
+            const float v[3] = {xs[i], ys[i], zs[i]};
+            include(slice, ts[i], v);
+        }
+    };
+
+    double bt[blockSamples];
+    float bx[blockSamples], by[blockSamples], bz[blockSamples];
+    for (std::size_t b = 0; b < copied; ++b) {
+        const std::size_t n = decode(copies[b], bt, bx, by, bz);
+        addSamples(bt, bx, by, bz, n);
+    }
+    addSamples(ot, ox, oy, oz, openCount);
+    if (slice.count > 0) {
+        emit(slice);
+    }
+    return count;
+}
+
+double CompressedHistory::newestTime() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (open.count > 0) return open.last;
+    return blocks.empty() ? 0.0 : blocks.back().summary.last;
+}
+
+double CompressedHistory::oldestTime() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!blocks.empty()) return blocks.front().summary.first;
+    return open.count > 0 ? open.first : 0.0;
+}
+
+std::uint64_t CompressedHistory::sampleCount() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return samples;
+}
+
+std::size_t CompressedHistory::memoryBytes() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return sizeof(*this) + blocks.size() * sizeof(Block) + payloadBytes + scratch.capacity() * sizeof(std::uint64_t);
+}
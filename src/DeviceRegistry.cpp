@@ -0,0 +1,33 @@
+#include "DeviceRegistry.h"
+
+DeviceBuffers* DeviceRegistry::connect(const std::string& id) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (auto& device : devices_) {
+        if (device->id == id) {
+            bool wasConnected = device->connected.exchange(true);
+            return wasConnected ? nullptr : device.get();
+        }
+    }
+    if (devices_.size() >= static_cast<std::size_t>(config_.maxDevices)) {
+        return nullptr;
+    }
+
+    devices_.push_back(std::make_unique<DeviceBuffers>(id, config_));
+    devices_.back()->connected = true;
+    version_.fetch_add(1, std::memory_order_release);
+    return devices_.back().get();
+}
+
+void DeviceRegistry::disconnect(DeviceBuffers& device) {
+    device.connected = false;
+}
+
+std::vector<DeviceBuffers*> DeviceRegistry::devices() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    std::vector<DeviceBuffers*> result;
+    result.reserve(devices_.size());
+    for (auto& device : devices_) {
+        result.push_back(device.get());
+    }
+    return result;
+}
@@ -0,0 +1,62 @@
+#include "Fft.h"
+
+#include <cmath>
+#include <stdexcept>
+
+Fft::Fft(std::size_t size) : n(size), window(size), twiddles(size / 2), bitReversed(size), scratch(size) {
+    if (size < 4 || (size & (size - 1)) != 0) {
+        throw std::invalid_argument("FFT size must be a power of two");
+    }
+    const double pi = std::acos(-1.0);
+
+    windowGain = 0.0f;
+    for (std::size_t i = 0; i < n; ++i) {
+        window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * pi * i / n));
+        windowGain += window[i];
+    }
+    for (std::size_t k = 0; k < n / 2; ++k) {
+        twiddles[k] = std::polar(1.0f, static_cast<float>(-2.0 * pi * k / n));
+    }
+
+    unsigned bits = 0;
+    while ((std::size_t(1) << bits) < n) ++bits;
+    for (std::size_t i = 0; i < n; ++i) {
+        std::size_t r = 0;
+        for (unsigned b = 0; b < bits; ++b) {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        bitReversed[i] = r;
+    }
+}
+
+void Fft::amplitudeDb(const float* frame, float* db) {
+    double mean = 0.0;
+    for (std::size_t i = 0; i < n; ++i) mean += frame[i];
+    const float offset = static_cast<float>(mean / n);
+
+    // Windowed samples go straight to their bit reversed slots
+    for (std::size_t i = 0; i < n; ++i) {
+        scratch[bitReversed[i]] = std::complex<float>((frame[i] - offset) * window[i], 0.0f);
+    }
+    transform();
+
+    // Single-sided amplitude, so a unit sine reads 0 dB
+    const float scale = 2.0f / windowGain;
+    for (std::size_t k = 0; k < bins(); ++k) {
+        float amplitude = std::abs(scratch[k]) * (k == 0 || k == n / 2 ? 0.5f : 1.0f) * scale;
+        db[k] = 20.0f * std::log10(amplitude + 1e-9f);
+    }
+}
+
+// Iterative in-place Cooley-Tukey on bit reversed input
+void Fft::transform() {
+    for (std::size_t half = 1, stride = n / 2; half < n; half <<= 1, stride >>= 1) {
+        for (std::size_t start = 0; start < n; start += 2 * half) {
+            for (std::size_t k = 0; k < half; ++k) {
+                const std::complex<float> t = twiddles[k * stride] * scratch[start + k + half];
+                scratch[start + k + half] = scratch[start + k] - t;
+                scratch[start + k] += t;
+            }
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#include "FramePacer.h"
+
+#include "raylib.h"
+#include "imgui.h"
+#include "Config.h"
+#include "Telemetry.h"
+
+FramePacer::FramePacer(DeviceRegistry& registry_ref)
+                      :
+                       m_registry(registry_ref), m_registry_version(0), m_generation(0),
+                       m_last_input(0.0), m_last_data(0.0), m_frame_rate(targetFrameRate) // As set by runApp
+{}
+
+// Changes whenever any device, live or replayed, gets new samples. The device list is
+// only copied when the registry's version moves, so a frame takes no lock and allocates nothing.
+std::uint64_t FramePacer::DataGeneration() {
+    const std::uint64_t version = m_registry.version();
+    if (version != m_registry_version) {
+        m_registry_version = version;
+        const std::vector<DeviceBuffers*> devices = m_registry.devices();
+        m_devices.assign(devices.begin(), devices.end());
+    }
+
+    std::uint64_t generation = 0;
+    for (const DeviceBuffers* device : m_devices) {
+        generation += device->gyro.written() + device->accel.written() + device->mag.written();
+    }
+    return generation;
+}
+
+// Mouse, keyboard, a widget being edited or the window being resized
+bool FramePacer::HasInput() {
+    const ImGuiIO& io = ImGui::GetIO();
+    if (io.MouseDelta.x != 0.0f || io.MouseDelta.y != 0.0f || io.MouseWheel != 0.0f || io.MouseWheelH != 0.0f) {
+        return true;
+    }
+    for (int button = 0; button < ImGuiMouseButton_COUNT; ++button) {
+        if (io.MouseDown[button]) return true;
+    }
+    for (int key = ImGuiKey_NamedKey_BEGIN; key < ImGuiKey_NamedKey_END; ++key) {
+        if (ImGui::IsKeyDown(static_cast<ImGuiKey>(key))) return true;
+    }
+    return ImGui::IsAnyItemActive() || IsWindowResized();
+}
+
+void FramePacer::Update() {
+    const double now = GetTime();
+    const std::uint64_t generation = DataGeneration();
+    if (generation != m_generation) {
+        m_generation = generation;
+        m_last_data = now;
+    }
+    if (HasInput()) {
+        m_last_input = now;
+    }
+
+    int frame_rate = idleFrameRate;
+    if (now - m_last_input < activeHoldSeconds) {
+        frame_rate = targetFrameRate;
+    } else if (now - m_last_data < activeHoldSeconds) {
+        frame_rate = IsWindowFocused() ? targetFrameRate : backgroundFrameRate;
+    }
+
+    if (frame_rate != m_frame_rate) {
+        SetTargetFPS(frame_rate);
+        m_frame_rate = frame_rate;
+    }
+    IMU_TELEMETRY(if (m_frame_rate < targetFrameRate) telemetry().idleFrames.add());
+}
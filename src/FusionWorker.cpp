@@ -0,0 +1,114 @@
+#include "FusionWorker.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+constexpr auto idleSleep = std::chrono::milliseconds(2);
+constexpr double maxStep = 0.1; // Longer gaps are not integrated in one step
+constexpr float radToDeg = 57.29577951f;
+
+// Takes every pending sample of 'pending' up to time 't', refilling from 'buffer'
+// as needed, and leaves the newest one in 'latest'
+template <typename Buffer, typename Pending>
+void advanceTo(const Buffer& buffer, Pending& pending, double t, float* latest) {
+    while (true) {
+        if (pending.pos == pending.count) {
+            pending.count = buffer.readSince(pending.cursor, std::size(pending.t),
+                                             pending.t, pending.x, pending.y, pending.z);
+            pending.pos = 0;
+            if (pending.count == 0) {
+                return;
+            }
+        }
+        if (pending.t[pending.pos] > t) {
+            return;
+        }
+        latest[0] = pending.x[pending.pos];
+        latest[1] = pending.y[pending.pos];
+        latest[2] = pending.z[pending.pos];
+        ++pending.pos;
+    }
+}
+
+} // namespace
+
+FusionWorker::FusionWorker(DeviceRegistry& registry_ref, TaskPool& pool_ref)
+    : registry(registry_ref), pool(pool_ref), worker(&FusionWorker::workerLoop, this)
+{}
+
+FusionWorker::~FusionWorker() {
+    running.store(false, std::memory_order_relaxed);
+    worker.join();
+}
+
+void FusionWorker::syncDevices() {
+    std::uint64_t version = registry.version();
+    if (version == registryVersion) {
+        return;
+    }
+    registryVersion = version;
+
+    std::vector<DeviceBuffers*> devices = registry.devices();
+    for (std::size_t i = states.size(); i < devices.size(); ++i) {
+        states.push_back(std::make_unique<DeviceState>(*devices[i], registry.config().fusionBeta));
+    }
+}
+
+void FusionWorker::workerLoop() {
+    while (running.load(std::memory_order_relaxed)) {
+        syncDevices();
+        // Each device's state is only touched by its own task
+        std::atomic<bool> busy{false};
+        pool.parallelFor(states.size(), [&](std::size_t i) {
+            if (process(*states[i])) {
+                busy.store(true, std::memory_order_relaxed);
+            }
+        });
+        if (!busy.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(idleSleep);
+        }
+    }
+}
+
+bool FusionWorker::process(DeviceState& s) {
+    Pending& gyro = s.gyro;
+    const std::size_t count = s.device.gyro.readSince(gyro.cursor, batchSamples, gyro.t, gyro.x, gyro.y, gyro.z);
+    if (count == 0) {
+        return false;
+    }
+
+    const double nominalPeriod = 1.0 / s.device.config.gyroFreq;
+    for (std::size_t i = 0; i < count; ++i) {
+        const double t = gyro.t[i];
+        advanceTo(s.device.accel, s.accel, t, s.a);
+        advanceTo(s.device.mag, s.mag, t, s.m);
+
+        double dt = s.started ? t - s.lastTime : nominalPeriod;
+        dt = std::clamp(dt, 0.0, maxStep);
+        s.lastTime = t;
+        s.started = true;
+
+        s.filter.update(gyro.x[i], gyro.y[i], gyro.z[i], s.a[0], s.a[1], s.a[2],
+                        s.m[0], s.m[1], s.m[2], static_cast<float>(dt));
+
+        // q and -q are the same rotation; keep w >= 0 so w can be dropped
+        UnitQuaternion q = s.filter.orientation();
+        if (q.w < 0.0f) {
+            q = UnitQuaternion{-q.w, -q.x, -q.y, -q.z};
+        }
+        s.outT[i] = t;
+        s.qx[i] = q.x;
+        s.qy[i] = q.y;
+        s.qz[i] = q.z;
+        s.roll[i] = radToDeg * std::atan2(2.0f * (q.w * q.x + q.y * q.z), 1.0f - 2.0f * (q.x * q.x + q.y * q.y));
+        s.pitch[i] = radToDeg * std::asin(std::clamp(2.0f * (q.w * q.y - q.z * q.x), -1.0f, 1.0f));
+        s.yaw[i] = radToDeg * std::atan2(2.0f * (q.w * q.z + q.x * q.y), 1.0f - 2.0f * (q.y * q.y + q.z * q.z));
+    }
+
+    s.device.euler.append(s.outT, s.roll, s.pitch, s.yaw, count);
+    s.device.quaternion.append(s.outT, s.qx, s.qy, s.qz, count);
+    return true;
+}
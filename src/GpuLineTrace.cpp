@@ -0,0 +1,284 @@
+#include "GpuLineTrace.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "implot.h"
+#include "rlgl.h"
+#include "Telemetry.h"
+
+namespace {
+
+const char* lineVertexShader = R"(#version 330
+in vec2 timeA;   // Segment start: time relative to the base as hi + lo, and x/y/z
+in vec3 valueA;
+in vec2 timeB;   // Segment end
+in vec3 valueB;
+
+uniform vec4 rect;     // Plot area in pixels
+uniform vec4 limits;   // x min, x max, y min, y max
+uniform vec2 origin;   // Plot x = 0, relative to the base as hi + lo
+uniform vec2 display;
+uniform int axis;
+uniform float halfWidth;
+
+const vec2 corners[6] = vec2[6](vec2(0.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0),
+                                vec2(0.0, -1.0), vec2(1.0, 1.0), vec2(0.0, 1.0));
+
+vec2 toPixels(vec2 time, vec3 value) {
+    float t = (time.x - origin.x) + (time.y - origin.y);
+    return vec2(rect.x + (t - limits.x) / (limits.y - limits.x) * rect.z,
+                rect.y + (limits.w - value[axis]) / (limits.w - limits.z) * rect.w);
+}
+
+void main() {
+    vec2 a = toPixels(timeA, valueA);
+    vec2 b = toPixels(timeB, valueB);
+    vec2 dir = b - a;
+    float len = length(dir);
+    dir = len > 0.0 ? dir / len : vec2(1.0, 0.0);
+
+    // Quad around the segment, stretched by half the width at both ends to close the joints
+    vec2 corner = corners[gl_VertexID];
+    vec2 p = mix(a - dir * halfWidth, b + dir * halfWidth, corner.x) + vec2(-dir.y, dir.x) * corner.y * halfWidth;
+    gl_Position = vec4(p.x / display.x * 2.0 - 1.0, 1.0 - p.y / display.y * 2.0, 0.0, 1.0);
+}
+)";
+
+const char* lineFragmentShader = R"(#version 330
+uniform vec4 color;
+out vec4 finalColor;
+
+void main() {
+    finalColor = color;
+}
+)";
+
+// Shared by all traces, loaded with the first one and unloaded with the last
+struct LineShader {
+    unsigned int id = 0;
+    int users = 0;
+    unsigned int timeA, valueA, timeB, valueB;
+    int rect, limits, origin, display, axis, halfWidth, color;
+};
+
+LineShader lineShader;
+
+void acquireShader() {
+    if (lineShader.users++ > 0) {
+        return;
+    }
+    unsigned int id = rlLoadShaderCode(lineVertexShader, lineFragmentShader);
+    if (id == 0 || id == rlGetShaderIdDefault()) {
+        std::cerr << "[Plot] GPU line shader failed to build, using decimated plots" << std::endl;
+        return;
+    }
+    lineShader.id = id;
+    lineShader.timeA = static_cast<unsigned int>(rlGetLocationAttrib(id, "timeA"));
+    lineShader.valueA = static_cast<unsigned int>(rlGetLocationAttrib(id, "valueA"));
+    lineShader.timeB = static_cast<unsigned int>(rlGetLocationAttrib(id, "timeB"));
+    lineShader.valueB = static_cast<unsigned int>(rlGetLocationAttrib(id, "valueB"));
+    lineShader.rect = rlGetLocationUniform(id, "rect");
+    lineShader.limits = rlGetLocationUniform(id, "limits");
+    lineShader.origin = rlGetLocationUniform(id, "origin");
+    lineShader.display = rlGetLocationUniform(id, "display");
+    lineShader.axis = rlGetLocationUniform(id, "axis");
+    lineShader.halfWidth = rlGetLocationUniform(id, "halfWidth");
+    lineShader.color = rlGetLocationUniform(id, "color");
+}
+
+void releaseShader() {
+    if (--lineShader.users == 0 && lineShader.id != 0) {
+        rlUnloadShaderProgram(lineShader.id);
+        lineShader.id = 0;
+    }
+}
+
+// Splits a time into two floats whose sum keeps most of the double's precision
+void splitTime(double time, float* out) {
+    out[0] = static_cast<float>(time);
+    out[1] = static_cast<float>(time - static_cast<double>(out[0]));
+}
+
+} // namespace
+
+GpuLineTrace::GpuLineTrace(std::size_t capacity)
+                          :
+                           m_capacity(capacity), m_vao(0), m_vbo(0),
+                           m_next(0), m_valid_from(0), m_has_base(false), m_base(0.0), m_newest(0.0),
+                           m_times(capacity),
+                           m_t(chunk_size), m_x(chunk_size), m_y(chunk_size), m_z(chunk_size),
+                           m_points(chunk_size * point_floats)
+{
+    acquireShader();
+    if (lineShader.id == 0) {
+        return;
+    }
+
+    // Every attribute advances once per segment; the offsets are set per draw
+    m_vao = rlLoadVertexArray();
+    rlEnableVertexArray(m_vao);
+    m_vbo = rlLoadVertexBuffer(nullptr, static_cast<int>((capacity + 1) * point_floats * sizeof(float)), true);
+    for (unsigned int location : {lineShader.timeA, lineShader.valueA, lineShader.timeB, lineShader.valueB}) {
+        rlEnableVertexAttribute(location);
+        rlSetVertexAttributeDivisor(location, 1);
+    }
+    rlDisableVertexArray();
+}
+
+GpuLineTrace::~GpuLineTrace() {
+    if (m_vbo != 0) rlUnloadVertexBuffer(m_vbo);
+    if (m_vao != 0) rlUnloadVertexArray(m_vao);
+    releaseShader();
+}
+
+bool GpuLineTrace::Supported() {
+    const int version = rlGetVersion();
+    return version == RL_OPENGL_33 || version == RL_OPENGL_43;
+}
+
+bool GpuLineTrace::Ready() const {
+    return m_vbo != 0;
+}
+
+std::size_t GpuLineTrace::Resident() const {
+    const std::uint64_t oldest = std::max<std::uint64_t>(m_valid_from, m_next > m_capacity ? m_next - m_capacity : 0);
+    return static_cast<std::size_t>(m_next - oldest);
+}
+
+void GpuLineTrace::Upload(std::uint64_t first, std::size_t n) {
+    if (!m_has_base) {
+        m_base = m_t[0];
+        m_has_base = true;
+    }
+    if (first != m_next) {
+        m_valid_from = first; // Lapped, the samples in between are gone
+    }
+
+    for (std::size_t i = 0; i < n; ++i) {
+        float* point = m_points.data() + i * point_floats;
+        splitTime(m_t[i] - m_base, point);
+        point[2] = m_x[i];
+        point[3] = m_y[i];
+        point[4] = m_z[i];
+        m_times[static_cast<std::size_t>((first + i) % m_capacity)] = m_t[i];
+    }
+
+    const std::size_t slot = static_cast<std::size_t>(first % m_capacity);
+    const std::size_t head = std::min(n, m_capacity - slot);
+    WritePoints(slot, m_points.data(), head);
+    if (n > head) {
+        WritePoints(0, m_points.data() + head * point_floats, n - head);
+    }
+
+    m_next = first + n;
+    m_newest = m_t[n - 1];
+    IMU_TELEMETRY(telemetry().vertexBytesUploaded.add(n * point_floats * sizeof(float)));
+}
+
+void GpuLineTrace::WritePoints(std::size_t slot, const float* points, std::size_t count) {
+    if (m_vbo == 0 || count == 0) {
+        return;
+    }
+    const int stride = static_cast<int>(point_floats * sizeof(float));
+    rlUpdateVertexBuffer(m_vbo, points, static_cast<int>(count) * stride, static_cast<int>(slot) * stride);
+    if (slot == 0) {
+        // The segment starting in the last slot ends in slot 0
+        rlUpdateVertexBuffer(m_vbo, points, stride, static_cast<int>(m_capacity) * stride);
+    }
+}
+
+// Start of the first segment that reaches time 'from' or later
+std::uint64_t GpuLineTrace::FirstVisible(double from) const {
+    const std::uint64_t oldest = m_next - Resident();
+    std::uint64_t lo = oldest;
+    std::uint64_t hi = m_next - 1;
+    while (lo < hi) {
+        const std::uint64_t mid = lo + (hi - lo) / 2;
+        if (m_times[static_cast<std::size_t>(mid % m_capacity)] < from) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return std::max(lo, oldest + 1) - 1;
+}
+
+std::size_t GpuLineTrace::Plot(int axis, ImU32 color, float weight, double origin) const {
+    if (m_vbo == 0 || Resident() < 2) {
+        return 0;
+    }
+
+    const ImPlotRect limits = ImPlot::GetPlotLimits();
+    const ImVec2 pos = ImPlot::GetPlotPos();
+    const ImVec2 size = ImPlot::GetPlotSize();
+    const ImVec2 display = ImGui::GetIO().DisplaySize;
+    const ImVec4 rgba = ImGui::ColorConvertU32ToFloat4(color);
+
+    DrawParams params;
+    params.trace = this;
+    params.first = FirstVisible(origin + limits.X.Min);
+    params.segments = static_cast<std::size_t>(m_next - 1 - params.first);
+    params.rect[0] = pos.x;
+    params.rect[1] = pos.y;
+    params.rect[2] = size.x;
+    params.rect[3] = size.y;
+    params.limits[0] = static_cast<float>(limits.X.Min);
+    params.limits[1] = static_cast<float>(limits.X.Max);
+    params.limits[2] = static_cast<float>(limits.Y.Min);
+    params.limits[3] = static_cast<float>(limits.Y.Max);
+    splitTime(origin - m_base, params.origin);
+    params.display[0] = display.x;
+    params.display[1] = display.y;
+    params.color[0] = rgba.x;
+    params.color[1] = rgba.y;
+    params.color[2] = rgba.z;
+    params.color[3] = rgba.w;
+    params.halfWidth = std::max(weight, 1.0f) * 0.5f;
+    params.axis = axis;
+
+    // Copied into the draw list, so the callback doesn't depend on this frame's stack
+    ImPlot::GetPlotDrawList()->AddCallback(&GpuLineTrace::DrawCallback, &params, sizeof(params));
+    return params.segments;
+}
+
+void GpuLineTrace::DrawCallback(const ImDrawList*, const ImDrawCmd* cmd) {
+    const DrawParams& params = *static_cast<const DrawParams*>(cmd->UserCallbackData);
+    params.trace->Render(params);
+}
+
+// Runs while rlImGui renders, with the scissor already set to the plot area
+void GpuLineTrace::Render(const DrawParams& params) const {
+    rlDrawRenderBatchActive(); // Anything rlgl queued so far goes first
+    rlEnableShader(lineShader.id);
+    rlSetUniform(lineShader.rect, params.rect, RL_SHADER_UNIFORM_VEC4, 1);
+    rlSetUniform(lineShader.limits, params.limits, RL_SHADER_UNIFORM_VEC4, 1);
+    rlSetUniform(lineShader.origin, params.origin, RL_SHADER_UNIFORM_VEC2, 1);
+    rlSetUniform(lineShader.display, params.display, RL_SHADER_UNIFORM_VEC2, 1);
+    rlSetUniform(lineShader.axis, &params.axis, RL_SHADER_UNIFORM_INT, 1);
+    rlSetUniform(lineShader.halfWidth, &params.halfWidth, RL_SHADER_UNIFORM_FLOAT, 1);
+    rlSetUniform(lineShader.color, params.color, RL_SHADER_UNIFORM_VEC4, 1);
+
+    rlEnableVertexArray(m_vao);
+    rlEnableVertexBuffer(m_vbo);
+    const int stride = static_cast<int>(point_floats * sizeof(float));
+    std::uint64_t first = params.first;
+    std::size_t remaining = params.segments;
+    while (remaining > 0) {
+        // Segments are contiguous up to the end of the ring, then continue at slot 0
+        const std::size_t slot = static_cast<std::size_t>(first % m_capacity);
+        const std::size_t count = std::min(remaining, m_capacity - slot);
+        const int offset = static_cast<int>(slot) * stride;
+        const int values = 2 * static_cast<int>(sizeof(float));
+        rlSetVertexAttribute(lineShader.timeA, 2, RL_FLOAT, false, stride, offset);
+        rlSetVertexAttribute(lineShader.valueA, 3, RL_FLOAT, false, stride, offset + values);
+        rlSetVertexAttribute(lineShader.timeB, 2, RL_FLOAT, false, stride, offset + stride);
+        rlSetVertexAttribute(lineShader.valueB, 3, RL_FLOAT, false, stride, offset + stride + values);
+        rlDrawVertexArrayInstanced(0, 6, static_cast<int>(count));
+        first += count;
+        remaining -= count;
+    }
+    rlDisableVertexBuffer();
+    rlDisableVertexArray();
+    rlDisableShader();
+}
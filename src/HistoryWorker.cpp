@@ -0,0 +1,64 @@
+#include "HistoryWorker.h"
+
+#include <chrono>
+
+namespace {
+
+// The history lags the buffers by at most this, far below what a zoomed-out plot shows
+constexpr auto idleSleep = std::chrono::milliseconds(20);
+
+} // namespace
+
+HistoryWorker::HistoryWorker(DeviceRegistry& registry_ref, TaskPool& pool_ref)
+    : registry(registry_ref), pool(pool_ref), worker(&HistoryWorker::workerLoop, this)
+{}
+
+HistoryWorker::~HistoryWorker() {
+    running.store(false, std::memory_order_relaxed);
+    worker.join();
+}
+
+void HistoryWorker::syncDevices() {
+    std::uint64_t version = registry.version();
+    if (version == registryVersion) {
+        return;
+    }
+    registryVersion = version;
+
+    std::vector<DeviceBuffers*> all = registry.devices();
+    for (; devices < all.size(); ++devices) {
+        DeviceBuffers& device = *all[devices];
+        const ThreadSafeRingBuffer<>* buffers[streamsPerDevice] = {&device.gyro, &device.accel, &device.mag, &device.euler};
+        CompressedHistory* histories[streamsPerDevice] = {&device.gyroHistory, &device.accelHistory,
+                                                          &device.magHistory, &device.eulerHistory};
+        for (std::size_t s = 0; s < streamsPerDevice; ++s) {
+            auto stream = std::make_unique<Stream>();
+            stream->buffer = buffers[s];
+            stream->history = histories[s];
+            streams.push_back(std::move(stream));
+        }
+    }
+}
+
+void HistoryWorker::workerLoop() {
+    while (running.load(std::memory_order_relaxed)) {
+        syncDevices();
+        std::atomic<bool> busy{false};
+        pool.parallelFor(streams.size(), [&](std::size_t i) {
+            if (process(*streams[i])) {
+                busy.store(true, std::memory_order_relaxed);
+            }
+        });
+        if (!busy.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(idleSleep);
+        }
+    }
+}
+
+bool HistoryWorker::process(Stream& stream) {
+    const std::size_t count = stream.buffer->readSince(stream.cursor, readChunk, stream.t, stream.x, stream.y, stream.z);
+    if (count > 0) {
+        stream.history->append(stream.t, stream.x, stream.y, stream.z, count);
+    }
+    return count > 0;
+}
@@ -1,20 +1,132 @@
 #include "ImPlotPanel.h"
 
+namespace {
+
+// The device's compressed history, if the HistoryWorker fills it
+const CompressedHistory* historyOf(const DeviceBuffers& device, const CompressedHistory& history) {
+    return device.config.historySeconds > 0 ? &history : nullptr;
+}
+
+} // namespace
+
+ImPlotPanel::DevicePlots::DevicePlots(DeviceBuffers& device_ref)
+                                     :
+                                      device(device_ref), visible(true),
+                                      gyroPlot("Gyro##" + device_ref.id, device_ref.gyro, {"X", "Y", "Z"}, 1.1f,
+                                               historyOf(device_ref, device_ref.gyroHistory),
+                                               static_cast<float>(device_ref.config.bufferSeconds)),
+                                      accelPlot("Accel##" + device_ref.id, device_ref.accel, {"X", "Y", "Z"}, 1.1f,
+                                                historyOf(device_ref, device_ref.accelHistory),
+                                                static_cast<float>(device_ref.config.bufferSeconds)),
+                                      magPlot("Mag##" + device_ref.id, device_ref.mag, {"X", "Y", "Z"}, 1.1f,
+                                              historyOf(device_ref, device_ref.magHistory),
+                                              static_cast<float>(device_ref.config.bufferSeconds)),
+                                      orientationPlot("Orientation (deg)##" + device_ref.id, device_ref.euler,
+                                                      {"Roll", "Pitch", "Yaw"}, 180.0f,
+                                                      historyOf(device_ref, device_ref.eulerHistory),
+                                                      static_cast<float>(device_ref.config.bufferSeconds))
+{}
+
 ImPlotPanel::ImPlotPanel(int posX, int posY, int width, int height, 
-                         GyroBuffer& gyroBuffer_ref,
-                         AccelBuffer& accelBuffer_ref, 
-                         MagBuffer& magBuffer_ref,
-                         std::array<float, gyroBufferSize>& gyroTimeBuffer_ref,
-                         std::array<float, accelBufferSize>& accelTimeBuffer_ref,
-                         std::array<float, magBufferSize>& magTimeBuffer_ref)
+                         DeviceRegistry& registry_ref, TaskPool& pool_ref, ReplayEngine* replay)
                         :
                          m_posX(posX), m_posY(posY), m_width(width), m_height(height),
                          m_vertical_zoom(1.0f), m_horizontal_zoom(1.0f),
-                         m_gyroPlot("Gyro", gyroBuffer_ref, gyroTimeBuffer_ref),
-                         m_accelPlot("Accel", accelBuffer_ref, accelTimeBuffer_ref),
-                         m_magPlot("Mag", magBuffer_ref, magTimeBuffer_ref) 
+                         m_buffer_seconds(static_cast<float>(registry_ref.config().bufferSeconds)),
+                         // Zooming out reaches back over the whole compressed history
+                         m_min_time_zoom(registry_ref.config().historySeconds > 0
+                                             ? std::min(min_zoom, m_buffer_seconds / registry_ref.config().historySeconds)
+                                             : min_zoom),
+                         m_auto_fit_y(false), m_show_stats(false), m_gpu_lines(false),
+                         m_registry(registry_ref), m_registry_version(0), m_pool(pool_ref),
+                         m_replay(replay), m_seek_position(0.0f), m_seek_dragging(false)
 {}
 
+// Picks up devices added to the registry since the last frame
+void ImPlotPanel::SyncDevices() {
+    std::uint64_t version = m_registry.version();
+    if (version == m_registry_version) {
+        return;
+    }
+    m_registry_version = version;
+
+    std::vector<DeviceBuffers*> devices = m_registry.devices();
+    for (size_t i = m_devices.size(); i < devices.size(); ++i) {
+        m_devices.push_back(std::make_unique<DevicePlots>(*devices[i]));
+    }
+}
+
+// Tooltip with sample loss counters. Timestamp gaps point at the sensor or link,
+// parse errors and rejected samples at the ingest pipeline.
+void ImPlotPanel::DrawDeviceStats(const DeviceBuffers& device) {
+    ImGui::BeginTooltip();
+    ImGui::Text("Gyro:  %llu gaps, %llu samples missing",
+                (unsigned long long)device.gyro.gaps(), (unsigned long long)device.gyro.missingSamples());
+    ImGui::Text("Accel: %llu gaps, %llu samples missing",
+                (unsigned long long)device.accel.gaps(), (unsigned long long)device.accel.missingSamples());
+    ImGui::Text("Mag:   %llu gaps, %llu samples missing",
+                (unsigned long long)device.mag.gaps(), (unsigned long long)device.mag.missingSamples());
+    ImGui::Separator();
+    ImGui::Text("Parse errors: %llu", (unsigned long long)device.parseErrors.load());
+    ImGui::Text("Rejected samples: %llu", (unsigned long long)device.rejectedSamples.load());
+    ImGui::Separator();
+    ImGui::Text("Overload (%s)", overloadPolicyName(device.config.overloadPolicy));
+    ImGui::Text("Over budget: %llu, dropped: %llu, decimated: %llu, pauses: %llu",
+                (unsigned long long)device.overBudgetSamples.load(), (unsigned long long)device.droppedSamples.load(),
+                (unsigned long long)device.decimatedSamples.load(), (unsigned long long)device.readPauses.load());
+    if (device.config.historySeconds > 0) {
+        // Raw samples would take a double time and three floats each
+        const std::uint64_t samples = device.gyroHistory.sampleCount() + device.accelHistory.sampleCount() +
+                                      device.magHistory.sampleCount() + device.eulerHistory.sampleCount();
+        const double bytes = static_cast<double>(device.historyBytes());
+        ImGui::Separator();
+        ImGui::Text("History: %.1f min, %.2f MiB, %.1fx smaller than raw",
+                    (device.gyroHistory.newestTime() - device.gyroHistory.oldestTime()) / 60.0,
+                    bytes / (1024.0 * 1024.0), samples * 20.0 / bytes);
+    }
+    ImGui::EndTooltip();
+}
+
+// Play/pause, speed and seek for a recording being played back
+void ImPlotPanel::DrawReplayControls() {
+    static const float speeds[] = {0.25f, 0.5f, 1.0f, 2.0f, 4.0f, 8.0f, 16.0f, 0.0f};
+    static const char* speed_labels[] = {"0.25x", "0.5x", "1x", "2x", "4x", "8x", "16x", "Max"};
+
+    ImGui::Text("Replay:");
+    ImGui::SameLine();
+    bool playing = !m_replay->isPaused() && !m_replay->isFinished();
+    if (ImGui::Button(playing ? "Pause" : "Play")) {
+        if (playing) m_replay->pause();
+        else m_replay->play();
+    }
+
+    ImGui::SameLine();
+    int current = 2;
+    for (int i = 0; i < IM_ARRAYSIZE(speeds); ++i) {
+        if (static_cast<double>(speeds[i]) == m_replay->speed()) current = i;
+    }
+    ImGui::SetNextItemWidth(80.0f);
+    if (ImGui::Combo("##ReplaySpeed", &current, speed_labels, IM_ARRAYSIZE(speed_labels))) {
+        m_replay->setSpeed(speeds[current]);
+    }
+
+    // Follow the playback unless the slider is being dragged, seek on release
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x * 0.6f);
+    float duration = static_cast<float>(m_replay->duration());
+    if (!m_seek_dragging) {
+        m_seek_position = static_cast<float>(m_replay->position());
+    }
+    ImGui::SliderFloat("##ReplaySeek", &m_seek_position, 0.0f, duration, "%.1f s");
+    m_seek_dragging = ImGui::IsItemActive();
+    if (ImGui::IsItemDeactivatedAfterEdit()) {
+        m_replay->seek(m_seek_position);
+    }
+    ImGui::SameLine();
+    ImGui::Text("/ %.1f s", duration);
+    ImGui::Separator();
+}
+
 void ImPlotPanel::Draw() {
     ImGui::SetNextWindowPos(ImVec2(m_posX, m_posY), ImGuiCond_Always);
     ImGui::SetNextWindowSize(ImVec2(m_width, m_height), ImGuiCond_Always);
@@ -22,6 +134,7 @@ void ImPlotPanel::Draw() {
           ImGuiWindowFlags_NoMove | 
           ImGuiWindowFlags_NoResize | 
           ImGuiWindowFlags_NoCollapse |
+          ImGuiWindowFlags_NoBringToFrontOnFocus | // Keep floating panels on top
           ImGuiWindowFlags_AlwaysVerticalScrollbar
     );
 
@@ -38,7 +151,10 @@ void ImPlotPanel::Draw() {
     ImGui::Text("Time Scale:");
     ImGui::SameLine();
     ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x * 0.6f);
-    ImGui::SliderFloat("##TimeZoom", &m_horizontal_zoom, min_zoom, max_zoom, "%.1fx");
+    ImGui::SliderFloat("##TimeZoom", &m_horizontal_zoom, m_min_time_zoom, max_zoom, "%.3gx",
+                       ImGuiSliderFlags_Logarithmic);
+    ImGui::SameLine();
+    ImGui::Text("%.1f s", m_buffer_seconds / m_horizontal_zoom);
     
     // Reset buttons
     if (ImGui::Button("Reset Plot Heights")) {
@@ -48,22 +164,82 @@ void ImPlotPanel::Draw() {
     if (ImGui::Button("Reset Time Zoom")) {
         m_horizontal_zoom = 1.0f;
     }
+    ImGui::SameLine();
+    ImGui::Checkbox("Auto-fit Y", &m_auto_fit_y);
+    ImGui::SameLine();
+    ImGui::Checkbox("Stats", &m_show_stats);
+    ImGui::SameLine();
+    ImGui::Checkbox("GPU lines", &m_gpu_lines);
     
     ImGui::EndGroup();
     ImGui::Separator();
     // ------ End Zoom Controls ------
 
+    if (m_replay) {
+        DrawReplayControls();
+    }
+
+    // ------ Device List ------
+    SyncDevices();
+    ImGui::Text("Devices:");
+    int visible_devices = 0;
+    for (auto& plots : m_devices) {
+        ImGui::SameLine();
+        ImGui::Checkbox(plots->device.id.c_str(), &plots->visible);
+        if (ImGui::IsItemHovered()) {
+            DrawDeviceStats(plots->device);
+        }
+        if (!plots->device.connected) {
+            ImGui::SameLine(0.0f, 2.0f);
+            ImGui::TextDisabled("(offline)");
+        }
+        visible_devices += plots->visible ? 1 : 0;
+    }
+    ImGui::Separator();
+    // ------ End Device List ------
+
     // Calculate plot heights with vertical zoom
     const float content_height = ImGui::GetContentRegionAvail().y;
     const float total_plots_height = content_height * m_vertical_zoom;
-    const float plot_height = total_plots_height / 3.0f;
+    const float plot_height = total_plots_height / (4.0f * std::max(visible_devices, 1));
+
+    // Read every visible plot's data on the pool, drawing below then mostly submits it
+    const float displayed_range = m_buffer_seconds / m_horizontal_zoom;
+    m_prepare.clear();
+    for (auto& plots : m_devices) {
+        if (plots->visible) {
+            m_prepare.insert(m_prepare.end(),
+                             {&plots->gyroPlot, &plots->accelPlot, &plots->magPlot, &plots->orientationPlot});
+        }
+    }
+    m_pool.parallelFor(m_prepare.size(), [&](std::size_t i) {
+        m_prepare[i]->Prepare(displayed_range, m_auto_fit_y || m_show_stats, m_gpu_lines);
+    });
 
     // Draw plots
-    m_gyroPlot.Draw(plot_height, m_horizontal_zoom);
-    ImGui::Dummy(ImVec2(0, ImGui::GetStyle().ItemSpacing.y));
-    m_accelPlot.Draw(plot_height, m_horizontal_zoom);
-    ImGui::Dummy(ImVec2(0, ImGui::GetStyle().ItemSpacing.y));
-    m_magPlot.Draw(plot_height, m_horizontal_zoom);
+    for (auto& plots : m_devices) {
+        if (!plots->visible) {
+            continue;
+        }
+        if (visible_devices > 1) {
+            ImGui::SeparatorText(plots->device.id.c_str());
+        }
+        plots->gyroPlot.Draw(plot_height, displayed_range, m_auto_fit_y, m_show_stats, m_gpu_lines);
+        ImGui::Dummy(ImVec2(0, ImGui::GetStyle().ItemSpacing.y));
+        plots->accelPlot.Draw(plot_height, displayed_range, m_auto_fit_y, m_show_stats, m_gpu_lines);
+        ImGui::Dummy(ImVec2(0, ImGui::GetStyle().ItemSpacing.y));
+        plots->magPlot.Draw(plot_height, displayed_range, m_auto_fit_y, m_show_stats, m_gpu_lines);
+        ImGui::Dummy(ImVec2(0, ImGui::GetStyle().ItemSpacing.y));
+        plots->orientationPlot.Draw(plot_height, displayed_range, m_auto_fit_y, m_show_stats, m_gpu_lines);
+
+#if defined(IMU_ENABLE_TELEMETRY)
+        std::int64_t receivedNs = plots->device.lastReceiveNs.load(std::memory_order_relaxed);
+        if (receivedNs != 0 && receivedNs != plots->plottedReceiveNs) {
+            telemetry().receiveToPlot.record(telemetryNowNs() - receivedNs);
+            plots->plottedReceiveNs = receivedNs;
+        }
+#endif
+    }
 
     ImGui::End();
 }
@@ -0,0 +1,233 @@
+#include "ImuMessage.h"
+#include "ByteOrder.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Splits packed x/y/z triplets into the per-axis arrays
+const std::uint8_t* decodeTriplets(const std::uint8_t* p, std::size_t count, SensorSamples& samples) {
+    samples.resize(count);
+    for (std::size_t i = 0; i < count; ++i, p += 12) {
+        samples.x[i] = loadF32(p);
+        samples.y[i] = loadF32(p + 4);
+        samples.z[i] = loadF32(p + 8);
+    }
+    return p;
+}
+
+std::uint8_t* encodeTriplets(std::uint8_t* p, const SensorSamples& samples) {
+    for (std::size_t i = 0; i < samples.count; ++i, p += 12) {
+        storeF32(p, samples.x[i]);
+        storeF32(p + 4, samples.y[i]);
+        storeF32(p + 8, samples.z[i]);
+    }
+    return p;
+}
+
+// Minimal cursor over a text frame. The frame is not null terminated.
+struct TextCursor {
+    const char* p;
+    const char* end;
+
+    void skipSpace() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) ++p;
+    }
+
+    bool consume(char c) {
+        skipSpace();
+        if (p < end && *p == c) {
+            ++p;
+            return true;
+        }
+        return false;
+    }
+
+    bool peek(char c) {
+        skipSpace();
+        return p < end && *p == c;
+    }
+
+    template <typename T>
+    bool number(T& value) {
+        skipSpace();
+        if (p < end && *p == '+') ++p;
+        auto result = std::from_chars(p, end, value);
+        if (result.ec != std::errc()) return false;
+        p = result.ptr;
+        return true;
+    }
+
+    bool triplet(float& x, float& y, float& z) {
+        return consume('[') && number(x) && consume(',') && number(y) && consume(',') && number(z) && consume(']');
+    }
+};
+
+// Parses "[x, y, z]" or "[[x, y, z], [x, y, z], ...]" into samples
+bool parseTriplets(TextCursor& cursor, SensorSamples& samples) {
+    samples.count = 0;
+    float x, y, z;
+    if (!cursor.peek('[')) return false;
+
+    TextCursor probe = cursor;
+    ++probe.p;
+    if (!probe.peek('[')) {
+        if (!cursor.triplet(x, y, z)) return false;
+        samples.resize(1);
+        samples.x[0] = x; samples.y[0] = y; samples.z[0] = z;
+        return true;
+    }
+
+    cursor.consume('[');
+    do {
+        if (!cursor.triplet(x, y, z)) return false;
+        std::size_t i = samples.count;
+        samples.resize(i + 1);
+        samples.x[i] = x; samples.y[i] = y; samples.z[i] = z;
+    } while (cursor.consume(','));
+    return cursor.consume(']');
+}
+
+SensorSamples* sensorByName(ImuBatch& batch, const char* name, std::size_t len) {
+    auto is = [&](const char* s) { return len == std::strlen(s) && std::memcmp(name, s, len) == 0; };
+    if (is("Gyro")) return &batch.gyro;
+    if (is("Acc")) return &batch.accel;
+    if (is("Mag")) return &batch.mag;
+    return nullptr;
+}
+
+} // namespace
+
+void SensorSamples::resize(std::size_t n) {
+    if (x.size() < n) {
+        t.resize(n);
+        x.resize(n);
+        y.resize(n);
+        z.resize(n);
+    }
+    count = n;
+}
+
+void SensorSamples::stamp(double newest, double period) {
+    for (std::size_t i = 0; i < count; ++i) {
+        t[i] = newest - period * static_cast<double>(count - 1 - i);
+    }
+}
+
+void SensorSamples::keepNewest(std::size_t n) {
+    if (n >= count) {
+        return;
+    }
+    const std::size_t skip = count - n;
+    std::copy(t.begin() + skip, t.begin() + count, t.begin());
+    std::copy(x.begin() + skip, x.begin() + count, x.begin());
+    std::copy(y.begin() + skip, y.begin() + count, y.begin());
+    std::copy(z.begin() + skip, z.begin() + count, z.begin());
+    count = n;
+}
+
+std::size_t SensorSamples::decimate(std::size_t factor) {
+    if (factor <= 1 || count == 0) {
+        return count;
+    }
+    std::size_t kept = 0;
+    for (std::size_t i = (count - 1) % factor; i < count; i += factor, ++kept) {
+        t[kept] = t[i];
+        x[kept] = x[i];
+        y[kept] = y[i];
+        z[kept] = z[i];
+    }
+    count = kept;
+    return kept;
+}
+
+bool parseBinaryFrame(const void* data, std::size_t size, ImuBatch& batch) {
+    const auto* p = static_cast<const std::uint8_t*>(data);
+    if (size < imuFrameHeaderSize || p[0] != imuFrameMagic0 || p[1] != imuFrameMagic1) {
+        return false;
+    }
+
+    ImuFrameHeader header;
+    header.version = p[2];
+    header.flags = p[3];
+    header.gyroCount = loadU16(p + 4);
+    header.accelCount = loadU16(p + 6);
+    header.magCount = loadU16(p + 8);
+    header.timestampUs = loadU64(p + 12);
+    // Flags and the reserved bytes are 0 in version 1; anything else is a format we don't know
+    if (header.version != imuFrameVersion || header.flags != 0 || loadU16(p + 10) != 0) {
+        return false;
+    }
+
+    const std::size_t samples = std::size_t(header.gyroCount) + header.accelCount + header.magCount;
+    if (size != imuFrameHeaderSize + samples * 12) {
+        return false;
+    }
+
+    p += imuFrameHeaderSize;
+    p = decodeTriplets(p, header.gyroCount, batch.gyro);
+    p = decodeTriplets(p, header.accelCount, batch.accel);
+    decodeTriplets(p, header.magCount, batch.mag);
+    batch.timestampUs = header.timestampUs;
+    batch.hasTimestamp = true;
+    return true;
+}
+
+bool parseTextFrame(const char* data, std::size_t size, ImuBatch& batch) {
+    TextCursor cursor{data, data + size};
+    batch.gyro.count = 0;
+    batch.accel.count = 0;
+    batch.mag.count = 0;
+    batch.hasTimestamp = false;
+
+    bool any = false;
+    do {
+        cursor.skipSpace();
+        const char* name = cursor.p;
+        while (cursor.p < cursor.end && *cursor.p != ':') ++cursor.p;
+        if (cursor.p - name == 1 && *name == 'T') {
+            // llround() is only defined for results that fit a long long
+            constexpr double maxMicros = 9223372036854775808.0; // 2^63
+            double seconds;
+            if (!cursor.consume(':') || !cursor.number(seconds) || !std::isfinite(seconds) || seconds < 0.0 ||
+                seconds * 1e6 >= maxMicros) {
+                return false;
+            }
+            batch.timestampUs = static_cast<std::uint64_t>(std::llround(seconds * 1e6));
+            batch.hasTimestamp = true;
+            continue;
+        }
+        SensorSamples* samples = sensorByName(batch, name, cursor.p - name);
+        if (!samples || !cursor.consume(':') || !parseTriplets(cursor, *samples)) {
+            return false;
+        }
+        any = true;
+    } while (cursor.consume(','));
+
+    cursor.skipSpace();
+    return any && cursor.p == cursor.end;
+}
+
+void encodeBinaryFrame(const ImuBatch& batch, std::vector<std::uint8_t>& out) {
+    const std::size_t samples = batch.gyro.count + batch.accel.count + batch.mag.count;
+    out.resize(imuFrameHeaderSize + samples * 12);
+
+    std::uint8_t* p = out.data();
+    p[0] = imuFrameMagic0;
+    p[1] = imuFrameMagic1;
+    p[2] = imuFrameVersion;
+    p[3] = 0;
+    storeU16(p + 4, static_cast<std::uint16_t>(batch.gyro.count));
+    storeU16(p + 6, static_cast<std::uint16_t>(batch.accel.count));
+    storeU16(p + 8, static_cast<std::uint16_t>(batch.mag.count));
+    storeU16(p + 10, 0);
+    storeU64(p + 12, batch.timestampUs);
+
+    p += imuFrameHeaderSize;
+    p = encodeTriplets(p, batch.gyro);
+    p = encodeTriplets(p, batch.accel);
+    encodeTriplets(p, batch.mag);
+}
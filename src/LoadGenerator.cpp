@@ -0,0 +1,230 @@
+#define _USE_MATH_DEFINES
+#include "LoadGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+
+#include "ImuMessage.h"
+
+namespace net = boost::asio;
+namespace beast = boost::beast;
+namespace websocket = beast::websocket;
+using tcp = net::ip::tcp;
+
+namespace {
+
+constexpr double baseFrequencies[3] = {0.5, 1.0, 2.0}; // Hz, gyro, accel and mag
+constexpr double chirpSeconds = 10.0;
+constexpr double chirpSpan = 50.0; // Final frequency as a multiple of the base
+constexpr auto reconnectDelay = std::chrono::seconds(1);
+
+class Waveform {
+public:
+    Waveform(LoadSignal signal, unsigned seed) : signal(signal), rng(seed), noise(0.0f, 0.5f) {}
+
+    void sample(double frequency, double t, double phase, float& x, float& y, float& z) {
+        double angle = 2 * M_PI * frequency * t + phase;
+        switch (signal) {
+            case LoadSignal::Sine:
+                break;
+            case LoadSignal::Square:
+                x = std::sin(angle) >= 0.0 ? 1.0f : -1.0f;
+                y = std::cos(angle / 2) >= 0.0 ? 1.0f : -1.0f;
+                z = std::sin(angle / 3) >= 0.0 ? 1.0f : -1.0f;
+                return;
+            case LoadSignal::Chirp: {
+                // Frequency rises linearly from 'frequency' to chirpSpan times that
+                const double tau = std::fmod(t, chirpSeconds);
+                const double rise = (chirpSpan - 1.0) / chirpSeconds;
+                angle = 2 * M_PI * frequency * (tau + 0.5 * rise * tau * tau) + phase;
+                break;
+            }
+            case LoadSignal::Noise:
+                x = noise(rng);
+                y = noise(rng);
+                z = noise(rng);
+                return;
+        }
+        x = static_cast<float>(std::sin(angle));
+        y = static_cast<float>(std::cos(angle / 2));
+        z = static_cast<float>(std::sin(angle / 3));
+    }
+
+private:
+    LoadSignal signal;
+    std::mt19937 rng;
+    std::normal_distribution<float> noise;
+};
+
+} // namespace
+
+LoadGenerator::LoadGenerator(DeviceRegistry& registry_ref, const AppConfig& app_config, TriggerEngine* trigger_engine)
+    : registry(registry_ref), config(app_config), triggers(trigger_engine),
+      rates{app_config.gyroFreq, app_config.accelFreq, app_config.magFreq},
+      fastestRate(std::max({app_config.gyroFreq, app_config.accelFreq, app_config.magFreq})),
+      framePeriod(static_cast<double>(app_config.loadBatch) / fastestRate),
+      start(clock::now())
+{
+    std::cout << "[Load] " << config.loadDevices << " device(s), " << loadSignalName(config.loadSignal)
+              << " to " << loadTargetName(config.loadTarget) << ", " << config.loadBatch << " samples every "
+              << framePeriod * 1e3 << " ms" << std::endl;
+    if (config.loadTarget == LoadTarget::Socket) {
+        // A frame carries one timestamp, the server spaces every sensor back from it
+        for (int rate : rates) {
+            if (static_cast<long long>(config.loadBatch) * rate % fastestRate != 0) {
+                std::cerr << "[Load] load-batch doesn't split evenly across the sensor rates, "
+                          << "uneven frames will show up as timestamp jitter" << std::endl;
+                break;
+            }
+        }
+    }
+    for (int i = 0; i < config.loadDevices; ++i) {
+        threads.emplace_back(&LoadGenerator::deviceLoop, this, i);
+    }
+}
+
+LoadGenerator::~LoadGenerator() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    wakeup.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const double seconds = std::chrono::duration<double>(clock::now() - start).count();
+    const std::uint64_t sent = generated.load();
+    std::cout << "[Load] " << sent << " samples in " << seconds << " s ("
+              << static_cast<std::uint64_t>(sent / std::max(seconds, 1e-9)) << " samples/s), "
+              << droppedFrames.load() << " frames dropped, " << lateFrames.load() << " late" << std::endl;
+}
+
+bool LoadGenerator::sleepUntil(clock::time_point until) {
+    std::unique_lock<std::mutex> lock(mtx);
+    return !wakeup.wait_until(lock, until, [this]() { return stopping; });
+}
+
+void LoadGenerator::deviceLoop(int index) {
+    const std::string id = "load-" + std::to_string(index + 1);
+    const bool socket = config.loadTarget == LoadTarget::Socket;
+
+    // Direct: the device's buffers. Socket: a connection to our own server.
+    DeviceBuffers* device = nullptr;
+    net::io_context ioc;
+    websocket::stream<tcp::socket> ws(ioc);
+    if (socket) {
+        while (true) {
+            beast::error_code ec;
+            ws.next_layer().connect(tcp::endpoint(net::ip::address_v4::loopback(), config.port), ec);
+            if (!ec) {
+                ws.handshake("localhost", "/" + id, ec);
+            }
+            if (!ec) {
+                break;
+            }
+            std::cerr << "[Load] " << id << ": " << ec.message() << ", retrying" << std::endl;
+            beast::error_code ignored;
+            ws.next_layer().close(ignored);
+            if (!sleepUntil(clock::now() + reconnectDelay)) {
+                return;
+            }
+        }
+        ws.binary(true);
+    } else {
+        device = registry.connect(id);
+        if (!device) {
+            std::cerr << "[Load] Device '" << id << "' is already connected or over max-devices" << std::endl;
+            return;
+        }
+    }
+
+    Waveform waveform(config.loadSignal, static_cast<unsigned>(index + 1));
+    std::mt19937 rng(static_cast<unsigned>(index) * 7919u + 1u);
+    std::uniform_real_distribution<double> jitter(0.0, config.loadJitter);
+    std::bernoulli_distribution dropout(config.loadDropout);
+    const double phase = 0.7 * index; // Devices don't all draw the same curve
+
+    ImuBatch batch;
+    SensorSamples* sensors[3] = {&batch.gyro, &batch.accel, &batch.mag};
+    ThreadSafeRingBuffer<>* buffers[3] = {};
+    std::shared_ptr<TriggerEngine::Stream> trigger; // The server checks socket frames itself
+    if (device) {
+        buffers[0] = &device->gyro;
+        buffers[1] = &device->accel;
+        buffers[2] = &device->mag;
+        if (triggers) {
+            trigger = triggers->openStream(*device);
+        }
+    }
+    std::uint64_t emitted[3] = {0, 0, 0};
+    std::vector<std::uint8_t> frame;
+
+    for (std::uint64_t n = 1;; ++n) {
+        const double frameTime = n * framePeriod;
+        const clock::time_point deadline =
+            start + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(frameTime));
+        const double delay = config.loadJitter > 0.0 ? jitter(rng) : 0.0;
+        if (!sleepUntil(deadline + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(delay)))) {
+            break;
+        }
+        if (std::chrono::duration<double>(clock::now() - deadline).count() > delay + framePeriod) {
+            lateFrames.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        std::size_t total = 0;
+        for (int s = 0; s < 3; ++s) {
+            const std::uint64_t due = loadSamplesDue(n, config.loadBatch, rates[s], fastestRate);
+            SensorSamples& samples = *sensors[s];
+            samples.resize(static_cast<std::size_t>(due - emitted[s]));
+            for (std::size_t i = 0; i < samples.count; ++i) {
+                samples.t[i] = static_cast<double>(emitted[s] + i) / rates[s];
+                waveform.sample(baseFrequencies[s], samples.t[i], phase, samples.x[i], samples.y[i], samples.z[i]);
+            }
+            emitted[s] = due;
+            total += samples.count;
+        }
+        if (config.loadDropout > 0.0 && dropout(rng)) {
+            droppedFrames.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        if (socket) {
+            batch.timestampUs = static_cast<std::uint64_t>(std::llround(frameTime * 1e6));
+            encodeBinaryFrame(batch, frame);
+            beast::error_code ec;
+            ws.write(net::buffer(frame), ec);
+            if (ec) {
+                std::cerr << "[Load] " << id << ": " << ec.message() << ", stopping" << std::endl;
+                return;
+            }
+        } else {
+            for (int s = 0; s < 3; ++s) {
+                SensorSamples& samples = *sensors[s];
+                samples.keepNewest(std::min(samples.count, buffers[s]->capacity()));
+                if (samples.count > 0) {
+                    buffers[s]->append(samples.t.data(), samples.x.data(), samples.y.data(), samples.z.data(),
+                                       samples.count);
+                }
+            }
+            if (trigger) {
+                trigger->process(batch);
+            }
+            IMU_TELEMETRY(device->lastReceiveNs.store(telemetryNowNs(), std::memory_order_relaxed));
+        }
+        generated.fetch_add(total, std::memory_order_relaxed);
+    }
+
+    if (socket) {
+        beast::error_code ignored;
+        ws.close(websocket::close_code::normal, ignored);
+    } else {
+        trigger.reset(); // Finishes its pending captures from the buffers
+        registry.disconnect(*device);
+    }
+}
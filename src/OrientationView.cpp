@@ -0,0 +1,118 @@
+#include "OrientationView.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "imgui.h"
+#include "raymath.h"
+#include "rlgl.h"
+#include "rlImGui.h"
+
+OrientationView::OrientationView(int posX, int posY, int width, int height, DeviceRegistry& registry_ref)
+                                :
+                                 m_posX(posX), m_posY(posY), m_width(width), m_height(height), m_open(true),
+                                 m_registry(registry_ref), m_registry_version(0), m_selected(0),
+                                 m_rendered_device(nullptr), m_rendered_generation(~std::uint64_t(0))
+{
+    m_target = LoadRenderTexture(width, height);
+    m_camera = Camera3D{};
+    m_camera.position = Vector3{3.0f, 2.5f, 3.0f};
+    m_camera.target = Vector3{0.0f, 0.0f, 0.0f};
+    m_camera.up = Vector3{0.0f, 1.0f, 0.0f};
+    m_camera.fovy = 45.0f;
+    m_camera.projection = CAMERA_PERSPECTIVE;
+}
+
+OrientationView::~OrientationView() {
+    UnloadRenderTexture(m_target);
+}
+
+// Copies the device list only when the registry's version moves, like FramePacer
+void OrientationView::SyncDevices() {
+    const std::uint64_t version = m_registry.version();
+    if (version != m_registry_version) {
+        m_registry_version = version;
+        m_devices = m_registry.devices();
+    }
+}
+
+DeviceBuffers* OrientationView::SelectedDevice() const {
+    if (m_selected < 0 || m_selected >= static_cast<int>(m_devices.size())) {
+        return nullptr;
+    }
+    return m_devices[m_selected];
+}
+
+void OrientationView::Render() {
+    if (!m_open) {
+        return;
+    }
+
+    SyncDevices();
+
+    // The texture still shows the newest orientation
+    DeviceBuffers* device = SelectedDevice();
+    const std::uint64_t generation = device ? device->quaternion.written() : 0;
+    if (device == m_rendered_device && generation == m_rendered_generation) {
+        return;
+    }
+    m_rendered_device = device;
+    m_rendered_generation = generation;
+
+    // Newest orientation; w >= 0 is implied by how the fusion stage stores it
+    ::Quaternion rotation = QuaternionIdentity();
+    double t;
+    float x, y, z;
+    if (device && device->quaternion.readRecent(1, &t, &x, &y, &z)) {
+        float w = std::sqrt(std::max(0.0f, 1.0f - x * x - y * y - z * z));
+        // Sensor frame is z up, raylib is y up: (x, y, z) -> (x, z, -y)
+        rotation = ::Quaternion{x, z, -y, w};
+    }
+
+    BeginTextureMode(m_target);
+    ClearBackground(RAYWHITE);
+    BeginMode3D(m_camera);
+    DrawGrid(10, 0.5f);
+
+    rlPushMatrix();
+    rlMultMatrixf(MatrixToFloat(QuaternionToMatrix(rotation)));
+    DrawCube(Vector3{0.0f, 0.0f, 0.0f}, 2.0f, 0.3f, 1.2f, SKYBLUE);
+    DrawCubeWires(Vector3{0.0f, 0.0f, 0.0f}, 2.0f, 0.3f, 1.2f, DARKBLUE);
+    // Sensor axes: x red, y green, z blue
+    DrawLine3D(Vector3{0.0f, 0.0f, 0.0f}, Vector3{1.6f, 0.0f, 0.0f}, RED);
+    DrawLine3D(Vector3{0.0f, 0.0f, 0.0f}, Vector3{0.0f, 0.0f, -1.2f}, GREEN);
+    DrawLine3D(Vector3{0.0f, 0.0f, 0.0f}, Vector3{0.0f, 1.0f, 0.0f}, BLUE);
+    rlPopMatrix();
+
+    EndMode3D();
+    EndTextureMode();
+}
+
+void OrientationView::Draw() {
+    if (!m_open) {
+        return;
+    }
+
+    ImGui::SetNextWindowPos(ImVec2(m_posX, m_posY), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(m_width + 16.0f, m_height + 60.0f), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Orientation (F4)", &m_open)) {
+        ImGui::End();
+        return;
+    }
+
+    SyncDevices();
+    const DeviceBuffers* selected = SelectedDevice();
+    if (ImGui::BeginCombo("Device", selected ? selected->id.c_str() : "")) {
+        for (int i = 0; i < static_cast<int>(m_devices.size()); ++i) {
+            if (ImGui::Selectable(m_devices[i]->id.c_str(), i == m_selected)) {
+                m_selected = i;
+            }
+        }
+        ImGui::EndCombo();
+    }
+
+    rlImGuiImageRenderTextureFit(&m_target, true);
+    ImGui::End();
+}
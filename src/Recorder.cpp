@@ -0,0 +1,258 @@
+#include "Recorder.h"
+#include "ByteOrder.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+constexpr std::size_t stagingFlushBytes = 1 << 20;       // Write in batches of about 1 MiB
+constexpr auto columnFlushInterval = std::chrono::seconds(1); // Bounds data lost on a crash
+constexpr auto idleSleep = std::chrono::milliseconds(2);
+
+std::uint8_t* appendBytes(std::vector<std::uint8_t>& out, std::size_t n) {
+    std::size_t offset = out.size();
+    out.resize(offset + n);
+    return out.data() + offset;
+}
+
+void appendVarint(std::vector<std::uint8_t>& out, std::uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(v));
+}
+
+void appendRecordHeader(std::vector<std::uint8_t>& out, RecordType type, std::uint32_t payloadSize) {
+    std::uint8_t* p = appendBytes(out, recordHeaderSize);
+    p[0] = static_cast<std::uint8_t>(type);
+    p[1] = p[2] = p[3] = 0;
+    storeU32(p + 4, payloadSize);
+}
+
+void appendFloats(std::vector<std::uint8_t>& out, const std::vector<float>& values) {
+    std::uint8_t* p = appendBytes(out, values.size() * 4);
+    for (float v : values) {
+        storeF32(p, v);
+        p += 4;
+    }
+}
+
+} // namespace
+
+Recorder::Stream::Stream(std::uint32_t index, std::string id, std::atomic<std::uint64_t>& total)
+    : deviceIndex(index), deviceId(std::move(id)), queue(streamQueueChunks), droppedTotal(total)
+{}
+
+bool Recorder::Stream::write(RecordSensor sensor, const SensorSamples& samples) {
+    for (std::size_t offset = 0; offset < samples.count; offset += chunkSamples) {
+        const std::size_t n = std::min(chunkSamples, samples.count - offset);
+        Chunk* chunk = queue.claim();
+        if (!chunk) {
+            std::uint64_t lost = samples.count - offset;
+            dropped.fetch_add(lost, std::memory_order_relaxed);
+            droppedTotal.fetch_add(lost, std::memory_order_relaxed);
+            return false;
+        }
+
+        chunk->sensor = sensor;
+        chunk->count = static_cast<std::uint16_t>(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            chunk->t[i] = std::llround(samples.t[offset + i] * 1e6);
+            chunk->x[i] = samples.x[offset + i];
+            chunk->y[i] = samples.y[offset + i];
+            chunk->z[i] = samples.z[offset + i];
+        }
+        queue.publish();
+    }
+    return true;
+}
+
+Recorder::Recorder(const std::string& path) {
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        throw std::runtime_error("Cannot open recording file '" + path + "'");
+    }
+    std::setvbuf(file, nullptr, _IONBF, 0); // The staging buffer already batches writes
+
+    staging.reserve(2 * stagingFlushBytes);
+    std::uint8_t* p = appendBytes(staging, recordingFileHeaderSize);
+    std::copy(recordingMagic, recordingMagic + sizeof(recordingMagic), p);
+    storeU16(p + 6, recordingVersion);
+    flushStaging();
+
+    std::cout << "[Recorder] Recording to " << path << std::endl;
+    writer = std::thread([this]() { writerLoop(); });
+}
+
+Recorder::~Recorder() {
+    running.store(false, std::memory_order_release);
+    writer.join();
+    std::fclose(file);
+    std::cout << "[Recorder] Wrote " << bytesWritten() / 1024 << " KiB, dropped "
+              << droppedSamples() << " samples" << std::endl;
+}
+
+std::shared_ptr<Recorder::Stream> Recorder::openStream(const std::string& deviceId) {
+    std::lock_guard<std::mutex> lock(streamsMtx);
+    auto it = deviceIndices.emplace(deviceId, static_cast<std::uint32_t>(deviceIndices.size())).first;
+    streams.push_back(std::make_shared<Stream>(it->second, deviceId, dropped));
+    return streams.back();
+}
+
+void Recorder::writerLoop() {
+    auto lastColumnFlush = std::chrono::steady_clock::now();
+    std::vector<std::shared_ptr<Stream>> active;
+    std::vector<std::uint32_t> finished;
+
+    while (true) {
+        // Read the flag before draining so nothing queued before shutdown is missed
+        const bool stopping = !running.load(std::memory_order_acquire);
+        {
+            std::lock_guard<std::mutex> lock(streamsMtx);
+            active = streams;
+        }
+
+        bool drained = false;
+        for (auto& stream : active) {
+            drained |= drain(*stream);
+        }
+
+        // Forget streams whose session has ended and whose queue is empty, and write
+        // out what their columns still hold so the columns don't outlive the device
+        finished.clear();
+        {
+            std::lock_guard<std::mutex> lock(streamsMtx);
+            for (auto it = streams.begin(); it != streams.end();) {
+                bool done = (*it)->closed.load(std::memory_order_acquire) && (*it)->queue.size() == 0;
+                if (done) {
+                    finished.push_back((*it)->deviceIndex);
+                }
+                it = done ? streams.erase(it) : it + 1;
+            }
+        }
+        for (std::uint32_t deviceIndex : finished) {
+            closeColumns(deviceIndex);
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (stopping || now - lastColumnFlush >= columnFlushInterval) {
+            flushColumns();
+            lastColumnFlush = now;
+        }
+        if (stopping || staging.size() >= stagingFlushBytes) {
+            flushStaging();
+        }
+
+        if (stopping) {
+            return;
+        }
+        if (!drained) {
+            std::this_thread::sleep_for(idleSleep);
+        }
+    }
+}
+
+bool Recorder::drain(Stream& stream) {
+    if (stream.deviceIndex >= announced.size()) {
+        announced.resize(stream.deviceIndex + 1, false);
+    }
+    if (!announced[stream.deviceIndex]) {
+        encodeDevice(stream.deviceIndex, stream.deviceId);
+        announced[stream.deviceIndex] = true;
+    }
+
+    bool any = false;
+    while (Chunk* chunk = stream.queue.front()) {
+        Column& column = columns[{stream.deviceIndex, chunk->sensor}];
+        if (column.t.capacity() < recordBlockSamples) {
+            column.t.reserve(recordBlockSamples);
+            column.x.reserve(recordBlockSamples);
+            column.y.reserve(recordBlockSamples);
+            column.z.reserve(recordBlockSamples);
+        }
+
+        for (std::size_t i = 0; i < chunk->count; ++i) {
+            column.t.push_back(chunk->t[i]);
+            column.x.push_back(chunk->x[i]);
+            column.y.push_back(chunk->y[i]);
+            column.z.push_back(chunk->z[i]);
+            if (column.t.size() == recordBlockSamples) {
+                encodeBlock(stream.deviceIndex, chunk->sensor, column);
+            }
+        }
+        stream.queue.pop();
+        any = true;
+    }
+    return any;
+}
+
+void Recorder::encodeDevice(std::uint32_t deviceIndex, const std::string& deviceId) {
+    appendRecordHeader(staging, RecordType::Device, static_cast<std::uint32_t>(4 + deviceId.size()));
+    storeU32(appendBytes(staging, 4), deviceIndex);
+    staging.insert(staging.end(), deviceId.begin(), deviceId.end());
+}
+
+void Recorder::encodeBlock(std::uint32_t deviceIndex, RecordSensor sensor, Column& column) {
+    const std::size_t count = column.t.size();
+    if (count == 0) {
+        return;
+    }
+
+    const std::size_t recordStart = staging.size();
+    appendRecordHeader(staging, RecordType::Block, 0); // Size patched below
+
+    const std::size_t headerStart = staging.size();
+    std::uint8_t* p = appendBytes(staging, blockHeaderSize);
+    storeU32(p, deviceIndex);
+    p[4] = static_cast<std::uint8_t>(sensor);
+    p[5] = p[6] = p[7] = 0;
+    storeU32(p + 8, static_cast<std::uint32_t>(count));
+    storeU64(p + 12, static_cast<std::uint64_t>(column.t.front()));
+    storeU64(p + 20, static_cast<std::uint64_t>(column.t.back()));
+
+    // Timestamps as deltas, a couple of bytes per sample at steady rates
+    const std::size_t deltasStart = staging.size();
+    for (std::size_t i = 1; i < count; ++i) {
+        appendVarint(staging, zigzagEncode(column.t[i] - column.t[i - 1]));
+    }
+    storeU32(staging.data() + headerStart + 28, static_cast<std::uint32_t>(staging.size() - deltasStart));
+
+    appendFloats(staging, column.x);
+    appendFloats(staging, column.y);
+    appendFloats(staging, column.z);
+    storeU32(staging.data() + recordStart + 4, static_cast<std::uint32_t>(staging.size() - headerStart));
+
+    column.t.clear();
+    column.x.clear();
+    column.y.clear();
+    column.z.clear();
+}
+
+void Recorder::flushColumns() {
+    for (auto& [key, column] : columns) {
+        encodeBlock(key.first, key.second, column);
+    }
+}
+
+void Recorder::closeColumns(std::uint32_t deviceIndex) {
+    auto it = columns.lower_bound({deviceIndex, static_cast<RecordSensor>(0)});
+    while (it != columns.end() && it->first.first == deviceIndex) {
+        encodeBlock(deviceIndex, it->first.second, it->second);
+        it = columns.erase(it);
+    }
+}
+
+void Recorder::flushStaging() {
+    if (staging.empty()) {
+        return;
+    }
+    if (std::fwrite(staging.data(), 1, staging.size(), file) != staging.size()) {
+        std::cerr << "[Recorder] Write failed, recording may be incomplete" << std::endl;
+    }
+    bytes.fetch_add(staging.size(), std::memory_order_relaxed);
+    staging.clear();
+}
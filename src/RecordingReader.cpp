@@ -0,0 +1,111 @@
+#include "RecordingReader.h"
+#include "ByteOrder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+RecordingReader::RecordingReader(const std::string& path) : m_file(path) {
+    const std::uint8_t* data = m_file.data();
+    const std::size_t size = m_file.size();
+    if (size < recordingFileHeaderSize || std::memcmp(data, recordingMagic, sizeof(recordingMagic)) != 0) {
+        throw std::runtime_error("'" + path + "' is not an IMU recording");
+    }
+    if (loadU16(data + 6) != recordingVersion) {
+        throw std::runtime_error("'" + path + "' has an unsupported recording version");
+    }
+
+    m_startUs = std::numeric_limits<std::int64_t>::max();
+    m_endUs = std::numeric_limits<std::int64_t>::min();
+
+    // Hop from record header to record header; a truncated tail (e.g. after a crash) is ignored
+    std::size_t pos = recordingFileHeaderSize;
+    while (pos + recordHeaderSize <= size) {
+        const RecordType type = static_cast<RecordType>(data[pos]);
+        const std::size_t payloadSize = loadU32(data + pos + 4);
+        const std::size_t payload = pos + recordHeaderSize;
+        if (payload + payloadSize > size) {
+            break;
+        }
+
+        if (type == RecordType::Device && payloadSize >= 4) {
+            std::uint32_t index = loadU32(data + payload);
+            if (m_devices.size() <= index) {
+                m_devices.resize(index + 1);
+            }
+            m_devices[index].assign(reinterpret_cast<const char*>(data + payload + 4), payloadSize - 4);
+        } else if (type == RecordType::Block && payloadSize >= blockHeaderSize) {
+            const std::uint8_t* p = data + payload;
+            std::uint32_t deviceIndex = loadU32(p);
+            RecordSensor sensor = static_cast<RecordSensor>(p[4]);
+            Block block{payload, loadU32(p + 8), loadU32(p + 28), static_cast<std::int64_t>(loadU64(p + 12)),
+                        static_cast<std::int64_t>(loadU64(p + 20))};
+
+            // A block whose sections don't fit its payload is damaged; skip it rather than
+            // let decodeBlock() read past the record
+            const std::uint64_t needed = std::uint64_t(blockHeaderSize) + block.deltaBytes + 12 * std::uint64_t(block.count);
+            if (needed > payloadSize || static_cast<std::size_t>(sensor) >= recordSensorCount) {
+                pos = payload + payloadSize;
+                continue;
+            }
+
+            auto track = std::find_if(m_tracks.begin(), m_tracks.end(), [&](const Track& t) {
+                return t.deviceIndex == deviceIndex && t.sensor == sensor;
+            });
+            if (track == m_tracks.end()) {
+                m_tracks.push_back(Track{deviceIndex, sensor, {}});
+                track = m_tracks.end() - 1;
+            }
+            track->blocks.push_back(block);
+            m_startUs = std::min(m_startUs, block.firstUs);
+            m_endUs = std::max(m_endUs, block.lastUs);
+        }
+        pos = payload + payloadSize;
+    }
+
+    if (m_tracks.empty()) {
+        m_startUs = m_endUs = 0;
+    }
+    for (auto& track : m_tracks) {
+        std::stable_sort(track.blocks.begin(), track.blocks.end(),
+                         [](const Block& a, const Block& b) { return a.firstUs < b.firstUs; });
+    }
+}
+
+std::size_t RecordingReader::findBlock(const Track& track, std::int64_t timeUs) const {
+    auto it = std::lower_bound(track.blocks.begin(), track.blocks.end(), timeUs,
+                               [](const Block& block, std::int64_t t) { return block.lastUs < t; });
+    return static_cast<std::size_t>(it - track.blocks.begin());
+}
+
+bool RecordingReader::decodeBlock(const Block& block, double offsetSeconds, SensorSamples& samples) const {
+    const std::uint8_t* p = m_file.data() + block.offset;
+    const std::size_t count = block.count;
+    const std::uint8_t* deltas = p + blockHeaderSize;
+    const std::uint8_t* deltasEnd = deltas + block.deltaBytes;
+    const std::uint8_t* floats = deltasEnd;
+
+    samples.resize(count);
+    std::int64_t t = block.firstUs;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (i > 0) {
+            std::uint64_t v = 0;
+            for (unsigned shift = 0;; shift += 7) {
+                if (deltas == deltasEnd || shift > 63) {
+                    samples.count = 0; // Varint runs past its section
+                    return false;
+                }
+                std::uint8_t byte = *deltas++;
+                v |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+                if (!(byte & 0x80)) break;
+            }
+            t += zigzagDecode(v);
+        }
+        samples.t[i] = t * 1e-6 + offsetSeconds;
+        samples.x[i] = loadF32(floats + 4 * i);
+        samples.y[i] = loadF32(floats + 4 * (count + i));
+        samples.z[i] = loadF32(floats + 4 * (2 * count + i));
+    }
+    return true;
+}
@@ -0,0 +1,216 @@
+#include "ReplayEngine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+constexpr std::int64_t noSeek = std::numeric_limits<std::int64_t>::min();
+constexpr std::int64_t maxSpeedStepUs = 1000000; // Recording time replayed per step at max speed
+constexpr auto playbackInterval = std::chrono::milliseconds(2);
+constexpr auto idleSleep = std::chrono::milliseconds(10);
+
+} // namespace
+
+ReplayEngine::ReplayEngine(const std::string& path, DeviceRegistry& registry_ref, double speed,
+                           TriggerEngine* triggers)
+    : reader(path), registry(registry_ref), lastSeconds(-std::numeric_limits<double>::infinity()),
+      speedFactor(std::max(speed, 0.0)), seekRequest(noSeek)
+{
+    const AppConfig& config = registry.config();
+    minPeriod = 1.0 / std::max({config.gyroFreq, config.accelFreq, config.magFreq});
+
+    for (std::size_t i = 0; i < reader.devices().size(); ++i) {
+        std::string id = reader.devices()[i].empty() ? "device-" + std::to_string(i) : reader.devices()[i];
+        DeviceBuffers* device = registry.connect("replay:" + id);
+        if (!device) {
+            for (DeviceBuffers* d : devices) registry.disconnect(*d);
+            throw std::runtime_error("Replay device 'replay:" + id + "' is already connected or over max-devices");
+        }
+        devices.push_back(device);
+        if (triggers) {
+            triggerStreams.push_back(triggers->openStream(*device));
+        }
+    }
+
+    for (const auto& source : reader.tracks()) {
+        if (source.deviceIndex >= devices.size()) {
+            continue; // Blocks without a device record, only possible in damaged files
+        }
+        DeviceBuffers& device = *devices[source.deviceIndex];
+        Track track;
+        track.source = &source;
+        track.trigger = triggers ? triggerStreams[source.deviceIndex].get() : nullptr;
+        switch (source.sensor) {
+            case RecordSensor::Gyro: track.buffer = &device.gyro; break;
+            case RecordSensor::Accel: track.buffer = &device.accel; break;
+            case RecordSensor::Mag: track.buffer = &device.mag; break;
+            default: continue;
+        }
+        tracks.push_back(std::move(track));
+    }
+
+    std::cout << "[Replay] " << path << ": " << devices.size() << " device(s), " << tracks.size()
+              << " track(s), " << duration() << " s" << std::endl;
+    worker = std::thread(&ReplayEngine::playbackLoop, this);
+}
+
+ReplayEngine::~ReplayEngine() {
+    running.store(false, std::memory_order_relaxed);
+    worker.join();
+    triggerStreams.clear(); // Finishes their pending captures before the devices go
+    for (DeviceBuffers* device : devices) {
+        registry.disconnect(*device);
+    }
+}
+
+void ReplayEngine::play() {
+    // Start over at the end of the recording, unless a seek is already on its way
+    if (finished.load(std::memory_order_relaxed)) {
+        std::int64_t expected = noSeek;
+        seekRequest.compare_exchange_strong(expected, reader.startUs(), std::memory_order_relaxed);
+    }
+    paused.store(false, std::memory_order_relaxed);
+}
+
+void ReplayEngine::setSpeed(double factor) {
+    speedFactor.store(std::max(factor, 0.0), std::memory_order_relaxed);
+}
+
+void ReplayEngine::seek(double seconds) {
+    double clamped = std::clamp(seconds, 0.0, duration());
+    seekRequest.store(reader.startUs() + static_cast<std::int64_t>(clamped * 1e6), std::memory_order_relaxed);
+}
+
+void ReplayEngine::playbackLoop() {
+    using clock = std::chrono::steady_clock;
+
+    applySeek(reader.startUs());
+    std::int64_t playhead = reader.startUs();
+    auto lastTick = clock::now();
+
+    // Throughput of the current uninterrupted max-speed run
+    auto runStart = lastTick;
+    std::uint64_t runSamples = 0;
+    bool measuring = false;
+
+    while (running.load(std::memory_order_relaxed)) {
+        std::int64_t target = seekRequest.exchange(noSeek, std::memory_order_relaxed);
+        if (target != noSeek) {
+            applySeek(target);
+            playhead = target;
+            positionUs.store(playhead - reader.startUs(), std::memory_order_relaxed);
+            finished.store(false, std::memory_order_relaxed);
+            measuring = false;
+        }
+
+        if (paused.load(std::memory_order_relaxed) || finished.load(std::memory_order_relaxed)) {
+            measuring = false;
+            std::this_thread::sleep_for(idleSleep);
+            lastTick = clock::now();
+            continue;
+        }
+
+        const auto now = clock::now();
+        const double speed = speedFactor.load(std::memory_order_relaxed);
+        if (speed > 0.0) {
+            auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(now - lastTick).count();
+            playhead += static_cast<std::int64_t>(elapsedUs * speed);
+            measuring = false;
+        } else {
+            playhead += maxSpeedStepUs;
+            if (!measuring) {
+                measuring = true;
+                runStart = now;
+                runSamples = samples.load(std::memory_order_relaxed);
+            }
+        }
+        lastTick = now;
+
+        bool remaining = false;
+        for (auto& track : tracks) {
+            remaining |= feed(track, playhead);
+        }
+        // Every sensor is at the playhead now, so captures get all three complete
+        for (auto& stream : triggerStreams) {
+            stream->completeCaptures();
+        }
+        positionUs.store(std::min(playhead, reader.endUs()) - reader.startUs(), std::memory_order_relaxed);
+
+        if (!remaining) {
+            finished.store(true, std::memory_order_relaxed);
+            if (measuring) {
+                double seconds = std::chrono::duration<double>(clock::now() - runStart).count();
+                std::uint64_t count = samples.load(std::memory_order_relaxed) - runSamples;
+                std::cout << "[Replay] Max speed: " << count << " samples in " << seconds << " s ("
+                          << static_cast<std::uint64_t>(count / std::max(seconds, 1e-9)) << " samples/s)"
+                          << std::endl;
+            }
+            std::cout << "[Replay] End of recording" << std::endl;
+        } else if (speed > 0.0) {
+            std::this_thread::sleep_for(playbackInterval);
+        }
+    }
+}
+
+void ReplayEngine::applySeek(std::int64_t timeUs) {
+    // Continue just after whatever the buffers already hold
+    if (lastSeconds > -std::numeric_limits<double>::infinity()) {
+        offsetSeconds = lastSeconds + minPeriod - timeUs * 1e-6;
+    }
+
+    const double start = timeUs * 1e-6 + offsetSeconds;
+    for (auto& track : tracks) {
+        const auto& blocks = track.source->blocks;
+        std::size_t block = reader.findBlock(*track.source, timeUs);
+        track.nextBlock = block;
+        track.next = 0;
+        track.decoded.count = 0;
+        if (block == blocks.size()) {
+            continue;
+        }
+        reader.decodeBlock(blocks[block], offsetSeconds, track.decoded);
+        track.nextBlock = block + 1;
+        const double* t = track.decoded.t.data();
+        track.next = static_cast<std::size_t>(std::lower_bound(t, t + track.decoded.count, start) - t);
+    }
+}
+
+bool ReplayEngine::feed(Track& track, std::int64_t timeUs) {
+    const double limit = timeUs * 1e-6 + offsetSeconds;
+    const std::size_t capacity = track.buffer->capacity();
+    while (true) {
+        SensorSamples& s = track.decoded;
+        if (track.next == s.count) {
+            if (track.nextBlock == track.source->blocks.size()) {
+                return false;
+            }
+            reader.decodeBlock(track.source->blocks[track.nextBlock++], offsetSeconds, s);
+            track.next = 0;
+        }
+
+        const double* t = s.t.data();
+        const std::size_t end = static_cast<std::size_t>(std::upper_bound(t + track.next, t + s.count, limit) - t);
+        while (track.next < end) {
+            std::size_t n = std::min(end - track.next, capacity);
+            track.buffer->append(t + track.next, s.x.data() + track.next, s.y.data() + track.next,
+                                 s.z.data() + track.next, n);
+            if (track.trigger) {
+                track.trigger->process(track.source->sensor, t + track.next, s.x.data() + track.next,
+                                       s.y.data() + track.next, s.z.data() + track.next, n);
+            }
+            track.next += n;
+            samples.fetch_add(n, std::memory_order_relaxed);
+            IMU_TELEMETRY(telemetry().samplesIngested.add(n));
+        }
+        if (end > 0) {
+            lastSeconds = std::max(lastSeconds, t[end - 1]);
+        }
+        if (end < s.count) {
+            return true;
+        }
+    }
+}
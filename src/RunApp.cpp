@@ -1,47 +1,85 @@
 #include "RunApp.h"
 #include "Config.h"
 #include "ImPlotPanel.h"
-#include "ThreadSafeRingBuffer.h"
+#include "DeviceRegistry.h"
+#include "TelemetryPanel.h"
+#include "OrientationView.h"
+#include "SpectrumPanel.h"
+#include "TriggerPanel.h"
+#include "FramePacer.h"
 
 #include "rlImGui.h"
 #include "imgui.h"
 #include "implot.h"
 
 
-void runApp(GyroBuffer &gyroBuffer, AccelBuffer& accelBuffer, MagBuffer& magBuffer, 
-            std::array<float, gyroBufferSize>& gyroTimeBuffer, 
-            std::array<float, accelBufferSize>& accelTimeBuffer, 
-            std::array<float, magBufferSize>& magTimeBuffer) 
-{ 
-  // Initialize window
-  InitWindow(screenWidth, screenHeight, "IMU Visualization");
-  SetTargetFPS(targetFrameRate);
-  
-  // Initialize ImGui and Plots 
-  rlImGuiSetup(true);
-  ImPlot::CreateContext();
-
-  // Enable 32 bit vertex indices for more than 64K vertices
-  ImGuiIO& io = ImGui::GetIO();
-  io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+// Panels live in here so the ones holding GPU resources are gone before the window closes
+static void runMainLoop(DeviceRegistry &registry, TaskPool &pool, SpectrumWorker &spectrum,
+                        TriggerEngine &triggers, ReplayEngine *replay)
+{
   ImPlotPanel plotPanel(0, 0, screenWidth, screenHeight, 
-                        gyroBuffer, accelBuffer, magBuffer, 
-                        gyroTimeBuffer, accelTimeBuffer, magTimeBuffer
-                        );
+                        registry, pool, replay);
+  OrientationView orientationView(screenWidth - 340, screenHeight - 380, 320, 300, registry);
+  SpectrumPanel spectrumPanel(60, 60, 720, 560, registry, spectrum);
+  TriggerPanel triggerPanel(100, 100, 900, 560, triggers);
+  FramePacer framePacer(registry);
+#if defined(IMU_ENABLE_TELEMETRY)
+  TelemetryPanel telemetryPanel(screenWidth - 460, 40, 440, 260);
+  std::int64_t lastFrameStart = telemetryNowNs();
+#endif
 
 
   // Run Main Loop
   while (!WindowShouldClose()) {
+    IMU_TELEMETRY(const std::int64_t frameStart = telemetryNowNs());
+    IMU_TELEMETRY(telemetry().frameInterval.record(frameStart - lastFrameStart));
+    IMU_TELEMETRY(lastFrameStart = frameStart);
+    IMU_TELEMETRY(if (IsKeyPressed(KEY_F3)) telemetryPanel.Toggle());
+    if (IsKeyPressed(KEY_F4)) orientationView.Toggle();
+    if (IsKeyPressed(KEY_F5)) spectrumPanel.Toggle();
+    if (IsKeyPressed(KEY_F6)) triggerPanel.Toggle();
+
+    // Off-screen passes
+    orientationView.Render();
+
     // Draw frame
     BeginDrawing();
     ClearBackground(RAYWHITE);
           
     rlImGuiBegin();
     plotPanel.Draw();
+    orientationView.Draw();
+    spectrumPanel.Draw();
+    triggerPanel.Draw();
+    IMU_TELEMETRY(telemetryPanel.Draw());
     rlImGuiEnd();
+    framePacer.Update();
     
+    // EndDrawing also waits out the frame rate limit, so it is timed separately
+    IMU_TELEMETRY(const std::int64_t swapStart = telemetryNowNs());
+    IMU_TELEMETRY(telemetry().frameCpu.record(swapStart - frameStart));
     EndDrawing();
+    IMU_TELEMETRY(telemetry().frameSwap.record(telemetryNowNs() - swapStart));
   }
+}
+
+void runApp(DeviceRegistry &registry, TaskPool &pool, SpectrumWorker &spectrum, TriggerEngine &triggers,
+            ReplayEngine *replay)
+{ 
+  // Initialize window
+  InitWindow(screenWidth, screenHeight, "IMU Visualization");
+  SetTargetFPS(targetFrameRate);
+  
+  // Initialize ImGui and Plots 
+  rlImGuiSetup(true);
+  ImPlot::CreateContext();
+
+  // Enable 32 bit vertex indices for more than 64K vertices
+  ImGuiIO& io = ImGui::GetIO();
+  io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+
+  runMainLoop(registry, pool, spectrum, triggers, replay);
+
   // Exit Gracefully
   ImPlot::DestroyContext();
   rlImGuiShutdown();
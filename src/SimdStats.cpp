@@ -0,0 +1,178 @@
+#include "SimdStats.h"
+
+#include <algorithm>
+#include <cmath>
+
+// SSE2 is part of the x86-64 baseline; AVX2 is compiled in via a target attribute
+// and only used if the CPU reports it
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define IMU_SIMD_SSE2 1
+#if defined(__GNUC__) || defined(__clang__)
+#define IMU_SIMD_AVX2 1
+#endif
+#endif
+
+namespace {
+
+struct Sums {
+    float min;
+    float max;
+    double sum;
+    double sumSquares;
+};
+
+AxisStats finish(const Sums& s, std::size_t n) {
+    AxisStats stats;
+    stats.min = s.min;
+    stats.max = s.max;
+    stats.mean = s.sum / n;
+    stats.rms = std::sqrt(s.sumSquares / n);
+    return stats;
+}
+
+// Handles the tail of the vector kernels too
+void scalarSums(const float* data, std::size_t n, Sums& s) {
+    for (std::size_t i = 0; i < n; ++i) {
+        const float v = data[i];
+        s.min = std::min(s.min, v);
+        s.max = std::max(s.max, v);
+        s.sum += v;
+        s.sumSquares += static_cast<double>(v) * v;
+    }
+}
+
+AxisStats scalarStats(const float* data, std::size_t n) {
+    Sums s{data[0], data[0], 0.0, 0.0};
+    scalarSums(data, n, s);
+    return finish(s, n);
+}
+
+#if defined(IMU_SIMD_SSE2)
+// Vector kernels sum in float lanes over short blocks and fold each block into double
+// totals, which keeps the inner loop free of conversions without losing precision
+constexpr std::size_t blockFloats = 512;
+
+// 8 floats per step in two independent accumulator sets
+AxisStats sseStats(const float* data, std::size_t n) {
+    __m128 min0 = _mm_set1_ps(data[0]), min1 = min0;
+    __m128 max0 = min0, max1 = min0;
+    double sum = 0.0, sumSquares = 0.0;
+    alignas(16) float lanes[4];
+
+    std::size_t i = 0;
+    while (i + 8 <= n) {
+        const std::size_t blockEnd = std::min(n & ~std::size_t(7), i + blockFloats);
+        __m128 sum0 = _mm_setzero_ps(), sum1 = sum0, sq0 = sum0, sq1 = sum0;
+        for (; i < blockEnd; i += 8) {
+            const __m128 a = _mm_loadu_ps(data + i);
+            const __m128 b = _mm_loadu_ps(data + i + 4);
+            min0 = _mm_min_ps(min0, a); min1 = _mm_min_ps(min1, b);
+            max0 = _mm_max_ps(max0, a); max1 = _mm_max_ps(max1, b);
+            sum0 = _mm_add_ps(sum0, a); sum1 = _mm_add_ps(sum1, b);
+            sq0 = _mm_add_ps(sq0, _mm_mul_ps(a, a)); sq1 = _mm_add_ps(sq1, _mm_mul_ps(b, b));
+        }
+        _mm_store_ps(lanes, _mm_add_ps(sum0, sum1));
+        sum += (double(lanes[0]) + lanes[1]) + (double(lanes[2]) + lanes[3]);
+        _mm_store_ps(lanes, _mm_add_ps(sq0, sq1));
+        sumSquares += (double(lanes[0]) + lanes[1]) + (double(lanes[2]) + lanes[3]);
+    }
+
+    alignas(16) float mins[4], maxs[4];
+    _mm_store_ps(mins, _mm_min_ps(min0, min1));
+    _mm_store_ps(maxs, _mm_max_ps(max0, max1));
+    Sums s{*std::min_element(mins, mins + 4), *std::max_element(maxs, maxs + 4), sum, sumSquares};
+    scalarSums(data + i, n - i, s);
+    return finish(s, n);
+}
+#endif
+
+#if defined(IMU_SIMD_AVX2)
+__attribute__((target("avx2"))) double horizontalSum(__m256 v) {
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, v);
+    return ((double(lanes[0]) + lanes[1]) + (double(lanes[2]) + lanes[3])) +
+           ((double(lanes[4]) + lanes[5]) + (double(lanes[6]) + lanes[7]));
+}
+
+// Same as sseStats() with 16 floats per step
+__attribute__((target("avx2"))) AxisStats avx2Stats(const float* data, std::size_t n) {
+    __m256 min0 = _mm256_set1_ps(data[0]), min1 = min0;
+    __m256 max0 = min0, max1 = min0;
+    double sum = 0.0, sumSquares = 0.0;
+
+    std::size_t i = 0;
+    while (i + 16 <= n) {
+        const std::size_t blockEnd = std::min(n & ~std::size_t(15), i + blockFloats);
+        __m256 sum0 = _mm256_setzero_ps(), sum1 = sum0, sq0 = sum0, sq1 = sum0;
+        for (; i < blockEnd; i += 16) {
+            const __m256 a = _mm256_loadu_ps(data + i);
+            const __m256 b = _mm256_loadu_ps(data + i + 8);
+            min0 = _mm256_min_ps(min0, a); min1 = _mm256_min_ps(min1, b);
+            max0 = _mm256_max_ps(max0, a); max1 = _mm256_max_ps(max1, b);
+            sum0 = _mm256_add_ps(sum0, a); sum1 = _mm256_add_ps(sum1, b);
+            sq0 = _mm256_add_ps(sq0, _mm256_mul_ps(a, a)); sq1 = _mm256_add_ps(sq1, _mm256_mul_ps(b, b));
+        }
+        sum += horizontalSum(_mm256_add_ps(sum0, sum1));
+        sumSquares += horizontalSum(_mm256_add_ps(sq0, sq1));
+    }
+
+    alignas(32) float mins[8], maxs[8];
+    _mm256_store_ps(mins, _mm256_min_ps(min0, min1));
+    _mm256_store_ps(maxs, _mm256_max_ps(max0, max1));
+    Sums s{*std::min_element(mins, mins + 8), *std::max_element(maxs, maxs + 8), sum, sumSquares};
+    scalarSums(data + i, n - i, s);
+    return finish(s, n);
+}
+#endif
+
+using StatsKernel = AxisStats (*)(const float*, std::size_t);
+
+struct Dispatch {
+    StatsKernel kernel;
+    const char* name;
+};
+
+Dispatch selectKernel() {
+#if defined(IMU_SIMD_AVX2)
+    if (__builtin_cpu_supports("avx2")) {
+        return {avx2Stats, "avx2"};
+    }
+#endif
+#if defined(IMU_SIMD_SSE2)
+    return {sseStats, "sse2"};
+#else
+    return {scalarStats, "scalar"};
+#endif
+}
+
+const Dispatch& dispatch() {
+    static const Dispatch selected = selectKernel();
+    return selected;
+}
+
+} // namespace
+
+AxisStats computeAxisStats(const float* data, std::size_t n) {
+    if (n == 0) {
+        return AxisStats{};
+    }
+    return dispatch().kernel(data, n);
+}
+
+const char* axisStatsKernel() {
+    return dispatch().name;
+}
+
+std::vector<AxisStatsKernel> axisStatsKernels() {
+    std::vector<AxisStatsKernel> kernels{{"scalar", scalarStats}};
+#if defined(IMU_SIMD_SSE2)
+    kernels.push_back({"sse2", sseStats});
+#endif
+#if defined(IMU_SIMD_AVX2)
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.push_back({"avx2", avx2Stats});
+    }
+#endif
+    return kernels;
+}
@@ -0,0 +1,172 @@
+#include "SpectrumPanel.h"
+
+#include <algorithm>
+
+#include "imgui.h"
+#include "implot.h"
+
+namespace {
+
+const char* sensorNames[recordSensorCount] = {"Gyro", "Accel", "Mag"};
+const char* axisNames[3] = {"X", "Y", "Z"};
+
+} // namespace
+
+SpectrumPanel::SpectrumPanel(int posX, int posY, int width, int height,
+                             DeviceRegistry& registry_ref, SpectrumWorker& worker_ref)
+                            :
+                             m_posX(posX), m_posY(posY), m_width(width), m_height(height), m_open(false),
+                             m_registry(registry_ref), m_worker(worker_ref), m_registry_version(0),
+                             m_device(0), m_sensor(static_cast<int>(RecordSensor::Accel)), m_axis(2),
+                             m_db_min(-80.0f), m_db_max(0.0f), m_source(nullptr), m_uploaded(0)
+{
+    const std::size_t bins = spectrumFftSize / 2 + 1;
+    Image image = GenImageColor(static_cast<int>(spectrumHistory), static_cast<int>(bins), BLACK);
+    m_texture = LoadTextureFromImage(image);
+    UnloadImage(image);
+    SetTextureWrap(m_texture, TEXTURE_WRAP_REPEAT); // Scrolling wraps around the column ring
+
+    m_column.resize(bins);
+    m_row.resize(bins);
+    m_spectrum.resize(bins);
+    m_freqs.resize(bins);
+
+    for (int i = 0; i < 256; ++i) {
+        ImVec4 c = ImPlot::SampleColormap(i / 255.0f, ImPlotColormap_Viridis);
+        m_colormap[i] = Color{static_cast<unsigned char>(c.x * 255), static_cast<unsigned char>(c.y * 255),
+                              static_cast<unsigned char>(c.z * 255), 255};
+    }
+}
+
+SpectrumPanel::~SpectrumPanel() {
+    UnloadTexture(m_texture);
+}
+
+// Copies the device list only when the registry's version moves, like FramePacer
+void SpectrumPanel::SyncDevices() {
+    const std::uint64_t version = m_registry.version();
+    if (version != m_registry_version) {
+        m_registry_version = version;
+        m_devices = m_registry.devices();
+    }
+}
+
+void SpectrumPanel::Select(const Spectrogram* source) {
+    if (source == m_source) {
+        return;
+    }
+    m_source = source;
+    m_uploaded = 0;
+    std::fill(m_column.begin(), m_column.end(), BLACK);
+    for (std::size_t col = 0; col < spectrumHistory; ++col) {
+        UpdateTextureRec(m_texture, Rectangle{static_cast<float>(col), 0.0f, 1.0f, static_cast<float>(m_column.size())},
+                         m_column.data());
+    }
+    if (source) {
+        for (std::size_t k = 0; k < m_freqs.size(); ++k) {
+            m_freqs[k] = static_cast<float>(k) * source->sampleRate() / spectrumFftSize;
+        }
+    }
+}
+
+// High frequencies at the top of the texture
+void SpectrumPanel::RecolorColumn(const std::vector<float>& row) {
+    const float scale = 255.0f / std::max(m_db_max - m_db_min, 1.0f);
+    const std::size_t bins = row.size();
+    for (std::size_t k = 0; k < bins; ++k) {
+        int level = static_cast<int>((row[k] - m_db_min) * scale);
+        m_column[bins - 1 - k] = m_colormap[std::clamp(level, 0, 255)];
+    }
+}
+
+// Copies the frames published since the last call into their texture columns
+void SpectrumPanel::Upload() {
+    const std::uint64_t frames = m_source->frames();
+    if (frames == m_uploaded) {
+        return;
+    }
+    const std::uint64_t first = std::max<std::uint64_t>(m_uploaded, frames > spectrumHistory ? frames - spectrumHistory : 0);
+    for (std::uint64_t frame = first; frame < frames; ++frame) {
+        if (!m_source->readFrame(frame, m_row.data())) {
+            continue;
+        }
+        RecolorColumn(m_row);
+        const float col = static_cast<float>(frame % spectrumHistory);
+        UpdateTextureRec(m_texture, Rectangle{col, 0.0f, 1.0f, static_cast<float>(m_column.size())}, m_column.data());
+    }
+    m_source->readFrame(frames - 1, m_spectrum.data());
+    m_uploaded = frames;
+}
+
+void SpectrumPanel::Draw() {
+    if (!m_open) {
+        return;
+    }
+
+    ImGui::SetNextWindowPos(ImVec2(m_posX, m_posY), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(m_width, m_height), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Spectrum (F5)", &m_open)) {
+        ImGui::End();
+        return;
+    }
+
+    // Source selection
+    SyncDevices();
+    m_device = std::clamp(m_device, 0, std::max(static_cast<int>(m_devices.size()) - 1, 0));
+    ImGui::SetNextItemWidth(140.0f);
+    if (ImGui::BeginCombo("##SpectrumDevice", m_devices.empty() ? "" : m_devices[m_device]->id.c_str())) {
+        for (int i = 0; i < static_cast<int>(m_devices.size()); ++i) {
+            if (ImGui::Selectable(m_devices[i]->id.c_str(), i == m_device)) m_device = i;
+        }
+        ImGui::EndCombo();
+    }
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(80.0f);
+    ImGui::Combo("##SpectrumSensor", &m_sensor, sensorNames, recordSensorCount);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(50.0f);
+    ImGui::Combo("##SpectrumAxis", &m_axis, axisNames, 3);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(160.0f);
+    if (ImGui::DragFloatRange2("dB", &m_db_min, &m_db_max, 0.5f, -160.0f, 60.0f, "%.0f", "%.0f")) {
+        m_uploaded = 0; // Recolor the history with the new range
+    }
+
+    Select(m_devices.empty() ? nullptr
+                             : m_worker.spectrogram(*m_devices[m_device], static_cast<RecordSensor>(m_sensor), m_axis));
+    if (!m_source || m_source->frames() == 0) {
+        ImGui::TextDisabled("Waiting for %zu samples...", spectrumFftSize);
+        ImGui::End();
+        return;
+    }
+    Upload();
+
+    const float nyquist = m_source->sampleRate() * 0.5f;
+    const double span = static_cast<double>(spectrumHistory * m_source->hop()) / m_source->sampleRate();
+    const float plot_height = (ImGui::GetContentRegionAvail().y - ImGui::GetStyle().ItemSpacing.y) * 0.5f;
+
+    if (ImPlot::BeginPlot("##Spectrum", ImVec2(-1, plot_height))) {
+        ImPlot::SetupAxes("Frequency (Hz)", "dB");
+        ImPlot::SetupAxisLimits(ImAxis_X1, 0, nyquist, ImGuiCond_Always);
+        ImPlot::SetupAxisLimits(ImAxis_Y1, m_db_min, m_db_max + 10.0f, ImGuiCond_Once);
+        ImPlot::PlotLine(axisNames[m_axis], m_freqs.data(), m_spectrum.data(), static_cast<int>(m_spectrum.size()));
+        ImPlot::EndPlot();
+    }
+
+    if (ImPlot::BeginPlot("##Spectrogram", ImVec2(ImGui::GetContentRegionAvail().x - 70.0f, plot_height),
+                          ImPlotFlags_NoLegend)) {
+        ImPlot::SetupAxes("Time (s)", "Frequency (Hz)");
+        ImPlot::SetupAxisLimits(ImAxis_X1, -span, 0, ImGuiCond_Always);
+        ImPlot::SetupAxisLimits(ImAxis_Y1, 0, nyquist, ImGuiCond_Always);
+        // The oldest column sits right after the newest one in the ring
+        const float u = static_cast<float>(m_uploaded % spectrumHistory) / spectrumHistory;
+        ImPlot::PlotImage("##SpectrogramImage", ImTextureID(m_texture.id), ImPlotPoint(-span, 0), ImPlotPoint(0, nyquist),
+                          ImVec2(u, 0.0f), ImVec2(u + 1.0f, 1.0f));
+        ImPlot::EndPlot();
+    }
+    ImGui::SameLine();
+    ImPlot::ColormapScale("##SpectrogramScale", m_db_min, m_db_max, ImVec2(60.0f, plot_height), "%g dB", 0,
+                          ImPlotColormap_Viridis);
+
+    ImGui::End();
+}
@@ -0,0 +1,106 @@
+#include "SpectrumWorker.h"
+
+#include <chrono>
+
+namespace {
+
+constexpr auto idleSleep = std::chrono::milliseconds(5);
+
+} // namespace
+
+SpectrumWorker::SpectrumWorker(DeviceRegistry& registry_ref, TaskPool& pool_ref, std::size_t size, std::size_t frames)
+    : registry(registry_ref), pool(pool_ref), fftSize(size), hop(size / 4), history(frames),
+      worker(&SpectrumWorker::workerLoop, this)
+{}
+
+SpectrumWorker::~SpectrumWorker() {
+    running.store(false, std::memory_order_relaxed);
+    worker.join();
+}
+
+const Spectrogram* SpectrumWorker::spectrogram(const DeviceBuffers& device, RecordSensor sensor, int axis) const {
+    std::lock_guard<std::mutex> lock(statesMtx);
+    for (auto& state : states) {
+        if (state->device == &device) {
+            return state->streams[static_cast<int>(sensor)].spectrograms[axis].get();
+        }
+    }
+    return nullptr;
+}
+
+void SpectrumWorker::syncDevices() {
+    std::uint64_t version = registry.version();
+    if (version == registryVersion) {
+        return;
+    }
+    registryVersion = version;
+
+    std::vector<DeviceBuffers*> devices = registry.devices();
+    for (std::size_t i = states.size(); i < devices.size(); ++i) {
+        DeviceBuffers& device = *devices[i];
+        auto state = std::make_unique<DeviceState>();
+        state->device = &device;
+
+        ThreadSafeRingBuffer<>* buffers[recordSensorCount] = {&device.gyro, &device.accel, &device.mag};
+        const int rates[recordSensorCount] = {device.config.gyroFreq, device.config.accelFreq, device.config.magFreq};
+        for (std::size_t s = 0; s < recordSensorCount; ++s) {
+            Stream& stream = state->streams[s];
+            stream.buffer = buffers[s];
+            stream.fft = std::make_unique<Fft>(fftSize);
+            stream.frame.resize(fftSize);
+            for (int axis = 0; axis < 3; ++axis) {
+                stream.window[axis].assign(fftSize, 0.0f);
+                stream.spectrograms[axis] = std::make_unique<Spectrogram>(stream.fft->bins(), history,
+                                                                          static_cast<float>(rates[s]), hop);
+            }
+            streams.push_back(&stream);
+        }
+
+        std::lock_guard<std::mutex> lock(statesMtx);
+        states.push_back(std::move(state));
+    }
+}
+
+void SpectrumWorker::workerLoop() {
+    while (running.load(std::memory_order_relaxed)) {
+        syncDevices();
+        std::atomic<bool> busy{false};
+        pool.parallelFor(streams.size(), [&](std::size_t i) {
+            if (process(*streams[i])) {
+                busy.store(true, std::memory_order_relaxed);
+            }
+        });
+        if (!busy.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(idleSleep);
+        }
+    }
+}
+
+bool SpectrumWorker::process(Stream& stream) {
+    float (*axes)[readChunk] = stream.axes;
+    std::vector<float>& frame = stream.frame;
+    const std::size_t count = stream.buffer->readSince(stream.cursor, readChunk, stream.t, axes[0], axes[1], axes[2]);
+    for (std::size_t i = 0; i < count; ++i) {
+        for (int axis = 0; axis < 3; ++axis) {
+            stream.window[axis][stream.windowPos] = axes[axis][i];
+        }
+        stream.windowPos = (stream.windowPos + 1) % fftSize;
+        stream.filled = std::min(stream.filled + 1, fftSize);
+
+        if (++stream.sinceFrame < hop || stream.filled < fftSize) {
+            continue;
+        }
+        stream.sinceFrame = 0;
+        for (int axis = 0; axis < 3; ++axis) {
+            // Oldest sample first
+            const std::vector<float>& window = stream.window[axis];
+            std::copy(window.begin() + stream.windowPos, window.end(), frame.begin());
+            std::copy(window.begin(), window.begin() + stream.windowPos, frame.begin() + (fftSize - stream.windowPos));
+
+            Spectrogram& spectrogram = *stream.spectrograms[axis];
+            stream.fft->amplitudeDb(frame.data(), spectrogram.beginFrame());
+            spectrogram.publish();
+        }
+    }
+    return count > 0;
+}
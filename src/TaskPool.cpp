@@ -0,0 +1,107 @@
+#include "TaskPool.h"
+
+#include <iostream>
+
+namespace {
+
+// Pool and deque of the worker running on this thread, if any
+thread_local const TaskPool* currentPool = nullptr;
+thread_local std::size_t currentQueue = 0;
+
+} // namespace
+
+TaskPool::TaskPool(std::size_t threads) {
+    if (threads == 0) {
+        const unsigned cores = std::thread::hardware_concurrency();
+        threads = cores > 1 ? cores - 1 : 1;
+    }
+    for (std::size_t i = 0; i < threads; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (std::size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(&TaskPool::workerLoop, this, i);
+    }
+    std::cout << "[Pool] " << threads << " worker threads" << std::endl;
+}
+
+TaskPool::~TaskPool() {
+    stopping.store(true);
+    {
+        std::lock_guard<std::mutex> lock(sleepMtx);
+    }
+    wakeup.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void TaskPool::submit(Task task) {
+    const std::size_t index = currentPool == this
+        ? currentQueue
+        : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    {
+        Queue& queue = *queues[index];
+        std::lock_guard<std::mutex> lock(queue.mtx);
+        queue.tasks.push_back(std::move(task));
+    }
+    // Pairs with the sleeping/queued check in workerLoop(), both sequentially consistent
+    queued.fetch_add(1);
+    if (sleeping.load() > 0) {
+        {
+            std::lock_guard<std::mutex> lock(sleepMtx);
+        }
+        wakeup.notify_one();
+    }
+}
+
+bool TaskPool::take(Queue& queue, bool newest, Task& task) {
+    std::lock_guard<std::mutex> lock(queue.mtx);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    if (newest) {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+    } else {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+    }
+    return true;
+}
+
+bool TaskPool::runOne() {
+    if (queued.load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+    const bool worker = currentPool == this;
+    const std::size_t own = worker ? currentQueue : nextQueue.load(std::memory_order_relaxed) % queues.size();
+
+    Task task;
+    bool found = worker && take(*queues[own], true, task);
+    for (std::size_t k = worker ? 1 : 0; !found && k < queues.size(); ++k) {
+        found = take(*queues[(own + k) % queues.size()], false, task);
+    }
+    if (!found) {
+        return false;
+    }
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    task();
+    return true;
+}
+
+void TaskPool::workerLoop(std::size_t index) {
+    currentPool = this;
+    currentQueue = index;
+    while (true) {
+        if (runOne()) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMtx);
+        sleeping.fetch_add(1);
+        wakeup.wait(lock, [this]() { return queued.load() > 0 || stopping.load(); });
+        sleeping.fetch_sub(1);
+        if (stopping.load() && queued.load() == 0) {
+            return;
+        }
+    }
+}
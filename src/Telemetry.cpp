@@ -0,0 +1,68 @@
+#include "Telemetry.h"
+
+#if defined(IMU_ENABLE_TELEMETRY)
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+void writeCounter(std::ostream& out, const char* name, const Counter& counter) {
+    out << "  \"" << name << "\": " << counter.total() << ",\n";
+}
+
+void writeHistogram(std::ostream& out, const char* name, const LatencyHistogram& histogram, bool last = false) {
+    out << "  \"" << name << "\": {\"count\": " << histogram.count()
+        << ", \"mean_ns\": " << static_cast<std::uint64_t>(histogram.meanNs())
+        << ", \"p50_ns\": " << histogram.percentileNs(50.0)
+        << ", \"p99_ns\": " << histogram.percentileNs(99.0)
+        << ", \"p999_ns\": " << histogram.percentileNs(99.9)
+        << ", \"max_ns\": " << histogram.maxNs() << "}" << (last ? "\n" : ",\n");
+}
+
+} // namespace
+
+Telemetry& telemetry() {
+    static Telemetry instance;
+    return instance;
+}
+
+void Telemetry::dump(std::ostream& out) const {
+    out << "{\n";
+    writeCounter(out, "frames_received", framesReceived);
+    writeCounter(out, "bytes_received", bytesReceived);
+    writeCounter(out, "parse_errors", parseErrors);
+    writeCounter(out, "samples_ingested", samplesIngested);
+    writeCounter(out, "samples_over_budget", samplesOverBudget);
+    writeCounter(out, "samples_dropped", samplesDropped);
+    writeCounter(out, "samples_decimated", samplesDecimated);
+    writeCounter(out, "read_pauses", readPauses);
+    writeCounter(out, "sessions_refused", sessionsRefused);
+    writeCounter(out, "triggers_fired", triggersFired);
+    writeCounter(out, "captures_missed", capturesMissed);
+    writeCounter(out, "read_retries", readRetries);
+    writeCounter(out, "points_plotted", pointsPlotted);
+    writeCounter(out, "plots_reused", plotsReused);
+    writeCounter(out, "idle_frames", idleFrames);
+    writeCounter(out, "vertex_bytes_uploaded", vertexBytesUploaded);
+    writeHistogram(out, "parse_time", parseTime);
+    writeHistogram(out, "append_time", appendTime);
+    writeHistogram(out, "trigger_time", triggerTime);
+    writeHistogram(out, "receive_to_plot", receiveToPlot);
+    writeHistogram(out, "frame_cpu", frameCpu);
+    writeHistogram(out, "frame_swap", frameSwap);
+    writeHistogram(out, "frame_interval", frameInterval, true);
+    out << "}\n";
+}
+
+bool Telemetry::dumpToFile(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "[Telemetry] Cannot write '" << path << "'" << std::endl;
+        return false;
+    }
+    dump(file);
+    std::cout << "[Telemetry] Written to " << path << std::endl;
+    return true;
+}
+
+#endif
@@ -0,0 +1,96 @@
+#include "TelemetryPanel.h"
+
+#if defined(IMU_ENABLE_TELEMETRY)
+#include "imgui.h"
+
+TelemetryPanel::TelemetryPanel(int posX, int posY, int width, int height)
+                              :
+                               m_posX(posX), m_posY(posY), m_width(width), m_height(height), m_open(false),
+                               m_rate_time(0.0), m_last_samples(0), m_last_frames(0), m_last_bytes(0),
+                               m_last_points(0), m_samples_rate(0.0f), m_frames_rate(0.0f),
+                               m_bytes_rate(0.0f), m_points_rate(0.0f)
+{}
+
+void TelemetryPanel::UpdateRates() {
+    const double now = ImGui::GetTime();
+    const double elapsed = now - m_rate_time;
+    if (elapsed < 1.0) {
+        return;
+    }
+    const Telemetry& t = telemetry();
+    std::uint64_t samples = t.samplesIngested.total();
+    std::uint64_t frames = t.framesReceived.total();
+    std::uint64_t bytes = t.bytesReceived.total();
+    std::uint64_t points = t.pointsPlotted.total();
+    m_samples_rate = static_cast<float>((samples - m_last_samples) / elapsed);
+    m_frames_rate = static_cast<float>((frames - m_last_frames) / elapsed);
+    m_bytes_rate = static_cast<float>((bytes - m_last_bytes) / elapsed);
+    m_points_rate = static_cast<float>((points - m_last_points) / elapsed);
+    m_last_samples = samples;
+    m_last_frames = frames;
+    m_last_bytes = bytes;
+    m_last_points = points;
+    m_rate_time = now;
+}
+
+void TelemetryPanel::HistogramRow(const char* name, const LatencyHistogram& histogram) {
+    ImGui::TableNextRow();
+    ImGui::TableNextColumn(); ImGui::TextUnformatted(name);
+    ImGui::TableNextColumn(); ImGui::Text("%.1f", histogram.percentileNs(50.0) / 1000.0);
+    ImGui::TableNextColumn(); ImGui::Text("%.1f", histogram.percentileNs(99.0) / 1000.0);
+    ImGui::TableNextColumn(); ImGui::Text("%.1f", histogram.maxNs() / 1000.0);
+    ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)histogram.count());
+}
+
+void TelemetryPanel::Draw() {
+    // Keep the rates current even while hidden so they are right when it opens
+    UpdateRates();
+    if (!m_open) {
+        return;
+    }
+
+    ImGui::SetNextWindowPos(ImVec2(m_posX, m_posY), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(m_width, m_height), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Telemetry (F3)", &m_open)) {
+        ImGui::End();
+        return;
+    }
+
+    const Telemetry& t = telemetry();
+    ImGui::Text("Ingest:  %.0f samples/s, %.0f frames/s, %.1f KiB/s",
+                m_samples_rate, m_frames_rate, m_bytes_rate / 1024.0f);
+    ImGui::Text("Plotted: %.0f points/s", m_points_rate);
+    ImGui::Text("Plots reused: %llu, idle frames: %llu",
+                (unsigned long long)t.plotsReused.total(), (unsigned long long)t.idleFrames.total());
+    ImGui::Text("Parse errors: %llu, read retries: %llu",
+                (unsigned long long)t.parseErrors.total(), (unsigned long long)t.readRetries.total());
+    ImGui::Text("Overload: %llu over budget, %llu dropped, %llu decimated, %llu pauses, %llu refused",
+                (unsigned long long)t.samplesOverBudget.total(), (unsigned long long)t.samplesDropped.total(),
+                (unsigned long long)t.samplesDecimated.total(), (unsigned long long)t.readPauses.total(),
+                (unsigned long long)t.sessionsRefused.total());
+    ImGui::Text("Triggers: %llu fired, %llu captures missed",
+                (unsigned long long)t.triggersFired.total(), (unsigned long long)t.capturesMissed.total());
+
+    if (ImGui::BeginTable("##Latency", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("us");
+        ImGui::TableSetupColumn("p50");
+        ImGui::TableSetupColumn("p99");
+        ImGui::TableSetupColumn("max");
+        ImGui::TableSetupColumn("count");
+        ImGui::TableHeadersRow();
+        HistogramRow("Parse", t.parseTime);
+        HistogramRow("Append", t.appendTime);
+        HistogramRow("Trigger", t.triggerTime);
+        HistogramRow("Receive to plot", t.receiveToPlot);
+        HistogramRow("Frame CPU", t.frameCpu);
+        HistogramRow("Frame swap", t.frameSwap);
+        HistogramRow("Frame interval", t.frameInterval);
+        ImGui::EndTable();
+    }
+
+    if (ImGui::Button("Save to imu-telemetry.json")) {
+        t.dumpToFile("imu-telemetry.json");
+    }
+    ImGui::End();
+}
+#endif
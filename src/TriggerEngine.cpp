@@ -0,0 +1,328 @@
+#include "TriggerEngine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+const ThreadSafeRingBuffer<>& bufferOf(const DeviceBuffers& device, RecordSensor sensor) {
+    switch (sensor) {
+        case RecordSensor::Gyro: return device.gyro;
+        case RecordSensor::Accel: return device.accel;
+        case RecordSensor::Mag: return device.mag;
+    }
+    return device.gyro;
+}
+
+const SensorSamples& samplesOf(const ImuBatch& batch, RecordSensor sensor) {
+    switch (sensor) {
+        case RecordSensor::Gyro: return batch.gyro;
+        case RecordSensor::Accel: return batch.accel;
+        case RecordSensor::Mag: return batch.mag;
+    }
+    return batch.gyro;
+}
+
+bool sameCondition(const TriggerCondition& a, const TriggerCondition& b) {
+    return a.sensor == b.sensor && a.kind == b.kind && a.axis == b.axis &&
+           a.threshold == b.threshold && a.enabled == b.enabled;
+}
+
+// Samples a window of the given length holds at 'hz', with room for late batches
+std::size_t windowSamples(double seconds, int hz, std::size_t bufferSize) {
+    const std::size_t wanted = static_cast<std::size_t>(std::ceil(seconds * hz * 1.25)) + 256;
+    return std::min(wanted, bufferSize);
+}
+
+} // namespace
+
+TriggerEngine::TriggerEngine(const AppConfig& config, std::size_t slots)
+    : pre(config.triggerPreSeconds), post(config.triggerPostSeconds)
+{
+    // The window is copied out of the ring buffers when the post time has passed,
+    // so it has to fit in them with some margin
+    const double limit = 0.8 * config.bufferSeconds;
+    if (pre + post > limit) {
+        const double scale = limit / (pre + post);
+        pre *= scale;
+        post *= scale;
+        std::cerr << "[Trigger] Capture window cut to " << pre << " s + " << post
+                  << " s to fit the " << config.bufferSeconds << " s buffers" << std::endl;
+    }
+
+    const std::size_t sizes[recordSensorCount] = {
+        windowSamples(pre + post, config.gyroFreq, config.gyroBufferSize()),
+        windowSamples(pre + post, config.accelFreq, config.accelBufferSize()),
+        windowSamples(pre + post, config.magFreq, config.magBufferSize()),
+    };
+    pool.reserve(slots);
+    for (std::size_t i = 0; i < slots; ++i) {
+        auto slot = std::make_unique<Slot>();
+        for (std::size_t s = 0; s < recordSensorCount; ++s) {
+            Window& window = slot->sensors[s];
+            window.t.resize(sizes[s]);
+            window.x.resize(sizes[s]);
+            window.y.resize(sizes[s]);
+            window.z.resize(sizes[s]);
+        }
+        pool.push_back(std::move(slot));
+    }
+    std::cout << "[Trigger] " << slots << " capture slots, " << triggerKernel() << " kernels" << std::endl;
+}
+
+std::shared_ptr<TriggerEngine::Stream> TriggerEngine::openStream(DeviceBuffers& device) {
+    return std::make_shared<Stream>(*this, device);
+}
+
+void TriggerEngine::setConditions(const std::vector<TriggerCondition>& conditions) {
+    std::lock_guard<std::mutex> lock(conditionsMtx);
+    conditionList.assign(conditions.begin(),
+                         conditions.begin() + std::min(conditions.size(), maxTriggerConditions));
+    conditionsVersion.fetch_add(1, std::memory_order_release);
+}
+
+std::vector<TriggerCondition> TriggerEngine::conditions() const {
+    std::lock_guard<std::mutex> lock(conditionsMtx);
+    return conditionList;
+}
+
+// Takes the next slot round-robin, so the oldest capture is the one reused.
+// Slots still being filled by another stream are skipped.
+TriggerEngine::Slot* TriggerEngine::claim() {
+    for (std::size_t attempt = 0; attempt < pool.size(); ++attempt) {
+        Slot& slot = *pool[nextSlot.fetch_add(1, std::memory_order_relaxed) % pool.size()];
+        if (slot.busy.exchange(true, std::memory_order_acquire)) {
+            continue;
+        }
+        // Odd version: readers ignore the slot until fill() is done
+        slot.version.store(slot.version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.event.sequence = sequence.fetch_add(1, std::memory_order_relaxed) + 1;
+        for (Window& window : slot.sensors) {
+            window.count = 0;
+        }
+        return &slot;
+    }
+    missedCount.fetch_add(1, std::memory_order_relaxed);
+    IMU_TELEMETRY(telemetry().capturesMissed.add());
+    return nullptr;
+}
+
+// Copies the newest samples of each sensor and keeps those inside the window
+void TriggerEngine::fill(Slot& slot, const DeviceBuffers& device) {
+    const double from = slot.event.time - pre;
+    const double to = slot.event.time + post;
+    for (std::size_t s = 0; s < recordSensorCount; ++s) {
+        Window& window = slot.sensors[s];
+        const auto& buffer = bufferOf(device, static_cast<RecordSensor>(s));
+        const std::size_t n = std::min(window.t.size(), buffer.size());
+        if (n == 0 || !buffer.readRecent(n, window.t.data(), window.x.data(), window.y.data(), window.z.data())) {
+            window.count = 0;
+            continue;
+        }
+        const auto tBegin = window.t.begin();
+        const std::size_t first = std::lower_bound(tBegin, tBegin + n, from) - tBegin;
+        const std::size_t last = std::upper_bound(tBegin + first, tBegin + n, to) - tBegin;
+        std::copy(window.t.begin() + first, window.t.begin() + last, window.t.begin());
+        std::copy(window.x.begin() + first, window.x.begin() + last, window.x.begin());
+        std::copy(window.y.begin() + first, window.y.begin() + last, window.y.begin());
+        std::copy(window.z.begin() + first, window.z.begin() + last, window.z.begin());
+        window.count = last - first;
+    }
+    slot.version.store(slot.version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    slot.busy.store(false, std::memory_order_release);
+}
+
+bool TriggerEngine::readEvent(const Slot& slot, Event& out) const {
+    const std::uint64_t version = slot.version.load(std::memory_order_acquire);
+    if (version == 0 || (version & 1)) {
+        return false;
+    }
+    out = slot.event;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.version.load(std::memory_order_relaxed) == version;
+}
+
+void TriggerEngine::events(std::vector<Event>& out) const {
+    out.clear();
+    Event event;
+    for (std::size_t i = 0; i < pool.size(); ++i) {
+        if (readEvent(*pool[i], event)) {
+            event.slot = i;
+            out.push_back(event);
+        }
+    }
+    std::sort(out.begin(), out.end(), [](const Event& a, const Event& b) { return a.sequence > b.sequence; });
+}
+
+void TriggerEngine::prepareCapture(Capture& out) const {
+    if (pool.empty()) {
+        return;
+    }
+    for (std::size_t s = 0; s < recordSensorCount; ++s) {
+        const std::size_t size = pool.front()->sensors[s].t.size();
+        Window& window = out.sensors[s];
+        window.t.resize(std::max(window.t.size(), size));
+        window.x.resize(std::max(window.x.size(), size));
+        window.y.resize(std::max(window.y.size(), size));
+        window.z.resize(std::max(window.z.size(), size));
+    }
+}
+
+bool TriggerEngine::readCapture(const Event& event, Capture& out) const {
+    if (event.slot >= pool.size()) {
+        return false;
+    }
+    const Slot& slot = *pool[event.slot];
+    const std::uint64_t version = slot.version.load(std::memory_order_acquire);
+    if (version == 0 || (version & 1) || slot.event.sequence != event.sequence) {
+        return false;
+    }
+    out.event = slot.event;
+    for (std::size_t s = 0; s < recordSensorCount; ++s) {
+        const Window& window = slot.sensors[s];
+        Window& copy = out.sensors[s];
+        const std::size_t n = std::min(window.count, window.t.size());
+        if (copy.t.size() < n) {
+            copy.t.resize(n);
+            copy.x.resize(n);
+            copy.y.resize(n);
+            copy.z.resize(n);
+        }
+        std::copy(window.t.begin(), window.t.begin() + n, copy.t.begin());
+        std::copy(window.x.begin(), window.x.begin() + n, copy.x.begin());
+        std::copy(window.y.begin(), window.y.begin() + n, copy.y.begin());
+        std::copy(window.z.begin(), window.z.begin() + n, copy.z.begin());
+        copy.count = n;
+    }
+    out.event.slot = event.slot;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.version.load(std::memory_order_relaxed) == version;
+}
+
+TriggerEngine::Stream::Stream(TriggerEngine& engine, DeviceBuffers& device) : engine(engine), device(device) {
+    syncConditions();
+}
+
+TriggerEngine::Stream::~Stream() {
+    for (std::size_t i = 0; i < pendingCount; ++i) {
+        engine.fill(*pending[i].slot, device);
+    }
+}
+
+void TriggerEngine::Stream::process(const ImuBatch& batch) {
+    IMU_TELEMETRY(ScopedTimer timer(telemetry().triggerTime));
+    syncConditions();
+    for (std::size_t s = 0; s < recordSensorCount; ++s) {
+        const SensorSamples& samples = samplesOf(batch, static_cast<RecordSensor>(s));
+        scan(static_cast<RecordSensor>(s), samples.t.data(), samples.x.data(), samples.y.data(), samples.z.data(),
+             samples.count);
+    }
+    completeCaptures();
+}
+
+void TriggerEngine::Stream::process(RecordSensor sensor, const double* t, const float* x, const float* y,
+                                    const float* z, std::size_t n) {
+    IMU_TELEMETRY(ScopedTimer timer(telemetry().triggerTime));
+    syncConditions();
+    scan(sensor, t, x, y, z, n);
+}
+
+// Checks the conditions on 'sensor' against its newly appended samples
+void TriggerEngine::Stream::scan(RecordSensor sensor, const double* t, const float* x, const float* y,
+                                 const float* z, std::size_t n) {
+    if (n == 0) {
+        return;
+    }
+    newest[static_cast<std::size_t>(sensor)] = t[n - 1];
+    for (std::size_t i = 0; i < conditionCount; ++i) {
+        if (conditions[i].enabled && conditions[i].sensor == sensor) {
+            check(i, t, x, y, z, n);
+        }
+    }
+}
+
+// Copies the conditions after the UI changed them. Conditions that stayed the same
+// keep their state, so editing one doesn't re-fire the others.
+void TriggerEngine::Stream::syncConditions() {
+    const std::uint64_t version = engine.conditionsVersion.load(std::memory_order_acquire);
+    if (version == conditionsVersion) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(engine.conditionsMtx);
+    const std::size_t count = engine.conditionList.size();
+    for (std::size_t i = 0; i < count; ++i) {
+        const TriggerCondition& condition = engine.conditionList[i];
+        if (i >= conditionCount || !sameCondition(conditions[i], condition)) {
+            conditions[i] = condition;
+            states[i] = ConditionState{};
+        }
+    }
+    conditionCount = count;
+    conditionsVersion = version;
+}
+
+// Runs the edge kernel over the batch. After an edge inside the hold-off time the
+// search goes on from the next sample, where the condition is known to hold.
+void TriggerEngine::Stream::check(std::size_t index, const double* t, const float* ax, const float* ay,
+                                  const float* az, std::size_t n) {
+    const TriggerCondition& condition = conditions[index];
+    ConditionState& state = states[index];
+    const bool magnitude = condition.kind == TriggerKind::Magnitude;
+    const float* x = magnitude ? ax : condition.axis == 1 ? ay : condition.axis == 2 ? az : ax;
+    const float* y = ay;
+    const float* z = az;
+
+    bool previous = state.holds;
+    std::size_t start = 0;
+    while (start < n) {
+        const std::size_t i = start + findTriggerEdge(condition.kind, x + start, y + start, z + start,
+                                                      n - start, condition.threshold, previous);
+        if (i >= n) {
+            break;
+        }
+        if (t[i] >= state.holdUntil) {
+            const float value = magnitude ? std::sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]) : x[i];
+            fire(index, t[i], value);
+        }
+        previous = true;
+        start = i + 1;
+    }
+    state.holds = triggerHolds(condition.kind, x[n - 1], y[n - 1], z[n - 1], condition.threshold);
+}
+
+void TriggerEngine::Stream::fire(std::size_t index, double time, float value) {
+    IMU_TELEMETRY(telemetry().triggersFired.add());
+    const TriggerCondition& condition = conditions[index];
+    states[index].holdUntil = time + engine.post;
+
+    // Conditions edited while captures were pending can leave no room, finish the oldest early
+    if (pendingCount == pending.size()) {
+        engine.fill(*pending[0].slot, device);
+        std::copy(pending.begin() + 1, pending.end(), pending.begin());
+        --pendingCount;
+    }
+    Slot* slot = engine.claim();
+    if (!slot) {
+        return;
+    }
+    slot->event.device = &device;
+    slot->event.condition = condition;
+    slot->event.time = time;
+    slot->event.value = value;
+    pending[pendingCount++] = {slot, condition.sensor, time + engine.post};
+}
+
+void TriggerEngine::Stream::completeCaptures() {
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < pendingCount; ++i) {
+        const Pending& p = pending[i];
+        if (newest[static_cast<std::size_t>(p.sensor)] >= p.until) {
+            engine.fill(*p.slot, device);
+        } else {
+            pending[kept++] = p;
+        }
+    }
+    pendingCount = kept;
+}
@@ -0,0 +1,197 @@
+#include "TriggerKernels.h"
+
+#include <cmath>
+
+// Same dispatch as SimdStats.cpp: SSE2 is baseline on x86-64, AVX2 is picked at runtime
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define IMU_SIMD_SSE2 1
+#if defined(__GNUC__) || defined(__clang__)
+#define IMU_SIMD_AVX2 1
+#endif
+#endif
+
+namespace {
+
+// Handles the tail of the vector kernels too
+template <TriggerKind Kind>
+std::size_t scalarEdge(const float* x, const float* y, const float* z, std::size_t begin, std::size_t n,
+                       float threshold, bool previous) {
+    for (std::size_t i = begin; i < n; ++i) {
+        const bool holds = triggerHolds(Kind, x[i], Kind == TriggerKind::Magnitude ? y[i] : 0.0f,
+                                        Kind == TriggerKind::Magnitude ? z[i] : 0.0f, threshold);
+        if (holds && !previous) {
+            return i;
+        }
+        previous = holds;
+    }
+    return n;
+}
+
+// Lanes where the condition starts to hold: set in 'mask' but not in the lane before,
+// the lane before lane 0 being 'previous'
+inline unsigned edges(unsigned mask, bool previous) {
+    return mask & ~((mask << 1) | (previous ? 1u : 0u));
+}
+
+inline std::size_t lowestBit(unsigned v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<std::size_t>(__builtin_ctz(v));
+#else
+    std::size_t bit = 0;
+    while (!(v & 1u)) { v >>= 1; ++bit; }
+    return bit;
+#endif
+}
+
+#if defined(IMU_SIMD_SSE2)
+template <TriggerKind Kind>
+std::size_t sseEdge(const float* x, const float* y, const float* z, std::size_t n, float threshold, bool previous) {
+    const __m128 limit = _mm_set1_ps(Kind == TriggerKind::Magnitude ? threshold * threshold : threshold);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128 v = _mm_loadu_ps(x + i);
+        __m128 holds;
+        switch (Kind) {
+            case TriggerKind::Threshold: holds = _mm_cmpge_ps(_mm_andnot_ps(signBit, v), limit); break;
+            case TriggerKind::Rising: holds = _mm_cmpge_ps(v, limit); break;
+            case TriggerKind::Falling: holds = _mm_cmple_ps(v, limit); break;
+            case TriggerKind::Magnitude: {
+                const __m128 b = _mm_loadu_ps(y + i);
+                const __m128 c = _mm_loadu_ps(z + i);
+                const __m128 squared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(v, v), _mm_mul_ps(b, b)), _mm_mul_ps(c, c));
+                holds = _mm_cmpge_ps(squared, limit);
+                break;
+            }
+        }
+        const unsigned mask = static_cast<unsigned>(_mm_movemask_ps(holds));
+        const unsigned found = edges(mask, previous);
+        if (found) {
+            return i + lowestBit(found);
+        }
+        previous = (mask & 0x8u) != 0;
+    }
+    return scalarEdge<Kind>(x, y, z, i, n, threshold, previous);
+}
+#endif
+
+#if defined(IMU_SIMD_AVX2)
+// Same as sseEdge() with 8 samples per step
+template <TriggerKind Kind>
+__attribute__((target("avx2"))) std::size_t avx2Edge(const float* x, const float* y, const float* z, std::size_t n,
+                                                      float threshold, bool previous) {
+    const __m256 limit = _mm256_set1_ps(Kind == TriggerKind::Magnitude ? threshold * threshold : threshold);
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256 v = _mm256_loadu_ps(x + i);
+        __m256 holds;
+        switch (Kind) {
+            case TriggerKind::Threshold: holds = _mm256_cmp_ps(_mm256_andnot_ps(signBit, v), limit, _CMP_GE_OQ); break;
+            case TriggerKind::Rising: holds = _mm256_cmp_ps(v, limit, _CMP_GE_OQ); break;
+            case TriggerKind::Falling: holds = _mm256_cmp_ps(v, limit, _CMP_LE_OQ); break;
+            case TriggerKind::Magnitude: {
+                const __m256 b = _mm256_loadu_ps(y + i);
+                const __m256 c = _mm256_loadu_ps(z + i);
+                const __m256 squared = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(v, v), _mm256_mul_ps(b, b)),
+                                                     _mm256_mul_ps(c, c));
+                holds = _mm256_cmp_ps(squared, limit, _CMP_GE_OQ);
+                break;
+            }
+        }
+        const unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(holds));
+        const unsigned found = edges(mask, previous);
+        if (found) {
+            return i + lowestBit(found);
+        }
+        previous = (mask & 0x80u) != 0;
+    }
+    return scalarEdge<Kind>(x, y, z, i, n, threshold, previous);
+}
+#endif
+
+template <TriggerKind Kind>
+std::size_t scalarKernel(const float* x, const float* y, const float* z, std::size_t n, float threshold,
+                         bool previous) {
+    return scalarEdge<Kind>(x, y, z, 0, n, threshold, previous);
+}
+
+const TriggerEdgeKernel scalarKernels{"scalar", {scalarKernel<TriggerKind::Threshold>, scalarKernel<TriggerKind::Rising>,
+                                                 scalarKernel<TriggerKind::Falling>, scalarKernel<TriggerKind::Magnitude>}};
+#if defined(IMU_SIMD_SSE2)
+const TriggerEdgeKernel sseKernels{"sse2", {sseEdge<TriggerKind::Threshold>, sseEdge<TriggerKind::Rising>,
+                                            sseEdge<TriggerKind::Falling>, sseEdge<TriggerKind::Magnitude>}};
+#endif
+#if defined(IMU_SIMD_AVX2)
+const TriggerEdgeKernel avx2Kernels{"avx2", {avx2Edge<TriggerKind::Threshold>, avx2Edge<TriggerKind::Rising>,
+                                             avx2Edge<TriggerKind::Falling>, avx2Edge<TriggerKind::Magnitude>}};
+#endif
+
+// The last of triggerEdgeKernels(), i.e. the widest this machine runs
+TriggerEdgeKernel selectKernels() {
+#if defined(IMU_SIMD_AVX2)
+    if (__builtin_cpu_supports("avx2")) {
+        return avx2Kernels;
+    }
+#endif
+#if defined(IMU_SIMD_SSE2)
+    return sseKernels;
+#else
+    return scalarKernels;
+#endif
+}
+
+const TriggerEdgeKernel& dispatch() {
+    static const TriggerEdgeKernel selected = selectKernels();
+    return selected;
+}
+
+} // namespace
+
+const char* triggerKindName(TriggerKind kind) {
+    switch (kind) {
+        case TriggerKind::Threshold: return "Threshold";
+        case TriggerKind::Rising: return "Rising";
+        case TriggerKind::Falling: return "Falling";
+        case TriggerKind::Magnitude: return "Magnitude";
+    }
+    return "Unknown";
+}
+
+bool triggerHolds(TriggerKind kind, float x, float y, float z, float threshold) {
+    switch (kind) {
+        case TriggerKind::Threshold: return std::fabs(x) >= threshold;
+        case TriggerKind::Rising: return x >= threshold;
+        case TriggerKind::Falling: return x <= threshold;
+        case TriggerKind::Magnitude: return x * x + y * y + z * z >= threshold * threshold;
+    }
+    return false;
+}
+
+std::size_t findTriggerEdge(TriggerKind kind, const float* x, const float* y, const float* z,
+                            std::size_t n, float threshold, bool previous) {
+    if (n == 0) {
+        return 0;
+    }
+    return dispatch().find[static_cast<int>(kind)](x, y, z, n, threshold, previous);
+}
+
+const char* triggerKernel() {
+    return dispatch().name;
+}
+
+std::vector<TriggerEdgeKernel> triggerEdgeKernels() {
+    std::vector<TriggerEdgeKernel> kernels{scalarKernels};
+#if defined(IMU_SIMD_SSE2)
+    kernels.push_back(sseKernels);
+#endif
+#if defined(IMU_SIMD_AVX2)
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.push_back(avx2Kernels);
+    }
+#endif
+    return kernels;
+}
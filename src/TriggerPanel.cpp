@@ -0,0 +1,204 @@
+#include "TriggerPanel.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "imgui.h"
+#include "implot.h"
+
+namespace {
+
+const char* sensorNames[recordSensorCount] = {"Gyro", "Accel", "Mag"};
+const char* axisNames[3] = {"X", "Y", "Z"};
+const char* kindNames[4] = {"Threshold", "Rising", "Falling", "Magnitude"};
+
+} // namespace
+
+TriggerPanel::TriggerPanel(int posX, int posY, int width, int height, TriggerEngine& engine_ref)
+                          :
+                           m_posX(posX), m_posY(posY), m_width(width), m_height(height), m_open(false),
+                           m_engine(engine_ref), m_conditions(engine_ref.conditions()),
+                           m_selected(0), m_has_capture(false),
+                           m_plot_sensor(static_cast<int>(RecordSensor::Accel))
+{
+    // Picking events then copies into the same buffers every time
+    m_engine.prepareCapture(m_capture);
+    std::size_t longest = 0;
+    for (const TriggerEngine::Window& window : m_capture.sensors) {
+        longest = std::max(longest, window.t.size());
+    }
+    m_times.reserve(longest);
+}
+
+// Returns true if a condition was added, removed or edited
+bool TriggerPanel::DrawConditions() {
+    bool changed = false;
+    int remove = -1;
+    const ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit;
+    if (ImGui::BeginTable("##Conditions", 6, flags)) {
+        ImGui::TableSetupColumn("On");
+        ImGui::TableSetupColumn("Sensor");
+        ImGui::TableSetupColumn("Condition");
+        ImGui::TableSetupColumn("Axis");
+        ImGui::TableSetupColumn("Threshold", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("");
+        ImGui::TableHeadersRow();
+
+        for (int i = 0; i < static_cast<int>(m_conditions.size()); ++i) {
+            TriggerCondition& condition = m_conditions[i];
+            ImGui::PushID(i);
+            ImGui::TableNextRow();
+
+            ImGui::TableNextColumn();
+            changed |= ImGui::Checkbox("##On", &condition.enabled);
+
+            ImGui::TableNextColumn();
+            int sensor = static_cast<int>(condition.sensor);
+            ImGui::SetNextItemWidth(80.0f);
+            if (ImGui::Combo("##Sensor", &sensor, sensorNames, recordSensorCount)) {
+                condition.sensor = static_cast<RecordSensor>(sensor);
+                changed = true;
+            }
+
+            ImGui::TableNextColumn();
+            int kind = static_cast<int>(condition.kind);
+            ImGui::SetNextItemWidth(100.0f);
+            if (ImGui::Combo("##Kind", &kind, kindNames, 4)) {
+                condition.kind = static_cast<TriggerKind>(kind);
+                changed = true;
+            }
+
+            ImGui::TableNextColumn();
+            ImGui::BeginDisabled(condition.kind == TriggerKind::Magnitude);
+            ImGui::SetNextItemWidth(50.0f);
+            changed |= ImGui::Combo("##Axis", &condition.axis, axisNames, 3);
+            ImGui::EndDisabled();
+
+            ImGui::TableNextColumn();
+            ImGui::SetNextItemWidth(-1);
+            // Only pushed once editing is done, so dragging doesn't re-arm the streams every frame
+            ImGui::DragFloat("##Threshold", &condition.threshold, 0.05f, 0.0f, 0.0f, "%.3f");
+            changed |= ImGui::IsItemDeactivatedAfterEdit();
+
+            ImGui::TableNextColumn();
+            if (ImGui::SmallButton("x")) {
+                remove = i;
+            }
+            ImGui::PopID();
+        }
+        ImGui::EndTable();
+    }
+
+    if (remove >= 0) {
+        m_conditions.erase(m_conditions.begin() + remove);
+        changed = true;
+    }
+    ImGui::BeginDisabled(m_conditions.size() >= maxTriggerConditions);
+    if (ImGui::Button("Add condition")) {
+        m_conditions.push_back(m_conditions.empty() ? TriggerCondition{} : m_conditions.back());
+        changed = true;
+    }
+    ImGui::EndDisabled();
+    return changed;
+}
+
+void TriggerPanel::Select(const TriggerEngine::Event& event) {
+    m_selected = event.sequence;
+    m_has_capture = m_engine.readCapture(event, m_capture);
+    if (m_has_capture) {
+        m_plot_sensor = static_cast<int>(event.condition.sensor);
+    }
+}
+
+void TriggerPanel::DrawEvents() {
+    m_engine.events(m_events);
+    ImGui::Text("Events (%zu kept)", m_events.size());
+    if (!ImGui::BeginChild("##Events", ImVec2(0, 0), ImGuiChildFlags_Borders)) {
+        ImGui::EndChild();
+        return;
+    }
+    for (const TriggerEngine::Event& event : m_events) {
+        const TriggerCondition& condition = event.condition;
+        char label[160];
+        if (condition.kind == TriggerKind::Magnitude) {
+            std::snprintf(label, sizeof(label), "#%llu  %s  %s %s  t=%.3f s  %.3f",
+                          (unsigned long long)event.sequence, event.device->id.c_str(),
+                          sensorNames[static_cast<int>(condition.sensor)], kindNames[static_cast<int>(condition.kind)],
+                          event.time, event.value);
+        } else {
+            std::snprintf(label, sizeof(label), "#%llu  %s  %s %s %s  t=%.3f s  %.3f",
+                          (unsigned long long)event.sequence, event.device->id.c_str(),
+                          sensorNames[static_cast<int>(condition.sensor)], axisNames[condition.axis],
+                          kindNames[static_cast<int>(condition.kind)], event.time, event.value);
+        }
+        if (ImGui::Selectable(label, event.sequence == m_selected)) {
+            Select(event);
+        }
+    }
+    ImGui::EndChild();
+}
+
+void TriggerPanel::DrawCapture() {
+    if (!m_has_capture) {
+        ImGui::TextDisabled(m_selected ? "Capture was overwritten, pick a newer event" : "Pick an event to show its capture");
+        return;
+    }
+    const TriggerEngine::Event& event = m_capture.event;
+    ImGui::Text("#%llu on '%s' at t = %.3f s", (unsigned long long)event.sequence, event.device->id.c_str(), event.time);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(80.0f);
+    ImGui::Combo("##CaptureSensor", &m_plot_sensor, sensorNames, recordSensorCount);
+
+    const TriggerEngine::Window& window = m_capture.sensors[m_plot_sensor];
+    m_times.resize(window.count);
+    for (std::size_t i = 0; i < window.count; ++i) {
+        m_times[i] = static_cast<float>(window.t[i] - event.time);
+    }
+
+    if (ImPlot::BeginPlot("##Capture", ImVec2(-1, -1))) {
+        ImPlot::SetupAxes("Time from trigger (s)", sensorNames[m_plot_sensor]);
+        ImPlot::SetupAxisLimits(ImAxis_X1, -m_engine.preSeconds(), m_engine.postSeconds(), ImGuiCond_Always);
+        const int count = static_cast<int>(window.count);
+        ImPlot::PlotLine("X", m_times.data(), window.x.data(), count);
+        ImPlot::PlotLine("Y", m_times.data(), window.y.data(), count);
+        ImPlot::PlotLine("Z", m_times.data(), window.z.data(), count);
+        const double trigger = 0.0;
+        ImPlot::PlotInfLines("##Trigger", &trigger, 1);
+        ImPlot::EndPlot();
+    }
+}
+
+void TriggerPanel::Draw() {
+    if (!m_open) {
+        return;
+    }
+
+    ImGui::SetNextWindowPos(ImVec2(m_posX, m_posY), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(m_width, m_height), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Triggers (F6)", &m_open)) {
+        ImGui::End();
+        return;
+    }
+
+    ImGui::Text("Window %.2f s before to %.2f s after, %llu fired, %llu missed",
+                m_engine.preSeconds(), m_engine.postSeconds(),
+                (unsigned long long)m_engine.fired(), (unsigned long long)m_engine.missed());
+    if (DrawConditions()) {
+        m_engine.setConditions(m_conditions);
+    }
+    ImGui::Separator();
+
+    // Event list on the left, the selected capture on the right
+    if (ImGui::BeginTable("##TriggerLayout", 2, ImGuiTableFlags_Resizable, ImGui::GetContentRegionAvail())) {
+        ImGui::TableSetupColumn("Events", ImGuiTableColumnFlags_WidthStretch, 0.4f);
+        ImGui::TableSetupColumn("Capture", ImGuiTableColumnFlags_WidthStretch, 0.6f);
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        DrawEvents();
+        ImGui::TableNextColumn();
+        DrawCapture();
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
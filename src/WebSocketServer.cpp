@@ -0,0 +1,42 @@
+#include <chrono>
+#include <iostream>
+
+#include "WebSocketServer.h"
+#include "WebSocketSession.h"
+
+WebSocketServer::WebSocketServer(net::io_context& ioc, unsigned short port, DeviceRegistry& registry,
+                                 Recorder* recorder, TriggerEngine* triggers)
+    : ioc_(ioc), acceptor_(net::make_strand(ioc), {tcp::v4(), port}), registry_(registry), recorder_(recorder),
+      triggers_(triggers),
+      sessionCount_(std::make_shared<std::atomic<int>>(0)), retryTimer_(acceptor_.get_executor())
+{
+    std::cout << "[Server] WebSocket server started on port " << this->port() << std::endl;
+}
+
+void WebSocketServer::run() {
+    acceptor_.async_accept(net::make_strand(ioc_),
+        [this](beast::error_code ec, tcp::socket socket) {
+            if (ec) {
+                // Typically out of file descriptors, retrying right away would just spin
+                std::cerr << "[Server] Accept failed: " << ec.message() << std::endl;
+                retryTimer_.expires_after(std::chrono::milliseconds(100));
+                retryTimer_.async_wait([this](beast::error_code ec) {
+                    if (!ec) run();
+                });
+                return;
+            }
+
+            const int maxSessions = registry_.config().maxSessions;
+            if (sessionCount_->load(std::memory_order_relaxed) >= maxSessions) {
+                std::cerr << "[Server] Refusing connection - " << maxSessions << " sessions already open" << std::endl;
+                IMU_TELEMETRY(telemetry().sessionsRefused.add());
+                beast::error_code ignored;
+                socket.close(ignored);
+            } else {
+                std::cout << "[Server] New connection attempt" << std::endl;
+                std::make_shared<WebSocketSession>(std::move(socket), registry_, recorder_, triggers_,
+                                                   sessionCount_)->run();
+            }
+            run();  // Keep listening for connections
+        });
+}
@@ -1,72 +1,235 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 
 #include "WebSocketSession.h"
 #include "Config.h"
 
-WebSocketSession::WebSocketSession(net::io_context& ioc, unsigned short port, GyroBuffer& gyroBuffer,
-                                 AccelBuffer& accelBuffer, MagBuffer& magBuffer)
-    : acceptor_(ioc, {tcp::v4(), port}),
-      gyroBuffer_(gyroBuffer), accelBuffer_(accelBuffer), magBuffer_(magBuffer)
+namespace {
+
+// Receive clock, used when a frame carries no device timestamp
+double receiveSeconds() {
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Connections without a path all stream into one device, so clients that reconnect
+// without naming themselves don't each get new buffers
+std::string deviceIdFromTarget(beast::string_view target) {
+    std::string id(target.data(), target.size());
+    id.erase(0, id.find_first_not_of('/'));
+    id = id.substr(0, id.find('?'));
+    if (id.empty()) {
+        id = "default";
+    }
+    return id;
+}
+
+} // namespace
+
+WebSocketSession::WebSocketSession(tcp::socket&& socket, DeviceRegistry& registry, Recorder* recorder,
+                                   TriggerEngine* triggers, std::shared_ptr<std::atomic<int>> sessionCount)
+    : ws_(std::move(socket)), registry_(registry), recorder_(recorder), triggers_(triggers),
+      sessionCount_(std::move(sessionCount)), policy_(registry.config().overloadPolicy),
+      budget_(registry.config().ingestRate(), registry.config().ingestRate() * ingestBurstSeconds),
+      pauseTimer_(ws_.get_executor())
 {
-    std::cout << "[Server] WebSocket server started on port " << port << std::endl;
-    run();
+    sessionCount_->fetch_add(1, std::memory_order_relaxed);
+}
+
+WebSocketSession::~WebSocketSession() {
+    sessionCount_->fetch_sub(1, std::memory_order_relaxed);
+    if (recording_) {
+        recording_->close();
+    }
+    if (device_) {
+        std::cout << "[Server] Device '" << device_->id << "' disconnected" << std::endl;
+        registry_.disconnect(*device_);
+    }
 }
 
 void WebSocketSession::run() {
-    acceptor_.async_accept(
-        [this](beast::error_code ec, tcp::socket socket) {
-            if (!ec) handleConnection(std::move(socket));
-            run();  // Keep listening for connections
-        });
+    // Read the upgrade request ourselves so the device ID can be taken from its target
+    net::dispatch(ws_.get_executor(), [self = shared_from_this()]() {
+        http::async_read(self->ws_.next_layer(), self->buffer_, self->request_,
+            [self](beast::error_code ec, size_t) { self->onRequest(ec); });
+    });
 }
 
-void WebSocketSession::handleConnection(tcp::socket socket) {
-    std::cout << "[Server] New connection attempt" << std::endl;
-    
-    if (ws_) {
-        std::cerr << "[Server] Rejecting connection - already connected" << std::endl;
+void WebSocketSession::onRequest(beast::error_code ec) {
+    if (ec || !beast::websocket::is_upgrade(request_)) {
+        std::cerr << "[Server] Rejecting connection - not a WebSocket upgrade" << std::endl;
         return;
     }
-    
-    std::cout << "[Server] Connection accepted" << std::endl;
-    ws_.emplace(std::move(socket));
-    ws_->async_accept([this](beast::error_code ec) {
-        if (!ec) {
-            std::cout << "[Server] WebSocket handshake successful" << std::endl;
-            readLoop();
-        } else {
-            std::cerr << "[Server] Handshake error: " << ec.message() << std::endl;
-            ws_.reset();
-        }
-    });
+
+    std::string id = deviceIdFromTarget(request_.target());
+    device_ = registry_.connect(id);
+    if (!device_) {
+        std::cerr << "[Server] Rejecting connection - device '" << id << "' already connected or "
+                  << registry_.config().maxDevices << " devices known" << std::endl;
+        return;
+    }
+
+    std::cout << "[Server] Connection accepted for device '" << id << "'" << std::endl;
+    ws_.async_accept(request_,
+        [self = shared_from_this()](beast::error_code ec) { self->onAccept(ec); });
+}
+
+void WebSocketSession::onAccept(beast::error_code ec) {
+    if (ec) {
+        std::cerr << "[Server] Handshake error: " << ec.message() << std::endl;
+        return;
+    }
+    std::cout << "[Server] WebSocket handshake successful" << std::endl;
+    if (recorder_) {
+        recording_ = recorder_->openStream(device_->id);
+    }
+    if (triggers_) {
+        triggerStream_ = triggers_->openStream(*device_);
+    }
+    buffer_.clear();
+    readLoop();
 }
 
 void WebSocketSession::readLoop() {
-    ws_->async_read(buffer_,
-        [this](beast::error_code ec, size_t bytes) {
-            if (ec) return ws_.reset();
+    ws_.async_read(buffer_,
+        [self = shared_from_this()](beast::error_code ec, size_t bytes) {
+            if (ec) return;
             
-            processMessage(bytes);
-            buffer_.consume(bytes);
-            readLoop();
+            self->processMessage(bytes);
+            self->buffer_.consume(bytes);
+            self->scheduleRead();
         });
 }
 
+// Reads on right away unless the pause policy has to wait for the budget to recover.
+// Not reading fills the socket buffers, and TCP flow control then slows the sender.
+void WebSocketSession::scheduleRead() {
+    const double wait = policy_ == OverloadPolicy::Pause ? budget_.secondsInDebt() : 0.0;
+    if (wait <= 0.0) {
+        readLoop();
+        return;
+    }
+    device_->readPauses.fetch_add(1, std::memory_order_relaxed);
+    IMU_TELEMETRY(telemetry().readPauses.add());
+    pauseTimer_.expires_after(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(std::min(wait, maxReadPauseSeconds))));
+    pauseTimer_.async_wait([self = shared_from_this()](beast::error_code ec) {
+        if (!ec) self->readLoop();
+    });
+}
+
 void WebSocketSession::processMessage(size_t bytes) {
-    std::string msg(static_cast<char*>(buffer_.data().data()), bytes);
-    //std::cout << "[Server] Received message: " << msg << std::endl;
-    
-    float ax, ay, az, gx, gy, gz, mx, my, mz;
-    if (sscanf(msg.c_str(), "Acc: [%f, %f, %f], Gyro: [%f, %f, %f], Mag: [%f, %f, %f]",
-              &ax, &ay, &az, &gx, &gy, &gz, &mx, &my, &mz) == 9) {
-        //std::cout << "[Server] Parsed values - Acc: [" << ax << ", " << ay << ", " << az << "],
-        //                                      Gyro: [" << gx << ", " << gy << ", " << gz << "]" 
-        //                                      Mag: [" << mx << ", " << my << ", " << mz << "]" 
-        //                                      << std::endl;
-        gyroBuffer_.append(&gx, &gy, &gz, 1);
-        accelBuffer_.append(&ax, &ay, &az, 1);
-        magBuffer_.append(&mx, &my, &mz, 1);
-    } else {
-        std::cerr << "[Server] Failed to parse message" << std::endl;
-    }
-}
\ No newline at end of file
+    const void* data = buffer_.data().data();
+    IMU_TELEMETRY(const std::int64_t receivedNs = telemetryNowNs());
+    IMU_TELEMETRY(telemetry().framesReceived.add());
+    IMU_TELEMETRY(telemetry().bytesReceived.add(bytes));
+
+    bool parsed;
+    {
+        IMU_TELEMETRY(ScopedTimer timer(telemetry().parseTime));
+        parsed = ws_.got_binary()
+            ? parseBinaryFrame(data, bytes, batch_)
+            : parseTextFrame(static_cast<const char*>(data), bytes, batch_);
+    }
+    if (!parsed) {
+        // Counted, not logged, so a misbehaving device can't flood stderr
+        if (device_->parseErrors.fetch_add(1, std::memory_order_relaxed) == 0) {
+            std::cerr << "[Server] Device '" << device_->id << "' sent a malformed message, "
+                      << "further ones are only counted" << std::endl;
+        }
+        IMU_TELEMETRY(telemetry().parseErrors.add());
+        return;
+    }
+
+    double newest = batch_.hasTimestamp ? batch_.timestampUs * 1e-6 : receiveSeconds();
+    batch_.gyro.stamp(newest, 1.0 / device_->config.gyroFreq);
+    batch_.accel.stamp(newest, 1.0 / device_->config.accelFreq);
+    batch_.mag.stamp(newest, 1.0 / device_->config.magFreq);
+
+    if (!applyOverloadPolicy()) {
+        return;
+    }
+
+    // One bulk append per sensor
+    bool appended = appendSamples(device_->gyro, RecordSensor::Gyro, batch_.gyro);
+    appended &= appendSamples(device_->accel, RecordSensor::Accel, batch_.accel);
+    appended &= appendSamples(device_->mag, RecordSensor::Mag, batch_.mag);
+    if (!appended && !oversizeLogged_) {
+        // Counted in rejectedSamples; logged once so an overloaded session doesn't flood stderr
+        oversizeLogged_ = true;
+        std::cerr << "[Server] Device '" << device_->id << "' sent a batch larger than its buffers, "
+                  << "kept the newest samples" << std::endl;
+    }
+    if (triggerStream_) {
+        triggerStream_->process(batch_);
+    }
+    IMU_TELEMETRY(device_->lastReceiveNs.store(receivedNs, std::memory_order_relaxed));
+}
+
+// Charges the batch against the ingest budget. Returns false if the whole batch is dropped.
+bool WebSocketSession::applyOverloadPolicy() {
+    std::size_t count = batch_.gyro.count + batch_.accel.count + batch_.mag.count;
+    budget_.refill(receiveSeconds());
+    const double available = std::max(budget_.available(), 0.0);
+
+    if (static_cast<double>(count) > available) {
+        switch (policy_) {
+            case OverloadPolicy::DropOldest: {
+                // Every sensor keeps its newest samples, in proportion, so the batch fits the budget
+                const double share = available / static_cast<double>(count);
+                std::size_t kept = 0;
+                for (SensorSamples* samples : {&batch_.gyro, &batch_.accel, &batch_.mag}) {
+                    samples->keepNewest(static_cast<std::size_t>(static_cast<double>(samples->count) * share));
+                    kept += samples->count;
+                }
+                device_->overBudgetSamples.fetch_add(count - kept, std::memory_order_relaxed);
+                IMU_TELEMETRY(telemetry().samplesOverBudget.add(count - kept));
+                if (kept == 0) {
+                    return false;
+                }
+                count = kept;
+                break;
+            }
+            case OverloadPolicy::DropNewest:
+                device_->droppedSamples.fetch_add(count, std::memory_order_relaxed);
+                IMU_TELEMETRY(telemetry().samplesDropped.add(count));
+                return false;
+            case OverloadPolicy::Decimate: {
+                // At least the newest sample of each sensor survives
+                const std::size_t factor = available >= 1.0
+                    ? static_cast<std::size_t>(std::ceil(count / available))
+                    : std::max({batch_.gyro.count, batch_.accel.count, batch_.mag.count});
+                const std::size_t kept = batch_.gyro.decimate(factor) + batch_.accel.decimate(factor) +
+                                         batch_.mag.decimate(factor);
+                device_->decimatedSamples.fetch_add(count - kept, std::memory_order_relaxed);
+                IMU_TELEMETRY(telemetry().samplesDecimated.add(count - kept));
+                count = kept;
+                break;
+            }
+            case OverloadPolicy::Pause:
+                break; // Paid off by not reading, see scheduleRead()
+        }
+    }
+    budget_.consume(static_cast<double>(count));
+    return true;
+}
+
+// Keeps the newest samples of a batch that doesn't fit the buffer
+template <typename Buffer>
+bool WebSocketSession::appendSamples(Buffer& buffer, RecordSensor sensor, SensorSamples& samples) {
+    const bool fits = samples.count <= buffer.capacity();
+    if (!fits) {
+        device_->rejectedSamples.fetch_add(samples.count - buffer.capacity(), std::memory_order_relaxed);
+        samples.keepNewest(buffer.capacity());
+    }
+    if (samples.count > 0) {
+        buffer.append(samples.t.data(), samples.x.data(), samples.y.data(), samples.z.data(), samples.count);
+        IMU_TELEMETRY(telemetry().samplesIngested.add(samples.count));
+        if (recording_) {
+            recording_->write(sensor, samples);
+        }
+    }
+    return fits;
+}
@@ -1,132 +1,113 @@
-#define _USE_MATH_DEFINES
-#include <cmath>
 #include <atomic>
 #include <thread>
+#include <vector>
+#include <memory>
 #include <iostream>
 #include <chrono>
+#include <utility>
 #include <boost/asio.hpp>
 
+#include "AppConfig.h"
 #include "Config.h"
-#include "WebSocketSession.h"
+#include "DeviceRegistry.h"
+#include "FusionWorker.h"
+#include "HistoryWorker.h"
+#include "LoadGenerator.h"
+#include "Recorder.h"
+#include "ReplayEngine.h"
+#include "SpectrumWorker.h"
+#include "TaskPool.h"
+#include "TriggerEngine.h"
+#include "WebSocketServer.h"
 #include "RunApp.h"
+#include "Telemetry.h"
+
+int main(int argc, char** argv) {
+    AppConfig config;
+    try {
+        config = loadConfig(argc, argv);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "[Config] " << e.what() << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+    std::cout << "[Config] Gyro " << config.gyroFreq << " Hz, Accel " << config.accelFreq
+              << " Hz, Mag " << config.magFreq << " Hz, " << config.bufferSeconds << " s window" << std::endl;
+
+    // Buffer sizes are known before any device connects
+    const std::pair<const char*, std::size_t> bufferSizes[] = {
+        {"Gyro", config.gyroBufferSize()}, {"Accel", config.accelBufferSize()}, {"Mag", config.magBufferSize()}};
+    for (const auto& [name, requested] : bufferSizes) {
+        const std::size_t capacity = GyroBuffer::roundedCapacity(requested);
+        if (capacity != requested) {
+            std::cout << "[Buffers] " << name << " buffer holds " << capacity << " samples instead of " << requested
+                      << ", rounded up to whole pages so it can be double mapped" << std::endl;
+        }
+    }
+    std::cout << "[Buffers] " << DeviceBuffers::memoryBytesFor(config) / 1024 << " KiB per device" << std::endl;
+
+    DeviceRegistry registry(config);
+    TaskPool pool(static_cast<std::size_t>(config.workerThreads)); // Shared by the processing stages and the plots
+    FusionWorker fusion(registry, pool); // Orientation for every device, live or replayed
+    SpectrumWorker spectrum(registry, pool, spectrumFftSize, spectrumHistory);
+    std::unique_ptr<HistoryWorker> history; // Compressed long history behind the buffers
+    if (config.historySeconds > 0) {
+        history = std::make_unique<HistoryWorker>(registry, pool);
+    }
+    TriggerEngine triggers(config, triggerCaptureSlots); // Checked by every ingest path
+
+    // Play back a recording if one is given, otherwise generate synthetic data below
+    std::unique_ptr<ReplayEngine> replay;
+    if (!config.replayPath.empty()) {
+        try {
+            replay = std::make_unique<ReplayEngine>(config.replayPath, registry, config.replaySpeed, &triggers);
+        } catch (const std::runtime_error& e) {
+            std::cerr << "[Replay] " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    // Optional recording of everything received over WebSocket
+    std::unique_ptr<Recorder> recorder;
+    if (!config.recordPath.empty()) {
+        try {
+            recorder = std::make_unique<Recorder>(config.recordPath);
+        } catch (const std::runtime_error& e) {
+            std::cerr << "[Recorder] " << e.what() << std::endl;
+            return 1;
+        }
+    }
 
-void prefillBuffers(GyroBuffer& gyroBuffer, AccelBuffer& accelBuffer, MagBuffer& magBuffer,
-    std::array<float, gyroBufferSize>& gyroTimesBuffer,
-    std::array<float, accelBufferSize>& accelTimesBuffer,
-    std::array<float, magBufferSize>& magTimesBuffer);
-
-void startExampleDataThreads(GyroBuffer& gyroBuffer, AccelBuffer& accelBuffer, MagBuffer& magBuffer);
-
-int main() {
-    GyroBuffer gyroBuffer;
-    AccelBuffer accelBuffer;
-    MagBuffer magBuffer;
-
-    std::array<float, gyroBufferSize> gyroTimesBuffer;
-    std::array<float, accelBufferSize> accelTimesBuffer;
-    std::array<float, magBufferSize> magTimesBuffer;
-
-    prefillBuffers(gyroBuffer, accelBuffer, magBuffer,
-                         gyroTimesBuffer, accelTimesBuffer, magTimesBuffer);
-
-    startExampleDataThreads(gyroBuffer, accelBuffer, magBuffer); // Use for example data 
-
-    // Start WebSocket server
-    boost::asio::io_context ioc;
-    WebSocketSession server(ioc, 8000, gyroBuffer, accelBuffer, magBuffer);
+    // Start WebSocket server, each connection runs on its own strand over the thread pool
+    boost::asio::io_context ioc(config.ioThreads);
+    WebSocketServer server(ioc, config.port, registry, recorder.get(), &triggers);
     server.run();
-    std::thread socketThread([&ioc]() { ioc.run(); });
+    std::vector<std::thread> socketThreads;
+    for (int i = 0; i < config.ioThreads; ++i) {
+        socketThreads.emplace_back([&ioc]() { ioc.run(); });
+    }
+
+    // Started once the server listens, in case the load goes through it
+    std::unique_ptr<LoadGenerator> load;
+    if (!replay && config.loadDevices > 0) {
+        load = std::make_unique<LoadGenerator>(registry, config, &triggers);
+    }
 
     // Launch application UI
-    runApp(gyroBuffer, accelBuffer, magBuffer,
-           gyroTimesBuffer, accelTimesBuffer, magTimesBuffer);
+    runApp(registry, pool, spectrum, triggers, replay.get());
 
-    // Clean up
+    // Clean up, the load first so its sessions finish normally
+    load.reset();
     ioc.stop();
-    socketThread.join();
-}
-
-void prefillBuffers(GyroBuffer& gyroBuffer, AccelBuffer& accelBuffer, MagBuffer& magBuffer,
-                    std::array<float, gyroBufferSize>& gyroTimesBuffer,
-                    std::array<float, accelBufferSize>& accelTimesBuffer,
-                    std::array<float, magBufferSize>& magTimesBuffer) {
-    // Pre-fill gyro data buffer
-    std::vector<float> gyroX(gyroBufferSize, 0.0f);
-    std::vector<float> gyroY(gyroBufferSize, 0.0f);
-    std::vector<float> gyroZ(gyroBufferSize, 0.0f);
-    gyroBuffer.append(gyroX.data(), gyroY.data(), gyroZ.data(), gyroBufferSize);
-
-    // Pre-fill accel data buffer
-    std::vector<float> accelX(accelBufferSize, 0.0f);
-    std::vector<float> accelY(accelBufferSize, 0.0f);
-    std::vector<float> accelZ(accelBufferSize, 0.0f);
-    accelBuffer.append(accelX.data(), accelY.data(), accelZ.data(), accelBufferSize);
-
-    // Pre-fill mag data buffer
-    std::vector<float> magX(magBufferSize, 0.0f);
-    std::vector<float> magY(magBufferSize, 0.0f);
-    std::vector<float> magZ(magBufferSize, 0.0f);
-    magBuffer.append(magX.data(), magY.data(), magZ.data(), magBufferSize);
-
-    // Time buffers
-    float timeStep;
-
-    timeStep = 1.0f / gyroFreq;
-    for (size_t i = 0; i < gyroBufferSize; ++i)
-        gyroTimesBuffer[i] = -bufferSeconds + i * timeStep;
-
-    timeStep = 1.0f / accelFreq;
-    for (size_t i = 0; i < accelBufferSize; ++i)
-        accelTimesBuffer[i] = -bufferSeconds + i * timeStep;
-
-    timeStep = 1.0f / magFreq;
-    for (size_t i = 0; i < magBufferSize; ++i)
-        magTimesBuffer[i] = -bufferSeconds + i * timeStep;
+    for (auto& thread : socketThreads) {
+        thread.join();
+    }
+
+    if (!config.telemetryPath.empty()) {
+#if defined(IMU_ENABLE_TELEMETRY)
+        telemetry().dumpToFile(config.telemetryPath);
+#else
+        std::cerr << "[Telemetry] Built without IMU_ENABLE_TELEMETRY, nothing to write" << std::endl;
+#endif
+    }
 }
-
-void startExampleDataThreads(GyroBuffer& gyroBuffer, AccelBuffer& accelBuffer, MagBuffer& magBuffer) {
-    std::thread([&gyroBuffer]() {
-        const int sampleFrequency = gyroFreq;
-        const float dataFrequency = 0.5f;
-        auto interval = std::chrono::milliseconds(1000 / sampleFrequency);
-        float t = 0.0f;
-        while (true) {
-            float x = std::sin(2 * M_PI * dataFrequency * t);
-            float y = std::cos(2 * M_PI * dataFrequency * 0.5f * t);
-            float z = std::sin(2 * M_PI * dataFrequency * (1.0f / 3.0f) * t);
-            gyroBuffer.append(&x, &y, &z, 1);
-            std::this_thread::sleep_for(interval);
-            t += 1.0f / sampleFrequency;
-        }
-    }).detach();
-
-    std::thread([&accelBuffer]() {
-        const int sampleFrequency = accelFreq;
-        const float dataFrequency = 1.0f;
-        auto interval = std::chrono::milliseconds(1000 / sampleFrequency);
-        float t = 0.0f;
-        while (true) {
-            float x = std::sin(2 * M_PI * dataFrequency * t);
-            float y = std::cos(2 * M_PI * dataFrequency * 0.5f * t);
-            float z = std::sin(2 * M_PI * dataFrequency * (1.0f / 3.0f) * t);
-            accelBuffer.append(&x, &y, &z, 1);
-            std::this_thread::sleep_for(interval);
-            t += 1.0f / sampleFrequency;
-        }
-    }).detach();
-
-    std::thread([&magBuffer]() {
-        const int sampleFrequency = magFreq;
-        const float dataFrequency = 2.0f;
-        auto interval = std::chrono::milliseconds(1000 / sampleFrequency);
-        float t = 0.0f;
-        while (true) {
-            float x = std::sin(2 * M_PI * dataFrequency * t);
-            float y = std::cos(2 * M_PI * dataFrequency * 0.5f * t);
-            float z = std::sin(2 * M_PI * dataFrequency * (1.0f / 3.0f) * t);
-            magBuffer.append(&x, &y, &z, 1);
-            std::this_thread::sleep_for(interval);
-            t += 1.0f / sampleFrequency;
-        }
-    }).detach();
-}
\ No newline at end of file
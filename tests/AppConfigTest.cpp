@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "AppConfig.h"
+
+namespace {
+
+AppConfig load(std::vector<std::string> args) {
+    args.insert(args.begin(), "IMUTool");
+    std::vector<char*> argv;
+    for (auto& arg : args) {
+        argv.push_back(arg.data());
+    }
+    return loadConfig(static_cast<int>(argv.size()), argv.data());
+}
+
+} // namespace
+
+TEST(AppConfig, AppliesCommandLineOverrides) {
+    AppConfig config = load({"--gyro-hz=1000", "--buffer-seconds", "60", "--overload-policy=decimate"});
+    EXPECT_EQ(config.gyroFreq, 1000);
+    EXPECT_EQ(config.bufferSeconds, 60);
+    EXPECT_EQ(config.gyroBufferSize(), 60000u);
+    EXPECT_EQ(config.overloadPolicy, OverloadPolicy::Decimate);
+}
+
+TEST(AppConfig, RejectsBadValues) {
+    EXPECT_THROW(load({"--gyro-hz=0"}), std::invalid_argument);
+    EXPECT_THROW(load({"--gyro-hz=fast"}), std::invalid_argument);
+    EXPECT_THROW(load({"--no-such-key=1"}), std::invalid_argument);
+    EXPECT_THROW(load({"--buffer-seconds"}), std::invalid_argument);
+}
+
+TEST(AppConfig, LoadDevicesMustFitUnderMaxDevices) {
+    EXPECT_EQ(load({"--max-devices=4", "--load-devices=4"}).maxDevices, 4);
+    EXPECT_THROW(load({"--max-devices=4", "--load-devices=5"}), std::invalid_argument);
+    EXPECT_THROW(load({"--max-devices=0"}), std::invalid_argument);
+}
+
+TEST(AppConfig, RejectsBuffersBeyondPerDeviceCap) {
+    // Each value is in range on its own
+    EXPECT_THROW(load({"--gyro-hz=1000000", "--buffer-seconds=86400"}), std::invalid_argument);
+    EXPECT_NO_THROW(load({"--gyro-hz=10000", "--accel-hz=10000", "--mag-hz=1000", "--buffer-seconds=60"}));
+}
@@ -0,0 +1,133 @@
+#define _USE_MATH_DEFINES
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "CompressedHistory.h"
+
+namespace {
+
+constexpr double rate = 1000.0;
+
+struct Samples {
+    std::vector<double> t;
+    std::vector<float> x, y, z;
+};
+
+// 'seconds' of a slow three-axis motion at 1 kHz
+Samples smoothMotion(double seconds) {
+    Samples s;
+    const std::size_t n = static_cast<std::size_t>(seconds * rate);
+    for (std::size_t i = 0; i < n; ++i) {
+        const double t = i / rate;
+        s.t.push_back(t);
+        s.x.push_back(static_cast<float>(std::sin(2 * M_PI * 0.5 * t)));
+        s.y.push_back(static_cast<float>(2.0 * std::cos(2 * M_PI * 0.2 * t)));
+        s.z.push_back(static_cast<float>(9.81 + 0.1 * std::sin(2 * M_PI * 1.3 * t)));
+    }
+    return s;
+}
+
+void appendAll(CompressedHistory& history, const Samples& s) {
+    // In uneven chunks, like the HistoryWorker
+    for (std::size_t i = 0; i < s.t.size();) {
+        const std::size_t n = std::min<std::size_t>(s.t.size() - i, 97 + i % 300);
+        history.append(&s.t[i], &s.x[i], &s.y[i], &s.z[i], n);
+        i += n;
+    }
+}
+
+} // namespace
+
+// With a slice per sample every point is a decoded sample, within the quantization
+// error of its block
+TEST(CompressedHistory, DecodedSamplesRoundTrip) {
+    const Samples s = smoothMotion(20.0);
+    CompressedHistory history(3600.0);
+    appendAll(history, s);
+    EXPECT_EQ(history.sampleCount(), s.t.size());
+    EXPECT_DOUBLE_EQ(history.oldestTime(), s.t.front());
+    EXPECT_DOUBLE_EQ(history.newestTime(), s.t.back());
+
+    // 2 s, i.e. 8 blocks and the tail reaching into the open block
+    const double from = 17.9995;
+    const double to = s.t.back();
+    const std::size_t buckets = 4000;
+    std::vector<double> t(CompressedHistory::maxPoints(buckets));
+    std::vector<float> x(t.size()), y(t.size()), z(t.size());
+    const std::size_t count = history.readDecimated(from, to, buckets, t.data(), x.data(), y.data(), z.data());
+    ASSERT_EQ(count, 2 * 2000u);
+
+    const float tolerance[3] = {2.0f / 8190, 4.0f / 8190, 0.2f / 8190};
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::size_t sample = static_cast<std::size_t>(std::llround(t[i] * rate));
+        ASSERT_LT(sample, s.t.size());
+        EXPECT_NEAR(t[i], s.t[sample], 1e-6);
+        EXPECT_NEAR(x[i], s.x[sample], tolerance[0]) << "at " << t[i];
+        EXPECT_NEAR(y[i], s.y[sample], tolerance[1]) << "at " << t[i];
+        EXPECT_NEAR(z[i], s.z[sample], tolerance[2]) << "at " << t[i];
+    }
+}
+
+// Zoomed out the summaries keep the exact extremes
+TEST(CompressedHistory, SummariesKeepExactExtremes) {
+    Samples s = smoothMotion(60.0);
+    s.x[31234] = 50.0f;
+    s.y[45678] = -50.0f;
+    CompressedHistory history(3600.0);
+    appendAll(history, s);
+
+    const std::size_t buckets = 100;
+    std::vector<double> t(CompressedHistory::maxPoints(buckets));
+    std::vector<float> x(t.size()), y(t.size()), z(t.size());
+    const std::size_t count = history.readDecimated(0.0, 60.0, buckets, t.data(), x.data(), y.data(), z.data());
+    ASSERT_GT(count, 0u);
+    ASSERT_LE(count, CompressedHistory::maxPoints(buckets));
+    EXPECT_EQ(*std::max_element(x.begin(), x.begin() + count), 50.0f);
+    EXPECT_EQ(*std::min_element(y.begin(), y.begin() + count), -50.0f);
+}
+
+TEST(CompressedHistory, SmoothSignalsCompressTenfold) {
+    const Samples s = smoothMotion(600.0);
+    CompressedHistory history(3600.0);
+    appendAll(history, s);
+
+    // A double time and three floats per raw sample
+    const double raw = static_cast<double>(s.t.size()) * (sizeof(double) + 3 * sizeof(float));
+    const double ratio = raw / static_cast<double>(history.memoryBytes());
+    EXPECT_GE(ratio, 10.0);
+    RecordProperty("ratio", std::to_string(ratio));
+}
+
+// Timestamps going back must not open a slice per sample and write past maxPoints()
+TEST(CompressedHistory, OutOfOrderTimesStayWithinMaxPoints) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> jump(0.0, 10.0);
+    Samples s;
+    for (int i = 0; i < 5000; ++i) {
+        s.t.push_back(jump(rng));
+        s.x.push_back(static_cast<float>(i));
+        s.y.push_back(0.0f);
+        s.z.push_back(-static_cast<float>(i));
+    }
+    CompressedHistory history(1e9);
+    appendAll(history, s);
+
+    constexpr float sentinel = 12345.0f;
+    for (std::size_t buckets : {1000, 4000, 100000}) {
+        SCOPED_TRACE(testing::Message() << buckets << " buckets");
+        const std::size_t points = CompressedHistory::maxPoints(buckets);
+        std::vector<double> t(points + 64, -1.0);
+        std::vector<float> x(points + 64, sentinel), y(points + 64, sentinel), z(points + 64, sentinel);
+        const std::size_t count = history.readDecimated(0.0, 10.0, buckets, t.data(), x.data(), y.data(), z.data());
+        EXPECT_LE(count, points);
+        for (std::size_t i = points; i < t.size(); ++i) {
+            ASSERT_EQ(t[i], -1.0);
+            ASSERT_EQ(x[i], sentinel);
+        }
+    }
+}
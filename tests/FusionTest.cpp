@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "AppConfig.h"
+#include "DeviceRegistry.h"
+#include "FusionWorker.h"
+#include "MadgwickFilter.h"
+#include "TaskPool.h"
+
+namespace {
+
+constexpr float radToDeg = 57.29577951f;
+
+struct Euler {
+    float roll, pitch, yaw;
+};
+
+// Same conventions as the FusionWorker's euler output, in degrees
+Euler toEuler(const UnitQuaternion& q) {
+    return {radToDeg * std::atan2(2.0f * (q.w * q.x + q.y * q.z), 1.0f - 2.0f * (q.x * q.x + q.y * q.y)),
+            radToDeg * std::asin(std::clamp(2.0f * (q.w * q.y - q.z * q.x), -1.0f, 1.0f)),
+            radToDeg * std::atan2(2.0f * (q.w * q.z + q.x * q.y), 1.0f - 2.0f * (q.y * q.y + q.z * q.z))};
+}
+
+// A level device with the magnetic field pointing north and down
+constexpr float levelAccel[3] = {0.0f, 0.0f, 1.0f};
+constexpr float levelMag[3] = {0.6f, 0.0f, -0.8f};
+
+} // namespace
+
+// Tilted away by the gyro alone, the filter settles back on a static accel/mag field
+TEST(MadgwickFilter, StaticFieldConvergesToLevel) {
+    MadgwickFilter filter(0.5f);
+    const float dt = 0.01f;
+    // Without accel or mag there is no correction, so this rolls by exactly 1 rad
+    for (int i = 0; i < 10; ++i) {
+        filter.update(10.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, dt);
+    }
+    ASSERT_NEAR(toEuler(filter.orientation()).roll, radToDeg, 0.5f);
+
+    for (int i = 0; i < 1000; ++i) {
+        filter.update(0.0f, 0.0f, 0.0f, levelAccel[0], levelAccel[1], levelAccel[2],
+                      levelMag[0], levelMag[1], levelMag[2], dt);
+    }
+    const Euler euler = toEuler(filter.orientation());
+    EXPECT_NEAR(euler.roll, 0.0f, 1.0f);
+    EXPECT_NEAR(euler.pitch, 0.0f, 1.0f);
+    EXPECT_NEAR(euler.yaw, 0.0f, 1.0f);
+}
+
+// Gravity says nothing about heading, so a constant yaw rate integrates unchanged
+TEST(MadgwickFilter, ConstantGyroRateIntegratesToYaw) {
+    MadgwickFilter filter(0.1f);
+    const float rate = 0.5f; // rad/s
+    const float dt = 0.01f;
+    for (int i = 0; i < 200; ++i) {
+        filter.updateImu(0.0f, 0.0f, rate, levelAccel[0], levelAccel[1], levelAccel[2], dt);
+    }
+    const Euler euler = toEuler(filter.orientation());
+    EXPECT_NEAR(euler.yaw, radToDeg * rate * 2.0f, 0.5f);
+    EXPECT_NEAR(euler.roll, 0.0f, 0.1f);
+    EXPECT_NEAR(euler.pitch, 0.0f, 0.1f);
+}
+
+// Accel and mag arrive at their own rates and phases, and ahead of the gyro. Each
+// gyro step may only use readings up to its own time, so a tilt that starts at
+// 'tiltAt' must not show up in any earlier output.
+TEST(FusionWorker, MergesSensorsInTimeOrder) {
+    AppConfig config;
+    config.gyroFreq = 100;
+    config.accelFreq = 37;
+    config.magFreq = 13;
+    config.historySeconds = 0;
+    config.fusionBeta = 1.0f;
+    DeviceRegistry registry(config);
+    DeviceBuffers* device = registry.connect("fusion");
+    ASSERT_NE(device, nullptr);
+
+    const double seconds = 2.0;
+    const double tiltAt = 1.0;
+    // Appends 'seconds' of samples at 'rate', starting at 'offset' and using 'after' from 'tiltAt' on
+    const auto fill = [&](auto& buffer, double rate, double offset, const float* before, const float* after) {
+        std::vector<double> t;
+        std::vector<float> x, y, z;
+        for (double time = offset; time < seconds; time += 1.0 / rate) {
+            const float* v = time < tiltAt ? before : after;
+            t.push_back(time);
+            x.push_back(v[0]);
+            y.push_back(v[1]);
+            z.push_back(v[2]);
+        }
+        buffer.append(t.data(), x.data(), y.data(), z.data(), t.size());
+        return t;
+    };
+    const float rolledAccel[3] = {0.0f, 1.0f, 0.0f}; // Rolled 90 degrees
+    const float zero[3] = {0.0f, 0.0f, 0.0f};
+
+    TaskPool pool(1);
+    fill(device->accel, config.accelFreq, 0.011, levelAccel, rolledAccel);
+    fill(device->mag, config.magFreq, 0.047, levelMag, levelMag);
+    FusionWorker worker(registry, pool);
+    const std::vector<double> gyroTimes = fill(device->gyro, config.gyroFreq, 0.003, zero, zero);
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (device->euler.written() < gyroTimes.size() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(device->euler.written(), gyroTimes.size());
+
+    std::uint64_t cursor = 0;
+    std::vector<double> t(gyroTimes.size());
+    std::vector<float> roll(t.size()), pitch(t.size()), yaw(t.size());
+    ASSERT_EQ(device->euler.readSince(cursor, t.size(), t.data(), roll.data(), pitch.data(), yaw.data()), t.size());
+
+    float lastRoll = 0.0f;
+    for (std::size_t i = 0; i < t.size(); ++i) {
+        SCOPED_TRACE(testing::Message() << "t = " << t[i]);
+        // One output per gyro sample, at its time
+        ASSERT_EQ(t[i], gyroTimes[i]);
+        if (t[i] < tiltAt) {
+            // The first gyro samples run before any mag reading, on accel alone
+            EXPECT_NEAR(roll[i], 0.0f, 0.1f);
+            EXPECT_NEAR(pitch[i], 0.0f, 0.1f);
+        } else {
+            lastRoll = roll[i];
+        }
+    }
+    EXPECT_GT(std::abs(lastRoll), 20.0f);
+}
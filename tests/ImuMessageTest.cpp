@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "ImuMessage.h"
+
+namespace {
+
+bool parseText(const std::string& text, ImuBatch& batch) {
+    return parseTextFrame(text.data(), text.size(), batch);
+}
+
+void fill(SensorSamples& samples, std::size_t count, float base) {
+    samples.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        samples.x[i] = base + i;
+        samples.y[i] = base - i;
+        samples.z[i] = base * i;
+    }
+}
+
+} // namespace
+
+TEST(ImuMessage, ParsesSingleSampleText) {
+    ImuBatch batch;
+    ASSERT_TRUE(parseText("Acc: [1.5, -2, 3e1], Gyro: [0.1, 0.2, 0.3], Mag: [4, 5, 6]", batch));
+    EXPECT_FALSE(batch.hasTimestamp);
+    ASSERT_EQ(batch.accel.count, 1u);
+    EXPECT_FLOAT_EQ(batch.accel.x[0], 1.5f);
+    EXPECT_FLOAT_EQ(batch.accel.y[0], -2.0f);
+    EXPECT_FLOAT_EQ(batch.accel.z[0], 30.0f);
+    EXPECT_EQ(batch.gyro.count, 1u);
+    EXPECT_EQ(batch.mag.count, 1u);
+}
+
+TEST(ImuMessage, ParsesBatchedTextWithTimestamp) {
+    ImuBatch batch;
+    ASSERT_TRUE(parseText("T: 1.25, Gyro: [[1, 2, 3], [4, 5, 6]], Acc: [7, 8, 9]", batch));
+    EXPECT_TRUE(batch.hasTimestamp);
+    EXPECT_EQ(batch.timestampUs, 1250000u);
+    ASSERT_EQ(batch.gyro.count, 2u);
+    EXPECT_FLOAT_EQ(batch.gyro.z[1], 6.0f);
+    EXPECT_EQ(batch.accel.count, 1u);
+    EXPECT_EQ(batch.mag.count, 0u);
+}
+
+TEST(ImuMessage, RejectsMalformedText) {
+    ImuBatch batch;
+    EXPECT_FALSE(parseText("", batch));
+    EXPECT_FALSE(parseText("Acc: [1, 2]", batch));
+    EXPECT_FALSE(parseText("Foo: [1, 2, 3]", batch));
+    EXPECT_FALSE(parseText("Acc: [1, 2, 3] trailing", batch));
+}
+
+// The timestamp is rounded to whole microseconds, which has to fit in 63 bits
+TEST(ImuMessage, RejectsTimestampsOutOfRange) {
+    ImuBatch batch;
+    for (const char* t : {"nan", "inf", "-inf", "-1", "1e300", "9223372036855"}) {
+        SCOPED_TRACE(t);
+        EXPECT_FALSE(parseText(std::string("T: ") + t + ", Acc: [1, 2, 3]", batch));
+    }
+    ASSERT_TRUE(parseText("T: 4398046511104, Acc: [1, 2, 3]", batch));
+    EXPECT_EQ(batch.timestampUs, 4398046511104000000u);
+}
+
+TEST(ImuMessage, BinaryRoundTrip) {
+    ImuBatch batch;
+    fill(batch.gyro, 3, 1.0f);
+    fill(batch.accel, 5, 2.0f);
+    fill(batch.mag, 1, 3.0f);
+    batch.timestampUs = 123456789;
+
+    std::vector<std::uint8_t> frame;
+    encodeBinaryFrame(batch, frame);
+    ASSERT_EQ(frame.size(), imuFrameHeaderSize + 9 * 12);
+
+    ImuBatch decoded;
+    ASSERT_TRUE(parseBinaryFrame(frame.data(), frame.size(), decoded));
+    EXPECT_TRUE(decoded.hasTimestamp);
+    EXPECT_EQ(decoded.timestampUs, 123456789u);
+    ASSERT_EQ(decoded.accel.count, 5u);
+    for (std::size_t i = 0; i < 5; ++i) {
+        EXPECT_EQ(decoded.accel.x[i], batch.accel.x[i]);
+        EXPECT_EQ(decoded.accel.y[i], batch.accel.y[i]);
+        EXPECT_EQ(decoded.accel.z[i], batch.accel.z[i]);
+    }
+    EXPECT_EQ(decoded.gyro.count, 3u);
+    EXPECT_EQ(decoded.mag.count, 1u);
+}
+
+TEST(ImuMessage, RejectsTruncatedBinary) {
+    ImuBatch batch;
+    fill(batch.gyro, 2, 1.0f);
+    std::vector<std::uint8_t> frame;
+    encodeBinaryFrame(batch, frame);
+
+    ImuBatch decoded;
+    EXPECT_FALSE(parseBinaryFrame(frame.data(), frame.size() - 1, decoded));
+    EXPECT_FALSE(parseBinaryFrame(frame.data(), imuFrameHeaderSize - 1, decoded));
+    frame[0] = 'X';
+    EXPECT_FALSE(parseBinaryFrame(frame.data(), frame.size(), decoded));
+}
+
+TEST(ImuMessage, RejectsUnknownBinaryVersionFlagsAndReserved) {
+    ImuBatch batch;
+    fill(batch.accel, 1, 1.0f);
+    std::vector<std::uint8_t> frame;
+    encodeBinaryFrame(batch, frame);
+
+    ImuBatch decoded;
+    for (std::size_t offset : {2, 3, 10, 11}) {
+        std::vector<std::uint8_t> modified = frame;
+        modified[offset] ^= 0x01;
+        EXPECT_FALSE(parseBinaryFrame(modified.data(), modified.size(), decoded)) << "byte " << offset;
+    }
+    EXPECT_TRUE(parseBinaryFrame(frame.data(), frame.size(), decoded));
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+#include "AppConfig.h"
+#include "LoadProfile.h"
+
+namespace {
+
+// floor(frame * batch * rate / fastest) without the overflow guard
+std::uint64_t reference(std::uint64_t frame, std::uint64_t batch, std::uint64_t rate, std::uint64_t fastest) {
+    return static_cast<std::uint64_t>(static_cast<unsigned __int128>(frame) * batch * rate / fastest);
+}
+
+struct Rates {
+    std::uint64_t batch;
+    std::uint64_t rates[3];
+};
+
+// Rates that don't divide each other, so frames get uneven sample counts
+constexpr Rates unevenRates[] = {
+    {10, {100, 200, 200}},
+    {7, {333, 1000, 77}},
+    {1, {1000, 999, 1}},
+    {64, {48000, 44100, 3}},
+    {13, {9973, 7919, 104729}},
+};
+
+} // namespace
+
+// Summed frame by frame the generator sends exactly what is due, no sample lost or
+// doubled to rounding, and every frame carries its share give or take one sample
+TEST(LoadProfile, FramesAddUpToSamplesDue) {
+    for (const Rates& r : unevenRates) {
+        const std::uint64_t fastest = std::max({r.rates[0], r.rates[1], r.rates[2]});
+        for (std::uint64_t rate : r.rates) {
+            SCOPED_TRACE(testing::Message() << "batch " << r.batch << ", rate " << rate << " of " << fastest);
+            const double share = static_cast<double>(r.batch) * rate / fastest;
+            std::uint64_t emitted = 0;
+            for (std::uint64_t frame = 1; frame <= 3 * fastest + 17; ++frame) {
+                const std::uint64_t due = loadSamplesDue(frame, r.batch, rate, fastest);
+                ASSERT_EQ(due, reference(frame, r.batch, rate, fastest)) << "frame " << frame;
+                const std::uint64_t count = due - emitted;
+                ASSERT_LE(static_cast<double>(count), share + 1.0) << "frame " << frame;
+                ASSERT_GE(static_cast<double>(count), share - 1.0) << "frame " << frame;
+                emitted = due;
+            }
+            // Every 'fastest' frames cover 'batch' whole seconds
+            EXPECT_EQ(loadSamplesDue(fastest, r.batch, rate, fastest), r.batch * rate);
+        }
+    }
+}
+
+// Years of frames at high rates still come out exact
+TEST(LoadProfile, SamplesDueDoesNotOverflow) {
+    const std::uint64_t fastest = 100000;
+    const std::uint64_t batch = 10000;
+    for (std::uint64_t frame : {std::uint64_t(1) << 40, (std::uint64_t(1) << 44) + 12345}) {
+        EXPECT_EQ(loadSamplesDue(frame, batch, 99991, fastest), reference(frame, batch, 99991, fastest));
+    }
+}
+
+TEST(LoadProfile, LoadGoesThroughTheSocketByDefault) {
+    EXPECT_EQ(AppConfig{}.loadTarget, LoadTarget::Socket);
+    EXPECT_EQ(parseLoadTarget("direct"), LoadTarget::Direct);
+    EXPECT_THROW(parseLoadTarget("udp"), std::invalid_argument);
+}
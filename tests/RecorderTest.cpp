@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "Recorder.h"
+#include "RecordingReader.h"
+
+namespace {
+
+// 'count' samples 1 ms apart from 'start', with x counting up from 'first'
+SensorSamples makeSamples(std::size_t count, double start, std::size_t first = 0) {
+    SensorSamples samples;
+    samples.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        samples.t[i] = start + static_cast<double>(first + i) * 1e-3;
+        samples.x[i] = static_cast<float>(first + i);
+        samples.y[i] = 0.0f;
+        samples.z[i] = 1.0f;
+    }
+    return samples;
+}
+
+// Every sample of one track, in file order
+SensorSamples readTrack(const RecordingReader& reader, const RecordingReader::Track& track) {
+    SensorSamples all, block;
+    for (const auto& b : track.blocks) {
+        EXPECT_TRUE(reader.decodeBlock(b, 0.0, block));
+        const std::size_t offset = all.count;
+        all.resize(offset + block.count);
+        std::copy(block.t.begin(), block.t.begin() + block.count, all.t.begin() + offset);
+        std::copy(block.x.begin(), block.x.begin() + block.count, all.x.begin() + offset);
+    }
+    return all;
+}
+
+class RecorderTest : public ::testing::Test {
+protected:
+    void TearDown() override { std::remove(path.c_str()); }
+    const std::string path = ::testing::TempDir() + "imu_recorder_test.imurec";
+};
+
+} // namespace
+
+// Whatever is still queued or sitting in a column when the recorder goes away ends up in the file
+TEST_F(RecorderTest, DestructorFlushesQueuedSamples) {
+    {
+        Recorder recorder(path);
+        auto left = recorder.openStream("left");
+        auto right = recorder.openStream("right");
+        left->write(RecordSensor::Gyro, makeSamples(100, 1.0));
+        left->write(RecordSensor::Accel, makeSamples(5000, 1.0));
+        right->write(RecordSensor::Mag, makeSamples(7, 2.0));
+        // Neither stream is closed
+    }
+
+    RecordingReader reader(path);
+    ASSERT_EQ(reader.devices().size(), 2u);
+    EXPECT_EQ(reader.devices()[0], "left");
+    EXPECT_EQ(reader.devices()[1], "right");
+    ASSERT_EQ(reader.tracks().size(), 3u);
+
+    std::size_t counts[recordSensorCount] = {};
+    for (const auto& track : reader.tracks()) {
+        counts[static_cast<std::size_t>(track.sensor)] += readTrack(reader, track).count;
+    }
+    EXPECT_EQ(counts[0], 100u);
+    EXPECT_EQ(counts[1], 5000u);
+    EXPECT_EQ(counts[2], 7u);
+}
+
+// A full queue drops the rest of a write and counts it; everything else is recorded in order
+TEST_F(RecorderTest, FullQueueDropsAndCountsSamples) {
+    const std::size_t batch = 4 * Recorder::streamQueueChunks * Recorder::chunkSamples;
+    std::uint64_t sent = 0;
+    std::uint64_t dropped = 0;
+    {
+        Recorder recorder(path);
+        auto stream = recorder.openStream("imu");
+
+        // Writes of four queues' worth at a time outrun the writer thread
+        bool overflowed = false;
+        for (int i = 0; i < 32 && !overflowed; ++i) {
+            const SensorSamples samples = makeSamples(batch, 0.0, sent);
+            const std::uint64_t before = stream->droppedSamples();
+            overflowed = !stream->write(RecordSensor::Gyro, samples);
+            EXPECT_EQ(overflowed, stream->droppedSamples() > before);
+            sent += samples.count;
+        }
+        ASSERT_TRUE(overflowed);
+        dropped = stream->droppedSamples();
+        EXPECT_EQ(recorder.droppedSamples(), dropped);
+        stream->close();
+    }
+
+    RecordingReader reader(path);
+    ASSERT_EQ(reader.tracks().size(), 1u);
+    const SensorSamples recorded = readTrack(reader, reader.tracks()[0]);
+    EXPECT_EQ(recorded.count + dropped, sent);
+    // Each write keeps a prefix of its samples, so what is left stays in order
+    for (std::size_t i = 1; i < recorded.count; ++i) {
+        ASSERT_GT(recorded.x[i], recorded.x[i - 1]) << "at " << i;
+    }
+}
+
+// A recording cut off mid-block, as after a crash, still reads up to the last whole block
+TEST_F(RecorderTest, TruncatedRecordingKeepsWholeBlocks) {
+    const std::size_t count = 3 * recordBlockSamples + 100;
+    {
+        Recorder recorder(path);
+        auto stream = recorder.openStream("imu");
+        ASSERT_TRUE(stream->write(RecordSensor::Accel, makeSamples(count, 0.0)));
+        stream->close();
+    }
+    // The last block holds the 100 leftover samples; cut into it
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 200);
+
+    RecordingReader reader(path);
+    ASSERT_EQ(reader.tracks().size(), 1u);
+    ASSERT_EQ(reader.tracks()[0].blocks.size(), 3u);
+    const SensorSamples recorded = readTrack(reader, reader.tracks()[0]);
+    ASSERT_EQ(recorded.count, 3 * recordBlockSamples);
+    for (std::size_t i = 0; i < recorded.count; ++i) {
+        ASSERT_EQ(recorded.x[i], static_cast<float>(i));
+    }
+    EXPECT_NEAR(recorded.t[recorded.count - 1], (3 * recordBlockSamples - 1) * 1e-3, 1e-6);
+}
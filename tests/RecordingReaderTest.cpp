@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "ByteOrder.h"
+#include "Recorder.h"
+#include "RecordingReader.h"
+
+namespace {
+
+const std::string deviceId = "imu";
+
+// Records one gyro block of 'count' samples 1 ms apart and returns the file contents
+std::vector<std::uint8_t> recordGyro(const std::string& path, std::size_t count) {
+    {
+        Recorder recorder(path);
+        auto stream = recorder.openStream(deviceId);
+        SensorSamples samples;
+        samples.resize(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            samples.t[i] = 1.0 + i * 1e-3;
+            samples.x[i] = static_cast<float>(i);
+            samples.y[i] = -static_cast<float>(i);
+            samples.z[i] = 0.5f;
+        }
+        stream->write(RecordSensor::Gyro, samples);
+        stream->close();
+    }
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<std::uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const std::string& path, const std::vector<std::uint8_t>& bytes) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+// Offset of the first block payload: file header, then the device record
+std::size_t blockPayload() {
+    return recordingFileHeaderSize + recordHeaderSize + 4 + deviceId.size() + recordHeaderSize;
+}
+
+class RecordingReaderTest : public ::testing::Test {
+protected:
+    void TearDown() override { std::remove(path.c_str()); }
+    const std::string path = ::testing::TempDir() + "imu_recording_test.imurec";
+};
+
+} // namespace
+
+TEST_F(RecordingReaderTest, DecodesRecordedBlock) {
+    recordGyro(path, 100);
+    RecordingReader reader(path);
+    ASSERT_EQ(reader.devices().size(), 1u);
+    EXPECT_EQ(reader.devices()[0], deviceId);
+    ASSERT_EQ(reader.tracks().size(), 1u);
+    ASSERT_EQ(reader.tracks()[0].blocks.size(), 1u);
+
+    SensorSamples samples;
+    ASSERT_TRUE(reader.decodeBlock(reader.tracks()[0].blocks[0], 0.0, samples));
+    ASSERT_EQ(samples.count, 100u);
+    EXPECT_NEAR(samples.t[99], 1.099, 1e-6);
+    EXPECT_EQ(samples.x[42], 42.0f);
+    EXPECT_EQ(samples.y[42], -42.0f);
+}
+
+TEST_F(RecordingReaderTest, SkipsBlockWhoseCountExceedsPayload) {
+    std::vector<std::uint8_t> bytes = recordGyro(path, 100);
+    storeU32(bytes.data() + blockPayload() + 8, 0x40000000);
+    writeFile(path, bytes);
+
+    RecordingReader reader(path);
+    EXPECT_TRUE(reader.tracks().empty());
+}
+
+TEST_F(RecordingReaderTest, SkipsBlockWhoseDeltaSectionExceedsPayload) {
+    std::vector<std::uint8_t> bytes = recordGyro(path, 100);
+    storeU32(bytes.data() + blockPayload() + 28, 0xFFFFFFF0);
+    writeFile(path, bytes);
+
+    RecordingReader reader(path);
+    EXPECT_TRUE(reader.tracks().empty());
+}
+
+TEST_F(RecordingReaderTest, RejectsUnterminatedTimestampDeltas) {
+    std::vector<std::uint8_t> bytes = recordGyro(path, 100);
+    const std::size_t deltas = blockPayload() + blockHeaderSize;
+    const std::uint32_t deltaBytes = loadU32(bytes.data() + blockPayload() + 28);
+    for (std::size_t i = 0; i < deltaBytes; ++i) {
+        bytes[deltas + i] = 0x80; // Every varint continues into the next byte
+    }
+    writeFile(path, bytes);
+
+    RecordingReader reader(path);
+    ASSERT_EQ(reader.tracks().size(), 1u);
+    SensorSamples samples;
+    EXPECT_FALSE(reader.decodeBlock(reader.tracks()[0].blocks[0], 0.0, samples));
+    EXPECT_EQ(samples.count, 0u);
+}
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "SimdStats.h"
+
+namespace {
+
+std::vector<float> randomSamples(std::size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0.3f, 2.0f);
+    std::vector<float> data(n);
+    for (float& v : data) v = noise(rng);
+    return data;
+}
+
+} // namespace
+
+// Lengths around the 8/16 float vector steps and the 512 float blocks, so every kernel
+// goes through its tail handling
+TEST(SimdStats, KernelsAgreeWithScalarOnOddLengthsAndTails) {
+    const std::vector<AxisStatsKernel> kernels = axisStatsKernels();
+    ASSERT_FALSE(kernels.empty());
+    ASSERT_STREQ(kernels[0].name, "scalar");
+
+    for (std::size_t n : {1, 3, 7, 8, 9, 15, 16, 17, 31, 33, 511, 512, 513, 1000, 4097, 100003}) {
+        const std::vector<float> data = randomSamples(n, static_cast<unsigned>(n));
+        const AxisStats expected = kernels[0].compute(data.data(), n);
+        for (const auto& kernel : kernels) {
+            SCOPED_TRACE(testing::Message() << kernel.name << ", n = " << n);
+            const AxisStats stats = kernel.compute(data.data(), n);
+            EXPECT_EQ(stats.min, expected.min);
+            EXPECT_EQ(stats.max, expected.max);
+            EXPECT_NEAR(stats.mean, expected.mean, 1e-5 * (1.0 + std::abs(expected.mean)));
+            EXPECT_NEAR(stats.rms, expected.rms, 1e-5 * expected.rms);
+        }
+    }
+}
+
+TEST(SimdStats, ExtremesInTheTailAreFound) {
+    for (const auto& kernel : axisStatsKernels()) {
+        SCOPED_TRACE(kernel.name);
+        std::vector<float> data(37, 1.0f);
+        data[36] = 9.0f;
+        data[35] = -4.0f;
+        const AxisStats stats = kernel.compute(data.data(), data.size());
+        EXPECT_EQ(stats.min, -4.0f);
+        EXPECT_EQ(stats.max, 9.0f);
+    }
+}
+
+TEST(SimdStats, MatchesClosedForm) {
+    std::vector<float> data{3.0f, -4.0f, 3.0f, -4.0f, 3.0f};
+    const AxisStats stats = computeAxisStats(data.data(), data.size());
+    EXPECT_EQ(stats.min, -4.0f);
+    EXPECT_EQ(stats.max, 3.0f);
+    EXPECT_DOUBLE_EQ(stats.mean, 1.0 / 5.0);
+    EXPECT_DOUBLE_EQ(stats.rms, std::sqrt(59.0 / 5.0));
+    EXPECT_EQ(computeAxisStats(data.data(), 0).rms, 0.0);
+}
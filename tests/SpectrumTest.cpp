@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "AppConfig.h"
+#include "DeviceRegistry.h"
+#include "Fft.h"
+#include "SpectrumWorker.h"
+#include "TaskPool.h"
+
+namespace {
+
+const double pi = std::acos(-1.0);
+
+std::size_t peakBin(const std::vector<float>& db) {
+    return static_cast<std::size_t>(std::max_element(db.begin() + 1, db.end()) - db.begin());
+}
+
+} // namespace
+
+TEST(Fft, PureTonePeaksInItsBin) {
+    Fft fft(1024);
+    std::vector<float> frame(fft.size()), db(fft.bins());
+    for (std::size_t bin : {1, 37, 64, 200, 511}) {
+        SCOPED_TRACE(bin);
+        for (std::size_t i = 0; i < frame.size(); ++i) {
+            frame[i] = 0.5f + static_cast<float>(std::sin(2.0 * pi * bin * i / frame.size()));
+        }
+        fft.amplitudeDb(frame.data(), db.data());
+        EXPECT_EQ(peakBin(db), bin);
+        EXPECT_NEAR(db[bin], 0.0f, 0.1f); // Unit sine reads 0 dB, the offset is removed
+        EXPECT_LT(db[0], -60.0f);
+    }
+}
+
+TEST(Fft, RejectsSizesThatAreNotPowersOfTwo) {
+    EXPECT_THROW(Fft(1000), std::invalid_argument);
+    EXPECT_THROW(Fft(2), std::invalid_argument);
+}
+
+// A tone appended to a device's buffer shows up in the spectrogram the worker builds
+TEST(SpectrumWorker, ToneInBufferPeaksInExpectedBin) {
+    AppConfig config;
+    config.accelFreq = 1024;
+    config.historySeconds = 0;
+    DeviceRegistry registry(config);
+    DeviceBuffers* device = registry.connect("tone");
+    ASSERT_NE(device, nullptr);
+
+    TaskPool pool(1);
+    const std::size_t fftSize = 256;
+    SpectrumWorker worker(registry, pool, fftSize, 16);
+
+    // 96 Hz at 1024 Hz lands in bin 96 / 1024 * 256 = 24
+    const double frequency = 96.0;
+    std::vector<double> t(fftSize);
+    std::vector<float> x(fftSize), y(fftSize, 0.0f), z(fftSize, 0.0f);
+    for (std::size_t i = 0; i < fftSize; ++i) {
+        t[i] = static_cast<double>(i) / config.accelFreq;
+        x[i] = static_cast<float>(std::sin(2.0 * pi * frequency * t[i]));
+    }
+    device->accel.append(t.data(), x.data(), y.data(), z.data(), fftSize);
+
+    const Spectrogram* spectrogram = nullptr;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (std::chrono::steady_clock::now() < deadline) {
+        spectrogram = worker.spectrogram(*device, RecordSensor::Accel, 0);
+        if (spectrogram && spectrogram->frames() > 0) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_NE(spectrogram, nullptr);
+    ASSERT_EQ(spectrogram->frames(), 1u);
+
+    std::vector<float> db(spectrogram->bins());
+    ASSERT_TRUE(spectrogram->readFrame(0, db.data()));
+    EXPECT_EQ(peakBin(db), 24u);
+}
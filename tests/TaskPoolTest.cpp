@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "TaskPool.h"
+
+TEST(TaskPool, ParallelForCallsEveryIndexOnce) {
+    TaskPool pool(4);
+    std::vector<std::atomic<int>> calls(1000);
+    pool.parallelFor(calls.size(), [&](std::size_t i) { calls[i].fetch_add(1); });
+    for (std::size_t i = 0; i < calls.size(); ++i) {
+        EXPECT_EQ(calls[i].load(), 1) << "index " << i;
+    }
+}
+
+TEST(TaskPool, NestedParallelForFinishes) {
+    TaskPool pool(2);
+    std::atomic<int> calls{0};
+    pool.parallelFor(8, [&](std::size_t) {
+        pool.parallelFor(8, [&](std::size_t) { calls.fetch_add(1); });
+    });
+    EXPECT_EQ(calls.load(), 64);
+}
+
+// The exception comes out of parallelFor() only after every helper is done with the
+// frame it points into, and the pool keeps working afterwards
+TEST(TaskPool, ParallelForRethrowsAfterHelpersFinish) {
+    TaskPool pool(4);
+    std::atomic<bool> returned{false};
+    std::atomic<int> lateCalls{0};
+    try {
+        pool.parallelFor(64, [&](std::size_t i) {
+            if (i == 3) {
+                throw std::runtime_error("index 3");
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            if (returned.load()) {
+                lateCalls.fetch_add(1);
+            }
+        });
+        FAIL() << "parallelFor() didn't throw";
+    } catch (const std::runtime_error& e) {
+        returned.store(true);
+        EXPECT_STREQ(e.what(), "index 3");
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(lateCalls.load(), 0);
+
+    std::atomic<int> calls{0};
+    pool.parallelFor(100, [&](std::size_t) { calls.fetch_add(1); });
+    EXPECT_EQ(calls.load(), 100);
+}
+
+TEST(TaskPool, EveryThrowingCallGivesOneException) {
+    TaskPool pool(3);
+    for (int round = 0; round < 20; ++round) {
+        EXPECT_THROW(pool.parallelFor(16, [](std::size_t) { throw std::logic_error("all"); }), std::logic_error);
+    }
+}
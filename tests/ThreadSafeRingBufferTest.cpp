@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "ThreadSafeRingBuffer.h"
+
+namespace {
+
+// Every field of sample i is derived from i, so a snapshot mixing old and new
+// slots shows up as a break in the sequence
+float valueOf(std::uint64_t i, int axis) {
+    return static_cast<float>((i * (axis + 1)) & 0xFFFFF);
+}
+
+template <typename Buffer>
+void appendSequence(Buffer& buffer, std::uint64_t first, std::size_t len) {
+    double t[64];
+    float x[64], y[64], z[64];
+    for (std::size_t k = 0; k < len; ++k) {
+        t[k] = static_cast<double>(first + k);
+        x[k] = valueOf(first + k, 0);
+        y[k] = valueOf(first + k, 1);
+        z[k] = valueOf(first + k, 2);
+    }
+    buffer.append(t, x, y, z, len);
+}
+
+// Returns the number of snapshots that weren't one consecutive run of samples
+template <typename Buffer>
+std::uint64_t countTornSnapshots(const std::vector<double>& t, const std::vector<float>& x,
+                                 const std::vector<float>& y, const std::vector<float>& z) {
+    for (std::size_t k = 0; k < t.size(); ++k) {
+        const auto i = static_cast<std::uint64_t>(t[k]);
+        if ((k > 0 && t[k] != t[k - 1] + 1.0) ||
+            x[k] != valueOf(i, 0) || y[k] != valueOf(i, 1) || z[k] != valueOf(i, 2)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Writer appends unpaced batches of varying length (far above 10 kHz) while the
+// reader takes snapshots; every snapshot must be a consistent run of samples
+template <typename Buffer>
+void stressSnapshots(Buffer& buffer, std::size_t window) {
+    std::atomic<bool> running{true};
+    std::thread writer([&]() {
+        std::uint64_t next = 0;
+        std::size_t len = 1;
+        while (running.load(std::memory_order_relaxed)) {
+            appendSequence(buffer, next, len);
+            next += len;
+            len = len % 37 + 1;
+        }
+    });
+
+    std::vector<double> t(window);
+    std::vector<float> x(window), y(window), z(window);
+    std::uint64_t snapshots = 0, torn = 0;
+    const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
+    while (std::chrono::steady_clock::now() < until) {
+        if (buffer.readRecent(window, t.data(), x.data(), y.data(), z.data())) {
+            torn += countTornSnapshots<Buffer>(t, x, y, z);
+            ++snapshots;
+        }
+    }
+    running = false;
+    writer.join();
+
+    EXPECT_GT(snapshots, 0u);
+    EXPECT_EQ(torn, 0u) << "out of " << snapshots << " snapshots";
+    EXPECT_GT(buffer.written(), 5000u) << "writer should run well above 10 kHz";
+}
+
+} // namespace
+
+TEST(ThreadSafeRingBuffer, ReadRecentReturnsNewestSamplesAcrossWrap) {
+    ThreadSafeRingBuffer<> buffer(1024);
+    const std::size_t capacity = buffer.capacity();
+    std::uint64_t next = 0;
+    while (next < 3 * capacity + 17) {
+        appendSequence(buffer, next, 50);
+        next += 50;
+    }
+
+    std::vector<double> t(capacity);
+    std::vector<float> x(capacity), y(capacity), z(capacity);
+    ASSERT_TRUE(buffer.readRecent(capacity, t.data(), x.data(), y.data(), z.data()));
+    EXPECT_EQ(t.back(), static_cast<double>(next - 1));
+    EXPECT_EQ(t.front(), static_cast<double>(next - capacity));
+    EXPECT_EQ((countTornSnapshots<ThreadSafeRingBuffer<>>(t, x, y, z)), 0u);
+    EXPECT_EQ(buffer.size(), capacity);
+}
+
+TEST(ThreadSafeRingBuffer, ReadRecentFailsBeforeEnoughSamples) {
+    ThreadSafeRingBuffer<> buffer(1024);
+    appendSequence(buffer, 0, 10);
+    std::vector<double> t(20);
+    std::vector<float> x(20), y(20), z(20);
+    EXPECT_FALSE(buffer.readRecent(20, t.data(), x.data(), y.data(), z.data()));
+    EXPECT_TRUE(buffer.readRecent(10, t.data(), x.data(), y.data(), z.data()));
+}
+
+TEST(ThreadSafeRingBuffer, ReadSinceSkipsLappedCursor) {
+    ThreadSafeRingBuffer<> buffer(1024);
+    const std::size_t capacity = buffer.capacity();
+    std::uint64_t next = 0;
+    while (next < 2 * capacity) {
+        appendSequence(buffer, next, 64);
+        next += 64;
+    }
+
+    std::uint64_t cursor = 0;
+    std::vector<double> t(capacity);
+    std::vector<float> x(capacity), y(capacity), z(capacity);
+    std::size_t n = buffer.readSince(cursor, capacity, t.data(), x.data(), y.data(), z.data());
+    EXPECT_EQ(n, capacity);
+    EXPECT_EQ(t.front(), static_cast<double>(next - capacity));
+    EXPECT_EQ(cursor, next);
+    EXPECT_EQ(buffer.readSince(cursor, capacity, t.data(), x.data(), y.data(), z.data()), 0u);
+}
+
+// Contention stress tests: no torn reads while the writer laps the reader
+
+TEST(ThreadSafeRingBuffer, NoTornSnapshotsUnderContentionMirrored) {
+    ThreadSafeRingBuffer<> buffer(4096);
+    stressSnapshots(buffer, 3500);
+}
+
+TEST(ThreadSafeRingBuffer, NoTornSnapshotsUnderContentionFallback) {
+    // 1000 floats don't fill whole pages, so every sample is stored twice
+    ThreadSafeRingBuffer<1000> buffer;
+    ASSERT_FALSE(buffer.isDoubleMapped());
+    stressSnapshots(buffer, 900);
+}
+
+TEST(ThreadSafeRingBuffer, DecimatedSpanKeepsSpikes) {
+    ThreadSafeRingBuffer<> buffer(1 << 16);
+    std::vector<double> t(64);
+    std::vector<float> x(64, 0.0f), y(64, 0.0f), z(64, 0.0f);
+    for (std::uint64_t n = 0; n < buffer.capacity(); n += 64) {
+        for (std::size_t k = 0; k < 64; ++k) {
+            t[k] = static_cast<double>(n + k) * 1e-3;
+            x[k] = n + k == 40000 ? 100.0f : 0.0f;
+        }
+        buffer.append(t.data(), x.data(), y.data(), z.data(), 64);
+    }
+
+    const std::size_t buckets = 100;
+    const std::size_t points = buffer.maxDecimatedPoints(buckets);
+    std::vector<double> dt(points);
+    std::vector<float> dx(points), dy(points), dz(points);
+    const std::size_t count = buffer.readDecimatedSpan(60.0, buckets, dt.data(), dx.data(), dy.data(), dz.data());
+    ASSERT_GT(count, 0u);
+    EXPECT_LE(count, 4 * buckets);
+    EXPECT_EQ(*std::max_element(dx.begin(), dx.begin() + count), 100.0f);
+    EXPECT_DOUBLE_EQ(dt[count - 1], static_cast<double>(buffer.capacity() - 1) * 1e-3);
+}
+
+TEST(ThreadSafeRingBuffer, RoundsCapacityOnlyWhenPaddingIsSmall) {
+    const std::size_t page = RingChannel<float>::pageSize() / sizeof(float);
+    EXPECT_EQ(ThreadSafeRingBuffer<>::roundedCapacity(500), 500u);
+    EXPECT_EQ(ThreadSafeRingBuffer<>::roundedCapacity(page), page);
+    EXPECT_EQ(ThreadSafeRingBuffer<>::roundedCapacity(60 * page - 3), 60 * page);
+
+    ThreadSafeRingBuffer<> small(500);
+    EXPECT_EQ(small.capacity(), 500u);
+    ThreadSafeRingBuffer<> large(60 * page - 3);
+    EXPECT_EQ(large.capacity(), 60 * page);
+    EXPECT_EQ(large.memoryBytes(), ThreadSafeRingBuffer<>::memoryBytesFor(60 * page - 3));
+}
@@ -0,0 +1,236 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "AppConfig.h"
+#include "DeviceRegistry.h"
+#include "TriggerEngine.h"
+#include "TriggerKernels.h"
+
+namespace {
+
+constexpr TriggerKind allKinds[] = {TriggerKind::Threshold, TriggerKind::Rising, TriggerKind::Falling,
+                                    TriggerKind::Magnitude};
+
+// Every edge in [0, n), found one sample at a time
+std::vector<std::size_t> referenceEdges(TriggerKind kind, const float* x, const float* y, const float* z,
+                                        std::size_t n, float threshold, bool previous) {
+    std::vector<std::size_t> edges;
+    for (std::size_t i = 0; i < n; ++i) {
+        const bool holds = triggerHolds(kind, x[i], y[i], z[i], threshold);
+        if (holds && !previous) {
+            edges.push_back(i);
+        }
+        previous = holds;
+    }
+    return edges;
+}
+
+// Every edge in [0, n), searching on from each one like TriggerEngine::Stream does
+std::vector<std::size_t> kernelEdges(const TriggerEdgeKernel& kernel, TriggerKind kind, const float* x,
+                                     const float* y, const float* z, std::size_t n, float threshold, bool previous) {
+    std::vector<std::size_t> edges;
+    std::size_t start = 0;
+    while (start < n) {
+        const std::size_t i = start + kernel.find[static_cast<int>(kind)](x + start, y + start, z + start, n - start,
+                                                                          threshold, previous);
+        if (i >= n) {
+            break;
+        }
+        edges.push_back(i);
+        previous = true;
+        start = i + 1;
+    }
+    return edges;
+}
+
+std::vector<float> randomSamples(std::size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    std::vector<float> data(n);
+    for (float& v : data) v = noise(rng);
+    return data;
+}
+
+} // namespace
+
+// Lengths around the 4/8 float vector steps, so every kernel goes through its tail
+TEST(TriggerKernels, KernelsAgreeWithScalarReference) {
+    const std::vector<TriggerEdgeKernel> kernels = triggerEdgeKernels();
+    ASSERT_STREQ(kernels[0].name, "scalar");
+
+    for (std::size_t n : {1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 33, 1000, 4099}) {
+        const std::vector<float> x = randomSamples(n, static_cast<unsigned>(n));
+        const std::vector<float> y = randomSamples(n, static_cast<unsigned>(n) + 1);
+        const std::vector<float> z = randomSamples(n, static_cast<unsigned>(n) + 2);
+        for (TriggerKind kind : allKinds) {
+            // Falling holds below the threshold, so it gets a negative one to keep edges sparse
+            for (float threshold : {0.5f, 1.5f, 2.5f}) {
+                const float limit = kind == TriggerKind::Falling ? -threshold : threshold;
+                for (bool previous : {false, true}) {
+                    const auto expected =
+                        referenceEdges(kind, x.data(), y.data(), z.data(), n, limit, previous);
+                    for (const auto& kernel : kernels) {
+                        SCOPED_TRACE(testing::Message() << kernel.name << ", " << triggerKindName(kind)
+                                                        << ", n = " << n << ", threshold = " << limit
+                                                        << ", previous = " << previous);
+                        EXPECT_EQ(kernelEdges(kernel, kind, x.data(), y.data(), z.data(), n, limit, previous),
+                                  expected);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// A single spike at every position of a short vector and its tail
+TEST(TriggerKernels, SingleSpikeIsFoundAnywhere) {
+    constexpr std::size_t n = 19;
+    for (const auto& kernel : triggerEdgeKernels()) {
+        for (std::size_t spike = 0; spike < n; ++spike) {
+            SCOPED_TRACE(testing::Message() << kernel.name << ", spike at " << spike);
+            std::vector<float> x(n, 0.0f), y(n, 0.0f), z(n, 0.0f);
+            x[spike] = -3.0f;
+            y[spike] = 3.0f;
+            const auto find = [&](TriggerKind kind, float threshold, bool previous) {
+                return kernel.find[static_cast<int>(kind)](x.data(), y.data(), z.data(), n, threshold, previous);
+            };
+            EXPECT_EQ(find(TriggerKind::Threshold, 2.0f, false), spike);
+            EXPECT_EQ(find(TriggerKind::Rising, 2.0f, false), n);
+            EXPECT_EQ(find(TriggerKind::Falling, -2.0f, false), spike);
+            EXPECT_EQ(find(TriggerKind::Magnitude, 4.0f, false), spike);
+            // Holding on the sample before x[0] hides a spike at 0 only
+            EXPECT_EQ(find(TriggerKind::Threshold, 2.0f, true), spike == 0 ? n : spike);
+        }
+    }
+}
+
+namespace {
+
+constexpr int gyroHz = 500;
+constexpr int accelHz = 1000;
+constexpr int magHz = 100;
+constexpr double triggerAt = 5.0;
+
+AppConfig captureConfig() {
+    AppConfig config;
+    config.gyroFreq = gyroHz;
+    config.accelFreq = accelHz;
+    config.magFreq = magHz;
+    config.bufferSeconds = 10;
+    config.historySeconds = 0;
+    config.triggerPreSeconds = 1.0;
+    config.triggerPostSeconds = 0.5;
+    return config;
+}
+
+// Eight seconds in 100 ms batches, accel x steps from 0 to 1 at triggerAt. Either
+// whole batches go through the stream, or each sensor on its own like replays do.
+void feed(DeviceBuffers& device, TriggerEngine::Stream& stream, bool perSensor) {
+    const int rates[3] = {gyroHz, accelHz, magHz};
+    ThreadSafeRingBuffer<>* buffers[3] = {&device.gyro, &device.accel, &device.mag};
+    ImuBatch batch;
+    SensorSamples* sensors[3] = {&batch.gyro, &batch.accel, &batch.mag};
+    for (int frame = 0; frame < 80; ++frame) {
+        for (int s = 0; s < 3; ++s) {
+            const int perFrame = rates[s] / 10;
+            SensorSamples& samples = *sensors[s];
+            samples.resize(perFrame);
+            for (int i = 0; i < perFrame; ++i) {
+                samples.t[i] = static_cast<double>(frame * perFrame + i) / rates[s];
+                samples.x[i] = s == 1 && samples.t[i] >= triggerAt ? 1.0f : 0.0f;
+                samples.y[i] = 0.0f;
+                samples.z[i] = 0.0f;
+            }
+            buffers[s]->append(samples.t.data(), samples.x.data(), samples.y.data(), samples.z.data(), perFrame);
+            if (perSensor) {
+                stream.process(static_cast<RecordSensor>(s), samples.t.data(), samples.x.data(), samples.y.data(),
+                               samples.z.data(), samples.count);
+            }
+        }
+        if (perSensor) {
+            stream.completeCaptures();
+        } else {
+            stream.process(batch);
+        }
+    }
+}
+
+} // namespace
+
+class TriggerCaptureTest : public ::testing::TestWithParam<bool> {};
+
+// The capture holds exactly the pre/post window of every sensor around the trigger
+TEST_P(TriggerCaptureTest, WindowCoversPreAndPostTime) {
+    const AppConfig config = captureConfig();
+    DeviceRegistry registry(config);
+    DeviceBuffers* device = registry.connect("trigger-test");
+    ASSERT_NE(device, nullptr);
+
+    TriggerEngine engine(config, 4);
+    TriggerCondition condition;
+    condition.sensor = RecordSensor::Accel;
+    condition.kind = TriggerKind::Rising;
+    condition.threshold = 0.5f;
+    engine.setConditions({condition});
+    feed(*device, *engine.openStream(*device), GetParam());
+
+    std::vector<TriggerEngine::Event> events;
+    engine.events(events);
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].time, triggerAt);
+    EXPECT_EQ(events[0].value, 1.0f);
+
+    TriggerEngine::Capture capture;
+    engine.prepareCapture(capture);
+    ASSERT_TRUE(engine.readCapture(events[0], capture));
+    const int rates[3] = {gyroHz, accelHz, magHz};
+    for (std::size_t s = 0; s < recordSensorCount; ++s) {
+        SCOPED_TRACE(testing::Message() << "sensor " << s);
+        const TriggerEngine::Window& window = capture.sensors[s];
+        const double period = 1.0 / rates[s];
+        const double from = triggerAt - engine.preSeconds();
+        const double to = triggerAt + engine.postSeconds();
+        ASSERT_GT(window.count, 0u);
+        EXPECT_GE(window.t[0], from - 1e-9);
+        EXPECT_LT(window.t[0], from + period);
+        EXPECT_LE(window.t[window.count - 1], to + 1e-9);
+        EXPECT_GT(window.t[window.count - 1], to - period);
+        EXPECT_NEAR(static_cast<double>(window.count), (to - from) * rates[s] + 1, 1.0);
+    }
+    EXPECT_EQ(capture.sensors[1].count, 1501u);
+}
+
+INSTANTIATE_TEST_SUITE_P(Ingest, TriggerCaptureTest, ::testing::Values(false, true),
+                         [](const ::testing::TestParamInfo<bool>& info) {
+                             return info.param ? "PerSensor" : "WholeBatch";
+                         });
+
+// Copying into a prepared capture reuses its buffers
+TEST(TriggerEngine, ReadCaptureReusesCallerBuffers) {
+    const AppConfig config = captureConfig();
+    DeviceRegistry registry(config);
+    DeviceBuffers* device = registry.connect("trigger-test");
+    TriggerEngine engine(config, 2);
+    TriggerCondition condition;
+    condition.sensor = RecordSensor::Accel;
+    condition.kind = TriggerKind::Rising;
+    condition.threshold = 0.5f;
+    engine.setConditions({condition});
+    feed(*device, *engine.openStream(*device), false);
+
+    std::vector<TriggerEngine::Event> events;
+    engine.events(events);
+    ASSERT_EQ(events.size(), 1u);
+    TriggerEngine::Capture capture;
+    engine.prepareCapture(capture);
+    const float* before[recordSensorCount];
+    for (std::size_t s = 0; s < recordSensorCount; ++s) before[s] = capture.sensors[s].x.data();
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(engine.readCapture(events[0], capture));
+    }
+    for (std::size_t s = 0; s < recordSensorCount; ++s) {
+        EXPECT_EQ(capture.sensors[s].x.data(), before[s]);
+    }
+}
@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+
+#include "AppConfig.h"
+#include "DeviceRegistry.h"
+#include "ImuMessage.h"
+#include "WebSocketServer.h"
+
+namespace websocket = boost::beast::websocket;
+
+namespace {
+
+// Server on an ephemeral port with one connected client
+class WebSocketSessionTest : public ::testing::Test {
+protected:
+    void start(const std::string& target = "/test-device") {
+        config.port = 0;
+        config.historySeconds = 0;
+        registry = std::make_unique<DeviceRegistry>(config);
+        server = std::make_unique<WebSocketServer>(ioc, config.port, *registry, nullptr, nullptr);
+        server->run();
+        ioThread = std::thread([this]() { ioc.run(); });
+
+        ws.next_layer().connect(tcp::endpoint(net::ip::address_v4::loopback(), server->port()));
+        ws.handshake("localhost", target);
+        device = registry->devices().front();
+    }
+
+    // Opens another client connection, returning the handshake error if the server refuses it
+    boost::beast::error_code connectClient(websocket::stream<tcp::socket>& client, const std::string& target) {
+        client.next_layer().connect(tcp::endpoint(net::ip::address_v4::loopback(), server->port()));
+        boost::beast::error_code ec;
+        client.handshake("localhost", target, ec);
+        return ec;
+    }
+
+    void TearDown() override {
+        if (ioThread.joinable()) {
+            boost::beast::error_code ignored;
+            ws.close(websocket::close_code::normal, ignored);
+            ioc.stop();
+            ioThread.join();
+        }
+    }
+
+    void sendBinary(const ImuBatch& batch) {
+        std::vector<std::uint8_t> frame;
+        encodeBinaryFrame(batch, frame);
+        ws.binary(true);
+        ws.write(net::buffer(frame));
+    }
+
+    void sendText(const std::string& text) {
+        ws.text(true);
+        ws.write(net::buffer(text));
+    }
+
+    // Waits until 'done' holds or a second has passed
+    template <typename Predicate>
+    bool waitFor(Predicate done) {
+        const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (!done()) {
+            if (std::chrono::steady_clock::now() > until) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    std::uint64_t appended() const {
+        return device->gyro.written() + device->accel.written() + device->mag.written();
+    }
+
+    AppConfig config;
+    std::unique_ptr<DeviceRegistry> registry;
+    net::io_context ioc{1};
+    std::unique_ptr<WebSocketServer> server;
+    std::thread ioThread;
+    net::io_context clientIoc;
+    websocket::stream<tcp::socket> ws{clientIoc};
+    DeviceBuffers* device = nullptr;
+};
+
+ImuBatch makeBatch(std::size_t count, std::uint64_t timestampUs) {
+    ImuBatch batch;
+    batch.timestampUs = timestampUs;
+    for (SensorSamples* samples : {&batch.gyro, &batch.accel, &batch.mag}) {
+        samples->resize(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            samples->x[i] = static_cast<float>(i);
+            samples->y[i] = 0.0f;
+            samples->z[i] = 0.0f;
+        }
+    }
+    return batch;
+}
+
+} // namespace
+
+TEST_F(WebSocketSessionTest, AppendsBinaryBatchesWithinBudget) {
+    start();
+    sendBinary(makeBatch(20, 1000000));
+    ASSERT_TRUE(waitFor([&]() { return appended() == 60; }));
+    EXPECT_EQ(device->overBudgetSamples.load(), 0u);
+}
+
+// drop-oldest keeps only the newest samples of a batch the budget can pay for
+TEST_F(WebSocketSessionTest, DropOldestTrimsBatchToBudget) {
+    config.overloadPolicy = OverloadPolicy::DropOldest;
+    config.maxIngestRate = 100.0; // Burst allowance of 50 samples
+    start();
+
+    const std::size_t perSensor = 200;
+    sendBinary(makeBatch(perSensor, 1000000));
+    ASSERT_TRUE(waitFor([&]() { return appended() + device->overBudgetSamples.load() == 3 * perSensor; }));
+    EXPECT_GT(appended(), 0u);
+    EXPECT_LE(appended(), 52u);
+
+    // What was kept is the end of the batch
+    double t;
+    float x, y, z;
+    ASSERT_TRUE(device->gyro.readRecent(1, &t, &x, &y, &z));
+    EXPECT_EQ(x, static_cast<float>(perSensor - 1));
+}
+
+TEST_F(WebSocketSessionTest, DropNewestDiscardsWholeBatchOverBudget) {
+    config.overloadPolicy = OverloadPolicy::DropNewest;
+    config.maxIngestRate = 100.0;
+    start();
+
+    sendBinary(makeBatch(200, 1000000));
+    ASSERT_TRUE(waitFor([&]() { return device->droppedSamples.load() == 600; }));
+    EXPECT_EQ(appended(), 0u);
+}
+
+TEST_F(WebSocketSessionTest, CountsParseErrors) {
+    start();
+    for (int i = 0; i < 3; ++i) {
+        sendText("not an imu message");
+    }
+    sendText("Acc: [1, 2, 3]");
+    ASSERT_TRUE(waitFor([&]() { return device->accel.written() == 1; }));
+    EXPECT_EQ(device->parseErrors.load(), 3u);
+}
+
+// Clients without a path reuse one device instead of adding one per connection
+TEST_F(WebSocketSessionTest, PathlessClientsShareTheDefaultDevice) {
+    start("/");
+    EXPECT_EQ(device->id, "default");
+    ws.close(websocket::close_code::normal);
+    ASSERT_TRUE(waitFor([&]() { return !device->connected.load(); }));
+
+    for (int i = 0; i < 3; ++i) {
+        websocket::stream<tcp::socket> client{clientIoc};
+        ASSERT_FALSE(connectClient(client, "/?attempt=" + std::to_string(i)));
+        ASSERT_TRUE(waitFor([&]() { return device->connected.load(); }));
+        client.close(websocket::close_code::normal);
+        ASSERT_TRUE(waitFor([&]() { return !device->connected.load(); }));
+    }
+    EXPECT_EQ(registry->devices().size(), 1u);
+}
+
+TEST_F(WebSocketSessionTest, RefusesNewDevicesBeyondMaxDevices) {
+    config.maxDevices = 1;
+    start();
+
+    websocket::stream<tcp::socket> other{clientIoc};
+    EXPECT_TRUE(connectClient(other, "/other-device"));
+    EXPECT_EQ(registry->devices().size(), 1u);
+
+    // A known device still gets back in once its old session is gone
+    ws.close(websocket::close_code::normal);
+    ASSERT_TRUE(waitFor([&]() { return !device->connected.load(); }));
+    websocket::stream<tcp::socket> again{clientIoc};
+    EXPECT_FALSE(connectClient(again, "/test-device"));
+    ASSERT_TRUE(waitFor([&]() { return device->connected.load(); }));
+    again.close(websocket::close_code::normal);
+}